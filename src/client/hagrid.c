@@ -1,4 +1,6 @@
+#include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include "dir.h"
 #include "player_common.h"
 
@@ -7,11 +9,19 @@
 // The higher the slower but better
 #define OPT_DEPT 1.2
 #define RATIO_KEPT 1
+// Part of the time given by the server actually used, the rest being a margin
+#define TIME_SAFETY 0.5
+
+// Time left given by the server, negative when unlimited
+static double move_time_left = -1;
+static double game_time_left = -1;
 
 static struct pc__player_info* pi = NULL;
 
 static uint** queens_possible_moves = NULL;
 static uint** arrow_possible_moves = NULL;
+static unsigned long long nb_leaves = 0; // Positions evaluated by the heuristic, to predict the duration of a deeper search
+static int stop_search = 0; // Set by ponderhit to abort the search running in ponder
 
 //Useful struct for minimax_t
 struct minimax_t {
@@ -19,6 +29,16 @@ struct minimax_t {
     double value;
 };
 
+//The search done while the opponent plays: the best reply to the move it is expected to play
+struct ponder_t {
+    struct move_t guess;
+    struct minimax_t reply;
+    uint depth; // The depth of the search giving reply, 0 if there is none
+    unsigned long long nb_leaves; // The positions evaluated at that depth
+};
+static struct ponder_t pondered = {{-1, -1, -1}, {{-1, -1, -1}, 0}, 0, 0};
+static double last_score = 0; // The value of the last move played, from the point of view of the player
+
 //Strict copy of game is over function from game, adapted for a copy used in minmax
 int game__is_over(struct graph_t* graph, struct queens_t* queens) {
     for (uint player_id = 0; player_id < NUM_PLAYERS; player_id++) {
@@ -35,23 +55,6 @@ int game__is_over(struct graph_t* graph, struct queens_t* queens) {
     return 0;
 }
 
-//Checks if a move contains UINT_MAX
-static inline int is_first_move(struct move_t m) {
-    return m.arrow_dst == UINT_MAX || m.queen_dst == UINT_MAX || m.queen_src == UINT_MAX;
-}
-
-//Play the move m on the given graph and queens
-static void play_move(struct graph_t* graph, struct queens_t* queens, uint id_p, struct move_t m) {
-    if (is_first_move(m)) return;
-    for (uint i = 0; i < pi->queens->nb_queens; i++) {
-        if (queens->array[id_p][i] == m.queen_src) {
-            queens->array[id_p][i] = m.queen_dst;
-            break;
-        }
-    }
-    graph__disconnect(graph, m.arrow_dst);
-}
-
 //Returns the amount of queens of player_id that would be blocked by the arrow at arrow_dst
 static uint is_arrow_blocking_player(struct graph_t* graph, struct queens_t* queens, uint arrow_dst, uint player_id) {
     uint nb_block = 0;
@@ -61,47 +64,50 @@ static uint is_arrow_blocking_player(struct graph_t* graph, struct queens_t* que
     return nb_block;
 }
 
-//Fills the array possible_moves with the possible moves in dir d 
-static uint fill_possible_moves_queens_rec(struct graph_t* graph, struct queens_t* queens, uint pos, enum dir_t dir, uint* possible_moves, uint size, uint r) {
-    if (pos == UINT_MAX || queens__exist_queens(queens, pos) || (size && (rand() % r) == 1))
-        return size;
-    size = fill_possible_moves_queens_rec(graph, queens, graph__get_neighbor(graph, pos, dir), dir, possible_moves, size, r);
-    if (possible_moves)
-        possible_moves[size] = pos;
-    return size + 1;
+//Reverses the n first positions of array so that the farthest positions of a ray come first
+static void reverse_ray(uint* array, uint n) {
+    for (uint i = 0; i < n / 2; i++) {
+        uint tmp = array[i];
+        array[i] = array[n - 1 - i];
+        array[n - 1 - i] = tmp;
+    }
 }
 
 //Fills the array possible move with the possible move from position src, r represents the ratio of move kept
 static uint fill_possible_moves_queen(struct graph_t* graph, struct queens_t* queens, uint src, uint* possible_moves, uint r) {
     uint size = 0;
     for (enum dir_t dir = FIRST_DIR; dir <= LAST_DIR; dir++) {
-        size = fill_possible_moves_queens_rec(graph, queens, graph__get_neighbor(graph, src, dir), dir, possible_moves, size, r);
+        uint* ray = possible_moves + size;
+        uint n = movegen__ray(graph, queens, src, dir, MOVEGEN__NO_VACATED, ray);
+        if (size && r > 1)
+            for (uint k = 0; k < n; k++)
+                if (pc__random(pi, r) == 1) {
+                    n = k;
+                    break;
+                }
+        reverse_ray(ray, n);
+        size += n;
     }
-    if (possible_moves)
-        possible_moves[size] = UINT_MAX;
+    possible_moves[size] = UINT_MAX;
     return size;
 }
 
-//Fills the array possible_moves with the possible arrow moves in dir d 
-static int fill_possible_moves_arrow_rec(struct graph_t* graph, struct queens_t* queens, uint pos, enum dir_t dir, uint* possible_moves, uint size, uint op) {
-    if (pos == UINT_MAX || queens__exist_queens(queens, pos) || (size && !is_arrow_blocking_player(graph, queens, pos, op)))
-        return size;
-    size = fill_possible_moves_arrow_rec(graph, queens, graph__get_neighbor(graph, pos, dir), dir, possible_moves, size, op);
-    if (possible_moves)
-        possible_moves[size] = pos;
-    return size + 1;
-}
-
-//Fills the array possible_moves with the possible arrow shots from position src. If the array is not empty, only arrows blocking op's queen 
+//Fills the array possible_moves with the possible arrow shots from position src, the queen having left queen_src. If the array is not empty, only arrows blocking op's queen 
 static void fill_possible_moves_arrow(struct graph_t* graph, struct queens_t* queens, uint src, uint queen_src, uint* possible_moves, uint op) {
     uint size = 0;
     for (enum dir_t dir = FIRST_DIR; dir <= LAST_DIR; dir++) {
-        size = fill_possible_moves_arrow_rec(graph, queens, graph__get_neighbor(graph, src, dir), dir, possible_moves, size, op);
-    }
-    if (possible_moves) {
-        possible_moves[size] = queen_src;
-        possible_moves[size + 1] = -1;
+        uint* ray = possible_moves + size;
+        uint n = movegen__ray(graph, queens, src, dir, queen_src, ray);
+        if (size)
+            for (uint k = 0; k < n; k++)
+                if (!is_arrow_blocking_player(graph, queens, ray[k], op)) {
+                    n = k;
+                    break;
+                }
+        reverse_ray(ray, n);
+        size += n;
     }
+    possible_moves[size] = UINT_MAX;
 }
 
 //Returns the number of possible move for player_id
@@ -109,7 +115,7 @@ static uint get_nb_possible_moves(struct graph_t* graph, struct queens_t* queens
     uint nb_possible_move = 0;
     for (uint queen_id = 0; queen_id < queens->nb_queens; queen_id++) {
         uint queen_src = queens->array[player_id][queen_id];
-        nb_possible_move += fill_possible_moves_queen(graph, queens, queen_src, NULL, 1);
+        nb_possible_move += movegen__targets(graph, queens, queen_src, MOVEGEN__NO_VACATED, NULL);
     }
     return nb_possible_move;
 }
@@ -140,16 +146,6 @@ static double simple_heuristic(struct graph_t* graph, struct queens_t* queens) {
     return possible_move_ratio + nb_movable_ratio;
 }
 
-// Copy src_g and src_q in dst_h and dst_q repectively
-static void copy_graph_and_queens(struct graph_t* src_g, struct queens_t* src_q, struct graph_t* dst_g, struct queens_t* dst_q) {
-    dst_g->num_vertices = src_g->num_vertices;
-    gsl_spmatrix_uint_memcpy(dst_g->t, src_g->t);
-    dst_q->nb_queens = src_q->nb_queens;
-    for (uint player_id = 0; player_id < 2; player_id++)
-        for (uint i = 0; i < src_q->nb_queens; i++)
-            dst_q->array[player_id][i] = src_q->array[player_id][i];
-}
-
 //Return the max value between a and b
 static struct minimax_t max(struct minimax_t a, struct minimax_t b) {
     if (a.value > b.value)
@@ -164,27 +160,37 @@ static struct minimax_t min(struct minimax_t a, struct minimax_t b) {
     return b;
 }
 
-//Apply the minimax algorithm, graph and queens are array of copies, depending on the depth, the algorithm apply the move. Implements alphabeta
-static struct minimax_t minimax_rec(struct graph_t** graph, struct queens_t** queens, struct move_t move, int is_current_player, uint depth, uint max_depth, int alpha, int beta, double (*heuristic)(struct graph_t* graph, struct queens_t* queens)) {
-    copy_graph_and_queens(graph[depth + 1], queens[depth + 1], graph[depth], queens[depth]);
-    struct graph_t* g_copy = graph[depth];
-    struct queens_t* q_copy = queens[depth];
-    if (!is_current_player)
-        play_move(g_copy, q_copy, pi->player_id, move);
+//Explore the moves following the current position of graph and queens. Implements alphabeta
+static struct minimax_t minimax_children(struct graph_t* graph, struct queens_t* queens, int is_current_player, uint depth, uint max_depth, int alpha, int beta, double (*heuristic)(struct graph_t* graph, struct queens_t* queens));
+
+//Apply the minimax algorithm: play move on graph and queens, evaluate the position, then take the move back
+static struct minimax_t minimax_rec(struct graph_t* graph, struct queens_t* queens, struct move_t move, int is_current_player, uint depth, uint max_depth, int alpha, int beta, double (*heuristic)(struct graph_t* graph, struct queens_t* queens)) {
+    struct move_undo_t undo;
+    struct minimax_t ret;
+    move__make(graph, queens, is_current_player ? pc__get_other_player(pi) : pi->player_id, move, &undo);
+    if (!depth || (depth < max_depth && game__is_over(graph, queens))) {
+        ret = (struct minimax_t){move, heuristic(graph, queens)};
+        nb_leaves++;
+    }
     else
-        play_move(g_copy, q_copy, pc__get_other_player(pi), move);
-    if (!depth || (depth < max_depth && game__is_over(g_copy, q_copy)))
-        return (struct minimax_t){move, heuristic(g_copy, q_copy)};
+        ret = minimax_children(graph, queens, is_current_player, depth, max_depth, alpha, beta, heuristic);
+    move__unmake(graph, queens, &undo);
+    return ret;
+}
+
+static struct minimax_t minimax_children(struct graph_t* graph, struct queens_t* queens, int is_current_player, uint depth, uint max_depth, int alpha, int beta, double (*heuristic)(struct graph_t* graph, struct queens_t* queens)) {
     uint player_id = is_current_player ? pi->player_id : pc__get_other_player(pi);
     uint op_id = !is_current_player ? pi->player_id : pc__get_other_player(pi);
     struct minimax_t ret = (struct minimax_t){(struct move_t){-1, -1, -1}, is_current_player ? INT_MIN : INT_MAX};
-    for (uint queen_id = 0; queen_id < q_copy->nb_queens; queen_id++) {
-        uint queen_src = q_copy->array[player_id][queen_id];
-        fill_possible_moves_queen(g_copy, q_copy, queen_src, queens_possible_moves[depth], RATIO_KEPT);
+    for (uint queen_id = 0; queen_id < queens->nb_queens; queen_id++) {
+        uint queen_src = queens->array[player_id][queen_id];
+        fill_possible_moves_queen(graph, queens, queen_src, queens_possible_moves[depth], RATIO_KEPT);
         for (uint i = 0; queens_possible_moves[depth][i] != UINT_MAX; i++) {
             uint queen_dst = queens_possible_moves[depth][i];
-            fill_possible_moves_arrow(g_copy, q_copy, queen_dst, queen_src, arrow_possible_moves[depth], op_id);
+            fill_possible_moves_arrow(graph, queens, queen_dst, queen_src, arrow_possible_moves[depth], op_id);
             for (uint j = 0; arrow_possible_moves[depth][j] != UINT_MAX; j++) {
+                if (__atomic_load_n(&stop_search, __ATOMIC_RELAXED))
+                    return ret;
                 uint arrow_dst = arrow_possible_moves[depth][j];
                 struct move_t next_move = (struct move_t){queen_src, queen_dst, arrow_dst};
                 struct minimax_t h = {next_move, minimax_rec(graph, queens, next_move, !is_current_player, depth - 1, max_depth, alpha, beta, heuristic).value};
@@ -207,50 +213,153 @@ static struct minimax_t minimax_rec(struct graph_t** graph, struct queens_t** qu
     return ret;
 }
 
-//Allocate and free every used array in minimax and apply it
-static struct move_t alphabeta(struct move_t move, uint depth, double (*heuristic)(struct graph_t* graph, struct queens_t* queens)) {
-    struct graph_t** graph_tab = malloc(sizeof(struct graph_t*) * (depth + 2));
-    struct queens_t** queens_tab = malloc(sizeof(struct graph_t*) * (depth + 2));
+//Allocate the arrays of the moves explored at each depth of a search
+static void search_alloc(uint depth) {
     queens_possible_moves = malloc(sizeof(uint*) * (depth + 1));
     arrow_possible_moves = malloc(sizeof(uint*) * (depth + 1));
     for (uint i = 0; i <= depth; i++) {
-        graph_tab[i] = graph__copy(pi->board);
-        queens_tab[i] = malloc(sizeof(struct queens_t));
-        queens__alloc(queens_tab[i], pi->queens->nb_queens);
         queens_possible_moves[i] = malloc(sizeof(uint) * pi->board->num_vertices);
         arrow_possible_moves[i] = malloc(sizeof(uint) * pi->board->num_vertices);
     }
-    graph_tab[depth + 1] = pi->board;
-    queens_tab[depth + 1] = pi->queens;
-
-    struct minimax_t m = minimax_rec(graph_tab, queens_tab, move, 1, depth, depth, INT_MIN, INT_MAX, heuristic);
+}
 
+static void search_free(uint depth) {
     for (uint i = 0; i <= depth; i++) {
-        graph__free(graph_tab[i]);
-        queens__free(queens_tab[i]);
         free(queens_possible_moves[i]);
         free(arrow_possible_moves[i]);
     }
-    free(graph_tab);
-    free(queens_tab);
     free(queens_possible_moves);
     free(arrow_possible_moves);
+}
+
+//Allocate and free every used array in minimax and apply it on the board of the player
+static struct minimax_t alphabeta(struct move_t move, uint depth, double (*heuristic)(struct graph_t* graph, struct queens_t* queens)) {
+    search_alloc(depth);
+    struct minimax_t m = minimax_rec(pi->board, pi->queens, move, 1, depth, depth, INT_MIN, INT_MAX, heuristic);
+    search_free(depth);
+    return m;
+}
+
+//Returns the move of the opponent that looks best after one ply
+static struct move_t guess_op_move(double (*heuristic)(struct graph_t* graph, struct queens_t* queens)) {
+    search_alloc(1);
+    struct minimax_t m = minimax_children(pi->board, pi->queens, 0, 1, 1, INT_MIN, INT_MAX, heuristic);
+    search_free(1);
     return m.move;
 }
 
+static int is_same_move(struct move_t a, struct move_t b) {
+    return a.queen_src == b.queen_src && a.queen_dst == b.queen_dst && a.arrow_dst == b.arrow_dst;
+}
+
 char const* get_player_name() { return __PLAYER_NAME; }
 
 void initialize(unsigned int player_id, struct graph_t* graph, unsigned int num_queens, unsigned int* queens[NUM_PLAYERS]) {
     pi = pc__init(player_id, graph, num_queens, queens);
 }
 
+void initialize_shared(unsigned int player_id, const struct board_desc_t* board) {
+    pi = pc__init_shared(player_id, board);
+}
+
+void set_remaining_time(double move_time, double game_time) {
+    move_time_left = move_time;
+    game_time_left = game_time;
+}
+
+//Returns the time the coming move may take, negative when unlimited
+static double get_move_budget() {
+    double budget = move_time_left;
+    if (game_time_left >= 0) {
+        // Every move of each player costs a free vertex, so the clock is shared among half of them
+        uint nb_free = 0;
+        for (uint pos = 0; pos < pi->board->num_vertices; pos++)
+            nb_free += !is_isolated(pi->board, pos) && !queens__exist_queens(pi->queens, pos);
+        double share = game_time_left / (nb_free / 2 + 1);
+        if (budget < 0 || share < budget)
+            budget = share;
+    }
+    return budget < 0 ? budget : budget * TIME_SAFETY;
+}
+
+//Deepens the search while the next depth should end within budget
+//The next depth is expected to grow by as much as the number of evaluated positions did at the last one
+//The depths already searched while pondering on previous_move are skipped
+static struct minimax_t timed_alphabeta(struct move_t previous_move, uint max_depth, double budget, double (*heuristic)(struct graph_t* graph, struct queens_t* queens)) {
+    double start = get_monotonic_time();
+    unsigned long long previous_leaves = 1;
+    struct minimax_t move = {{-1, -1, -1}, 0};
+    uint first_depth = 1;
+    if (pondered.depth && is_same_move(previous_move, pondered.guess)) {
+        move = pondered.reply;
+        previous_leaves = pondered.nb_leaves ? pondered.nb_leaves : 1;
+        first_depth = pondered.depth + 1;
+    }
+    for (uint depth = first_depth; depth <= max_depth; depth++) {
+        double depth_start = get_monotonic_time();
+        nb_leaves = 0;
+        move = alphabeta(previous_move, depth, heuristic);
+
+        double now = get_monotonic_time();
+        double growth = (double)nb_leaves / previous_leaves;
+        if (now - start + (now - depth_start) * growth > budget)
+            break;
+        previous_leaves = nb_leaves ? nb_leaves : 1;
+    }
+    return move;
+}
+
 struct move_t play(struct move_t previous_move) {
     // printf("Depth : %u\n", get_optimal_depth());
-    struct move_t move = alphabeta(previous_move, get_optimal_depth(), simple_heuristic);
-    // printf("Move : %u %u %u\n", move.queen_src, move.queen_dst, move.arrow_dst);
+    __atomic_store_n(&stop_search, 0, __ATOMIC_RELAXED); // ponder has returned, and is only called again after play
+    double budget = get_move_budget();
+    uint depth = get_optimal_depth();
+    struct minimax_t move;
+    if (pc__book_move(pi, previous_move, &move.move, NULL))
+        move.value = NAN; // The book scores are not in the units of the heuristic
+    else if (budget >= 0)
+        move = timed_alphabeta(previous_move, depth, budget, simple_heuristic);
+    else if (pondered.depth >= depth && is_same_move(previous_move, pondered.guess))
+        move = pondered.reply;
+    else
+        move = alphabeta(previous_move, depth, simple_heuristic);
+    pondered.depth = 0;
+    last_score = move.value;
+    // printf("Move : %u %u %u\n", move.move.queen_src, move.move.queen_dst, move.move.arrow_dst);
     pc__play_op_move(pi, previous_move);
-    pc__play_my_move(pi, move);
-    return move;
+    pc__play_my_move(pi, move.move);
+    return move.move;
+}
+
+double get_move_score() { return last_score; }
+
+//Searches the reply to the most likely move of the opponent, deeper and deeper until the opponent has played
+void ponder(struct move_t my_last_move) {
+    (void)my_last_move; // Already played on the board by play
+    if (game__is_over(pi->board, pi->queens))
+        return;
+
+    struct move_t guess = guess_op_move(simple_heuristic);
+    if (__atomic_load_n(&stop_search, __ATOMIC_RELAXED) || guess.queen_src == UINT_MAX)
+        return;
+    pondered.guess = guess;
+
+    // The board is the one play will search from, so is the depth it will aim for
+    uint max_depth = get_optimal_depth();
+    for (uint depth = 1; depth <= max_depth; depth++) {
+        nb_leaves = 0;
+        struct minimax_t reply = alphabeta(guess, depth, simple_heuristic);
+        if (__atomic_load_n(&stop_search, __ATOMIC_RELAXED))
+            return;
+        pondered.reply = reply;
+        pondered.depth = depth;
+        pondered.nb_leaves = nb_leaves;
+    }
+}
+
+void ponderhit(struct move_t opponent_move) {
+    (void)opponent_move; // Compared to the guess by play
+    __atomic_store_n(&stop_search, 1, __ATOMIC_RELAXED);
 }
 
 void finalize() { pc__free(pi); }
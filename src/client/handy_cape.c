@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include "player_common.h"
 
 #define __PLAYER_NAME "Handy Capé"
@@ -12,6 +13,10 @@ void initialize(unsigned int player_id, struct graph_t* graph, unsigned int num_
     pi = pc__init(player_id, graph, num_queens, queens);
 }
 
+void initialize_shared(unsigned int player_id, const struct board_desc_t* board) {
+    pi = pc__init_shared(player_id, board);
+}
+
 uint neighboring_queens(struct pc__player_info* pi, uint arrow_dst) {
     uint op_player = pi->player_id ^ 1;
     uint count = 0;
@@ -73,21 +78,10 @@ uint select_min_from(uint* array, uint size, uint count) {
     return min_i;
 }
 
-uint queen_src_score(struct pc__player_info* pi, uint queen_src /*, uint depth*/) {
-    uint possibleMoves;
-    uint count = 0;
-    for (uint i = 0; i < pi->board->num_vertices; i++) {
-        if (queen_src != UINT_MAX) {
-            possibleMoves = (can_reach_position(pi->board, pi->queens, queen_src, i) > 0);
-            count += possibleMoves;
-            /*
-            if (possibleMoves != 0 && depth > 0) {
-                count += possibleMoves + (queen_src_score(pi, i, depth - 1) + 1) / (possibleMoves);
-            }
-            */
-        }
-    }
-    return count;
+uint queen_src_score(struct pc__player_info* pi, uint queen_src) {
+    if (queen_src == UINT_MAX)
+        return 0;
+    return possible_moves(pi, queen_src);
 }
 
 int adv_move_reduced(struct pc__player_info* pi, uint queen_dst) {
@@ -175,25 +169,18 @@ int sum_arrow_move(struct pc__player_info* pi, uint src, uint dst) {
     return adv_move_reduced(pi, dst) - player_move_reduced(pi, dst, src, 0);
 }
 
-int can_reach_direction_arrow(struct graph_t* board, struct queens_t* queens, uint pos1, uint pos2, uint queen_src, enum dir_t dir) {
-    if (pos1 == UINT_MAX || queens__exist_queens(queens, pos1)) {
-        return 0;
-    }
-    if (pos1 == pos2) {
-        return 1;
-    }
-    return can_reach_direction_arrow(board, queens, graph__get_neighbor(board, pos1, dir), pos2, queen_src, dir);
+// Sorts the vertices by increasing index so that ties keep being broken by the first position met
+static int cmp_vertices(const void* a, const void* b) {
+    uint u = *(const uint*)a;
+    uint v = *(const uint*)b;
+    return (u > v) - (u < v);
 }
 
-int can_reach_position_arrow(struct graph_t* board, struct queens_t* queens, uint pos1, uint pos2, uint queen_src) {
-    if (queen_src == pos2)
-        return 1;
-    for (enum dir_t d = FIRST_DIR; d <= LAST_DIR; d++) {
-        if (can_reach_direction_arrow(board, queens, graph__get_neighbor(board, pos1, d), pos2, queen_src, d)) {
-            return d;
-        }
-    }
-    return 0;
+// Fills out with the vertices reachable from src sorted by increasing index, and returns their number
+static uint sorted_targets(struct pc__player_info* pi, uint src, uint* out) {
+    uint count = movegen__targets(pi->board, pi->queens, src, MOVEGEN__NO_VACATED, out);
+    qsort(out, count, sizeof(uint), cmp_vertices);
+    return count;
 }
 
 uint queen_dst_score(struct pc__player_info* pi, uint queen_src, uint queen_dst) {
@@ -207,22 +194,32 @@ uint arrow_dst_score(struct pc__player_info* pi, uint queen_dst, uint arrow_dst)
 struct move_t slct_move(struct pc__player_info* pi) {
     int max = -INT_MAX;
     struct move_t ret;
+    uint* queen_dsts = malloc(sizeof(uint) * pi->board->num_vertices);
+    uint* arrow_dsts = malloc(sizeof(uint) * (pi->board->num_vertices + 1));
     for (uint q = 0; q < pi->queens->nb_queens; q++) {
-        if (can_move(pi->board, pi->queens, pi->queens->array[pi->player_id][q])) {
-            for (uint i = 0; i < pi->board->num_vertices; i++) {
-                if (can_reach_position(pi->board, pi->queens, pi->queens->array[pi->player_id][q], i)) {
-                    for (uint j = 0; j < pi->board->num_vertices; j++) {
-                        if (can_reach_position_arrow(pi->board, pi->queens, i, j, pi->queens->array[pi->player_id][q])) {
-                            if (max < sum_queen_move(pi, pi->queens->array[pi->player_id][q], i) + sum_arrow_move(pi, i, j)) {
-                                max = sum_queen_move(pi, pi->queens->array[pi->player_id][q], i) + sum_arrow_move(pi, i, j);
-                                ret = (struct move_t){pi->queens->array[pi->player_id][q], i, j};
-                            }
-                        }
-                    }
+        uint queen_src = pi->queens->array[pi->player_id][q];
+        if (!can_move(pi->board, pi->queens, queen_src))
+            continue;
+        uint nb_queen_dsts = sorted_targets(pi, queen_src, queen_dsts);
+        for (uint i = 0; i < nb_queen_dsts; i++) {
+            uint queen_dst = queen_dsts[i];
+            int queen_score = sum_queen_move(pi, queen_src, queen_dst);
+
+            // The arrow may also be shot to or through the vertex the queen left
+            uint nb_arrow_dsts = movegen__targets(pi->board, pi->queens, queen_dst, queen_src, arrow_dsts);
+            qsort(arrow_dsts, nb_arrow_dsts, sizeof(uint), cmp_vertices);
+
+            for (uint j = 0; j < nb_arrow_dsts; j++) {
+                int score = queen_score + sum_arrow_move(pi, queen_dst, arrow_dsts[j]);
+                if (max < score) {
+                    max = score;
+                    ret = (struct move_t){queen_src, queen_dst, arrow_dsts[j]};
                 }
             }
         }
     }
+    free(arrow_dsts);
+    free(queen_dsts);
     return ret;
 }
 
@@ -1,4 +1,6 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "player_common.h"
 
 #define __PLAYER_NAME "Heroine"
@@ -12,6 +14,10 @@ void initialize(unsigned int player_id, struct graph_t* graph, unsigned int num_
     pi = pc__init(player_id, graph, num_queens, queens);
 }
 
+void initialize_shared(unsigned int player_id, const struct board_desc_t* board) {
+    pi = pc__init_shared(player_id, board);
+}
+
 // Returns number of neighboring queens of opponent player
 uint neighboring_queens(struct pc__player_info* pi, uint arrow_dst) {
     uint op_player = pi->player_id ^ 1;
@@ -33,16 +39,16 @@ uint queen_src_score(struct pc__player_info* pi, uint queen_src, uint depth) {
     if (depth == 0) {
         return 0;
     }
-    uint possibleMoves;
+    if (queen_src == UINT_MAX) {
+        return 0;
+    }
     uint count = 0;
-    for (uint i = 0; i < pi->board->num_vertices; i++) {
-        if (queen_src != UINT_MAX) {
-            possibleMoves = (can_reach_position(pi->board, pi->queens, queen_src, i) > 0);
-            if (possibleMoves != 0) {
-                count += possibleMoves * (queen_src_score(pi, i, depth - 1) + 1);
-            }
-        }
+    uint* targets = malloc(sizeof(uint) * pi->board->num_vertices);
+    uint nb_targets = movegen__targets(pi->board, pi->queens, queen_src, MOVEGEN__NO_VACATED, targets);
+    for (uint i = 0; i < nb_targets; i++) {
+        count += queen_src_score(pi, targets[i], depth - 1) + 1;
     }
+    free(targets);
     return count;
 }
 
@@ -51,11 +57,6 @@ uint queen_dst_score(struct pc__player_info* pi, uint queen_src, uint queen_dst)
     return is_valid_move_for_player(pi->board, pi->queens, pi->player_id, queen_src, queen_dst, 1) * (possible_moves(pi, queen_dst) + 1);
 }
 
-// Returns score of choosing arrow_dst if queen is moved to queen_dst
-uint arrow_dst_score(struct pc__player_info* pi, uint queen_dst, uint arrow_dst) {
-    return (can_reach_position(pi->board, pi->queens, queen_dst, arrow_dst) > 0) * (neighboring_queens(pi, arrow_dst) + 1);
-}
-
 // Selects queen__src position for player pi
 // The function creates and fills an array with the positions' score and chooses the position with the highest one
 uint select_queen_src(struct pc__player_info* pi) {
@@ -71,22 +72,7 @@ uint select_queen_src(struct pc__player_info* pi) {
     return pi->queens->array[pi->player_id][queen_src];
 }
 
-// Selects queen_dst or arrow_dst position depending on the function in parameter
-// The function creates and fills an array with the positions' score and chooses the position with the highest one
-uint select_dst(struct pc__player_info* pi, uint source, uint (*score_function)(struct pc__player_info*, uint, uint)) {
-    uint count = 0;
-    uint* array = malloc(sizeof(uint) * pi->board->num_vertices);
-    for (uint i = 0; i < pi->board->num_vertices; i++) {
-        int moveScore = score_function(pi, source, i);
-        array[i] = moveScore;
-        count += (moveScore > 0);
-    }
-    uint destination = select_max_from(array, pi->board->num_vertices, count);
-    free(array);
-    return destination;
-}
-
-// Chooses the optimal move according to the player
+// Chooses the optimal move according to the player, among its legal moves
 struct move_t optimal_move(struct pc__player_info* pi) {
     struct move_t target_move = (struct move_t){-1, -1, -1};
 
@@ -96,18 +82,38 @@ struct move_t optimal_move(struct pc__player_info* pi) {
     if (queen_src >= pi->board->num_vertices)
         return target_move;
 
+    // The arrays are filled with the score of each position, those of the positions the moves do not reach staying 0
+    size_t nb_moves = pc__legal_moves(pi, pi->player_id);
+    uint* array = calloc(pi->board->num_vertices, sizeof(uint));
+    if (!array)
+        handle_error(__func__, "Not enough memory for 'array'", 1);
+
     // Chooses queen_dst to move queen_src to
-    target_move.queen_dst = select_dst(pi, queen_src, queen_dst_score);
+    uint count = 0;
+    for (size_t i = 0; i < nb_moves; i++) {
+        uint queen_dst = pi->moves[i].queen_dst;
+        if (pi->moves[i].queen_src == queen_src && !array[queen_dst]) {
+            array[queen_dst] = queen_dst_score(pi, queen_src, queen_dst);
+            count++;
+        }
+    }
+    target_move.queen_dst = select_max_from(array, pi->board->num_vertices, count);
     if (target_move.queen_dst >= pi->board->num_vertices) {
+        free(array);
         return target_move;
     }
 
-    // Chooses arrow_dst position
-    target_move.arrow_dst = select_dst(pi, target_move.queen_dst, arrow_dst_score);
-    if (target_move.arrow_dst == UINT_MAX) {
-        target_move.arrow_dst = target_move.queen_src;
+    // Chooses arrow_dst position, the vertex left by the queen being one of them
+    memset(array, 0, pi->board->num_vertices * sizeof(uint));
+    count = 0;
+    for (size_t i = 0; i < nb_moves; i++) {
+        if (pi->moves[i].queen_src == queen_src && pi->moves[i].queen_dst == target_move.queen_dst) {
+            array[pi->moves[i].arrow_dst] = neighboring_queens(pi, pi->moves[i].arrow_dst) + 1;
+            count++;
+        }
     }
-
+    target_move.arrow_dst = select_max_from(array, pi->board->num_vertices, count);
+    free(array);
     return target_move;
 }
 
@@ -1,10 +1,17 @@
 #include "player_common.h"
 #include <limits.h>
 #include <math.h>
+#include <stdlib.h>
 #include "utils.h"
 
+static unsigned long long player_seed = 0; // Given by the server before initialize, 0 if it gives none
+
 uint pc__get_other_player(struct pc__player_info* pi) { return pi->player_id ^ 1; }
 
+void set_seed(unsigned long long seed) { player_seed = seed; }
+
+uint pc__random(struct pc__player_info* pi, uint bound) { return rng__below(&pi->rng, bound); }
+
 static inline int is_first_move(struct move_t m) {
     return m.arrow_dst == UINT_MAX || m.queen_dst == UINT_MAX || m.queen_src == UINT_MAX;
 }
@@ -12,12 +19,9 @@ static inline int is_first_move(struct move_t m) {
 static void play_move(struct pc__player_info* pi, uint id_p, struct move_t m) {
     if (is_first_move(m)) return;
 
-    for (uint i = 0; i < pi->queens->nb_queens; i++) {
-        if (pi->queens->array[id_p][i] == m.queen_src) {
-            pi->queens->array[id_p][i] = m.queen_dst;
-            break;
-        }
-    }
+    uint queen_id = queens__get_queen_id(pi->queens, id_p, m.queen_src);
+    if (queen_id != QUEENS__NO_QUEEN)
+        queens__set(pi->queens, id_p, queen_id, m.queen_dst);
 
     graph__disconnect(pi->board, m.arrow_dst);
 }
@@ -39,21 +43,62 @@ struct pc__player_info* pc__init(uint player_id,
     pi->queens = queens__new();
     pi->queens->nb_queens = num_queens;
     pi->nb_turn = 0;
+    rng__seed(&pi->rng, player_seed);
+    const char* book_path = getenv(PC__BOOK_ENV);
+    pi->book = book_path && *book_path ? book__open(book_path) : NULL;
+    pi->moves = NULL;
+    pi->moves_cap = 0;
 
     for (uint p = 0; p < NUM_PLAYERS; p++)
         pi->queens->array[p] = queens[p];
+    queens__rehash(pi->queens);
+    queens__build_index(pi->queens, graph->num_vertices);
 
     return pi;
 }
 
+struct pc__player_info* pc__init_shared(uint player_id, const struct board_desc_t* board) {
+    if (!board)
+        handle_error(__func__, "Invalid parameter 'board'", 1);
+    uint* queens[NUM_PLAYERS];
+    board_desc__to_queens(board, queens);
+    return pc__init(player_id, board_desc__to_graph(board), board->num_queens, queens);
+}
+
 void pc__free(struct pc__player_info* pi) {
     if (pi) {
         graph__free(pi->board);
         queens__free(pi->queens);
+        book__close(pi->book);
+        free(pi->moves);
     }
     free(pi);
 }
 
+size_t pc__legal_moves(struct pc__player_info* pi, uint player_id) {
+    size_t count = movegen__generate(pi->board, pi->queens, player_id, pi->moves, pi->moves_cap);
+    if (count > pi->moves_cap) {
+        pi->moves = realloc(pi->moves, count * sizeof(struct move_t));
+        if (!pi->moves)
+            handle_error(__func__, "Not enough memory for 'moves'", 1);
+        pi->moves_cap = count;
+        movegen__generate(pi->board, pi->queens, player_id, pi->moves, pi->moves_cap);
+    }
+    return count;
+}
+
+int pc__book_move(struct pc__player_info* pi, struct move_t previous_move, struct move_t* move, double* score) {
+    if (!pi->book)
+        return 0;
+
+    // The board of the player is only updated once its move is chosen
+    struct move_undo_t undo;
+    move__make(pi->board, pi->queens, pc__get_other_player(pi), previous_move, &undo);
+    int found = book__probe(pi->book, pi->board, pi->queens, pi->player_id, move, score);
+    move__unmake(pi->board, pi->queens, &undo);
+    return found;
+}
+
 void pc__play_my_move(struct pc__player_info* pi, struct move_t m) {
     play_move(pi, pi->player_id, m);
 }
@@ -73,10 +118,10 @@ uint select_random_queen(struct pc__player_info* pi) {
     return queen;
 }
 
-uint select_random_from(uint* array, uint size, uint count) {
+uint select_random_from(struct pc__player_info* pi, uint* array, uint size, uint count) {
     if (!count)
         return UINT_MAX;
-    uint random = rand() % count;
+    uint random = pc__random(pi, count);
     for (uint i = 0, cpt = 0; i < size; i++) {
         cpt += array[i];
         if (cpt > random) {
@@ -101,9 +146,5 @@ uint select_max_from(uint* array, uint size, uint count) {
 }
 
 uint possible_moves(struct pc__player_info* pi, uint queen_src) {
-    uint count = 0;
-    for (uint i = 0; i < pi->board->num_vertices; i++) {
-        count += (can_reach_position(pi->board, pi->queens, queen_src, i) > 0);
-    }
-    return count;
+    return movegen__targets(pi->board, pi->queens, queen_src, MOVEGEN__NO_VACATED, NULL);
 }
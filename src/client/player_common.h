@@ -6,12 +6,17 @@
 #ifndef __PLAYER_COMMON_H__
 #define __PLAYER_COMMON_H__
 
+#include "book.h"
 #include "graph.h"
 #include "move.h"
+#include "movegen.h"
 #include "player.h"
 #include "queens.h"
+#include "rng.h"
 #include "utils.h"
 
+#define PC__BOOK_ENV "AMAZONS_BOOK" // The environment variable giving the path of the opening book
+
 /**
  * @brief Struct containing information for a player.
  */
@@ -20,6 +25,10 @@ struct pc__player_info {
     struct graph_t* board; /**< Pointer to the game board graph. */
     struct queens_t* queens; /**< Pointer to the player's queen positions. */
     unsigned int nb_turn; /**< Number of turns played by the player. */
+    struct rng_t rng; /**< Random generator of the player, seeded by the server through set_seed. */
+    struct book_t* book; /**< Opening book given by PC__BOOK_ENV, NULL if there is none. */
+    struct move_t* moves; /**< Legal moves listed by pc__legal_moves, grown on demand. */
+    size_t moves_cap; /**< Number of moves the moves array can hold. */
 };
 
 /**
@@ -36,6 +45,15 @@ struct pc__player_info* pc__init(unsigned int player_id,
                                  unsigned int num_queens,
                                  unsigned int* queens[NUM_PLAYERS]);
 
+/**
+ * @brief Initializes a player from the description of the board shared by the server.
+ *
+ * @param player_id ID of the player.
+ * @param board Description of the initial board and queens, from which private copies are built.
+ * @return Pointer to the player information struct.
+ */
+struct pc__player_info* pc__init_shared(unsigned int player_id, const struct board_desc_t* board);
+
 /**
  * @brief Returns the ID of the other player.
  *
@@ -44,6 +62,35 @@ struct pc__player_info* pc__init(unsigned int player_id,
  */
 uint pc__get_other_player(struct pc__player_info* pi);
 
+/**
+ * @brief Draws a random number from the generator of the player, instead of the rand of the process.
+ *
+ * @param pi Pointer to the player information struct.
+ * @param bound Number of possible draws, not 0.
+ * @return Random number between 0 and bound - 1.
+ */
+uint pc__random(struct pc__player_info* pi, uint bound);
+
+/**
+ * @brief Lists the legal moves of a player on the board of the player, as movegen__generate does.
+ *
+ * @param pi Pointer to the player information struct, whose moves array receives the moves.
+ * @param player_id ID of the player to move.
+ * @return Number of legal moves, written in pi->moves until the next call.
+ */
+size_t pc__legal_moves(struct pc__player_info* pi, uint player_id);
+
+/**
+ * @brief Looks for the move to play in the opening book of the player.
+ *
+ * @param pi Pointer to the player information struct, whose board does not have previous_move yet.
+ * @param previous_move Last move of the opponent, the initial move if the player moves first.
+ * @param move Where to write the move of the book.
+ * @param score Where to write the score of the move in the book. May be NULL.
+ * @return 1 if the position is in the book, 0 otherwise.
+ */
+int pc__book_move(struct pc__player_info* pi, struct move_t previous_move, struct move_t* move, double* score);
+
 /**
  * @brief Frees memory used by the player information struct and associated resources.
  *
@@ -78,12 +125,13 @@ uint select_random_queen(struct pc__player_info* pi);
 /**
  * @brief Selects a random index from the given array based on weights and count.
  *
+ * @param pi Pointer to the player information struct, whose generator is used.
  * @param array Array of weights for each index.
  * @param size Size of the array.
  * @param count Number of indices with non-zero weight.
  * @return Randomly selected index.
  */
-uint select_random_from(uint* array, uint size, uint count);
+uint select_random_from(struct pc__player_info* pi, uint* array, uint size, uint count);
 
 /**
  * @brief Selects the index of the maximum weight in the given array.
@@ -0,0 +1,228 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bitboard.h"
+#include "player.h"
+
+// Offset of the bit index of a neighbor in each direction, from DIR_NORTH to DIR_NW
+static const int dir_offsets[NUM_DIRS] = {
+    -BITBOARD__MAX_SIZE,
+    -BITBOARD__MAX_SIZE + 1,
+    1,
+    BITBOARD__MAX_SIZE + 1,
+    BITBOARD__MAX_SIZE,
+    BITBOARD__MAX_SIZE - 1,
+    -1,
+    -BITBOARD__MAX_SIZE - 1,
+};
+
+static inline struct bitset_t bitset__and(struct bitset_t a, struct bitset_t b) {
+    for (uint k = 0; k < BITBOARD__NUM_WORDS; k++)
+        a.words[k] &= b.words[k];
+    return a;
+}
+
+static inline struct bitset_t bitset__or(struct bitset_t a, struct bitset_t b) {
+    for (uint k = 0; k < BITBOARD__NUM_WORDS; k++)
+        a.words[k] |= b.words[k];
+    return a;
+}
+
+// Moves every cell of the set by offset bits, 0 < |offset| < 64
+static inline struct bitset_t bitset__shift(struct bitset_t a, int offset) {
+    struct bitset_t r;
+    if (offset > 0) {
+        uint s = offset;
+        r.words[0] = a.words[0] << s;
+        for (uint k = 1; k < BITBOARD__NUM_WORDS; k++)
+            r.words[k] = (a.words[k] << s) | (a.words[k - 1] >> (64 - s));
+    } else {
+        uint s = -offset;
+        for (uint k = 0; k < BITBOARD__NUM_WORDS - 1; k++)
+            r.words[k] = (a.words[k] >> s) | (a.words[k + 1] << (64 - s));
+        r.words[BITBOARD__NUM_WORDS - 1] = a.words[BITBOARD__NUM_WORDS - 1] >> s;
+    }
+    return r;
+}
+
+/* ************************************************** */
+
+void bitset__set(struct bitset_t* set, uint bit) {
+    set->words[bit / 64] |= (uint64_t)1 << (bit % 64);
+}
+
+void bitset__clear(struct bitset_t* set, uint bit) {
+    set->words[bit / 64] &= ~((uint64_t)1 << (bit % 64));
+}
+
+int bitset__test(struct bitset_t* set, uint bit) {
+    return (set->words[bit / 64] >> (bit % 64)) & 1;
+}
+
+uint bitset__count(struct bitset_t set) {
+    uint count = 0;
+    for (uint k = 0; k < BITBOARD__NUM_WORDS; k++)
+        count += __builtin_popcountll(set.words[k]);
+    return count;
+}
+
+uint bitset__pop(struct bitset_t* set) {
+    for (uint k = 0; k < BITBOARD__NUM_WORDS; k++) {
+        if (set->words[k]) {
+            uint bit = __builtin_ctzll(set->words[k]);
+            set->words[k] &= set->words[k] - 1;
+            return k * 64 + bit;
+        }
+    }
+    assert(0);
+    return UINT_MAX;
+}
+
+int bitset__is_empty(struct bitset_t set) {
+    uint64_t any = 0;
+    for (uint k = 0; k < BITBOARD__NUM_WORDS; k++)
+        any |= set.words[k];
+    return !any;
+}
+
+/* ************************************************** */
+
+int bitboard__is_supported(uint num_vertices) {
+    uint size = (uint)sqrt(num_vertices);
+    return size * size == num_vertices && size <= BITBOARD__MAX_SIZE;
+}
+
+struct bitboard_t* bitboard__new() {
+    struct bitboard_t* bb = malloc(sizeof(struct bitboard_t));
+    if (!bb)
+        handle_error(__func__, "Not enough memory for 'bb'", PROGRAM_EXIT);
+    return bb;
+}
+
+uint bitboard__to_bit(struct bitboard_t* bb, uint pos) {
+    return (pos / bb->size) * BITBOARD__MAX_SIZE + pos % bb->size;
+}
+
+uint bitboard__to_vertex(struct bitboard_t* bb, uint bit) {
+    return (bit / BITBOARD__MAX_SIZE) * bb->size + bit % BITBOARD__MAX_SIZE;
+}
+
+void bitboard__init(struct bitboard_t* bb, struct graph_t* board, struct queens_t* queens) {
+    if (!bitboard__is_supported(board->num_vertices))
+        handle_error(__func__, "Board too large for a bitboard", PROGRAM_EXIT);
+
+    memset(bb, 0, sizeof(struct bitboard_t));
+    bb->size = (uint)sqrt(board->num_vertices);
+
+    for (uint pos = 0; pos < board->num_vertices; pos++) {
+        uint bit = bitboard__to_bit(bb, pos);
+        for (enum dir_t d = FIRST_DIR; d <= LAST_DIR; d++) {
+            if (graph__get_neighbor(board, pos, d) != GRAPH__NO_NEIGHBOR) {
+                bitset__set(&bb->edges[d - FIRST_DIR], bit);
+                bitset__set(&bb->valid, bit);
+            }
+        }
+        if (!bitset__test(&bb->valid, bit))
+            bitset__set(&bb->blocked, bit);
+    }
+
+    for (uint player_id = 0; player_id < NUM_PLAYERS; player_id++)
+        for (uint queen_id = 0; queen_id < queens->nb_queens; queen_id++)
+            if (queens->array[player_id][queen_id] < board->num_vertices)
+                bitset__set(&bb->queens[player_id], bitboard__to_bit(bb, queens->array[player_id][queen_id]));
+}
+
+void bitboard__free(struct bitboard_t* bb) {
+    free(bb);
+}
+
+void bitboard__play(struct bitboard_t* bb, uint player_id, struct move_t move) {
+    bitset__clear(&bb->queens[player_id], bitboard__to_bit(bb, move.queen_src));
+    bitset__set(&bb->queens[player_id], bitboard__to_bit(bb, move.queen_dst));
+    uint arrow = bitboard__to_bit(bb, move.arrow_dst);
+    bitset__set(&bb->blocked, arrow);
+    for (uint d = 0; d < NUM_DIRS; d++) // Same as graph__disconnect, nothing can leave an arrow
+        bitset__clear(&bb->edges[d], arrow);
+}
+
+struct bitset_t bitboard__empty(struct bitboard_t* bb) {
+    struct bitset_t empty;
+    for (uint k = 0; k < BITBOARD__NUM_WORDS; k++)
+        empty.words[k] = bb->valid.words[k] & ~(bb->blocked.words[k] | bb->queens[0].words[k] | bb->queens[1].words[k]);
+    return empty;
+}
+
+struct bitset_t bitboard__ray(struct bitboard_t* bb, struct bitset_t from, struct bitset_t empty, enum dir_t dir) {
+    struct bitset_t edges = bb->edges[dir - FIRST_DIR];
+    int offset = dir_offsets[dir - FIRST_DIR];
+    struct bitset_t reached = {{0}};
+
+    // Each step moves every ray front by one cell, only along existing edges and through empty cells
+    from = bitset__and(bitset__shift(bitset__and(from, edges), offset), empty);
+    while (!bitset__is_empty(from)) {
+        reached = bitset__or(reached, from);
+        from = bitset__and(bitset__shift(bitset__and(from, edges), offset), empty);
+    }
+    return reached;
+}
+
+// Cells reached from a cell in any direction, through the given empty cells
+static struct bitset_t reachable_from(struct bitboard_t* bb, uint bit, struct bitset_t empty) {
+    struct bitset_t from = {{0}};
+    struct bitset_t reached = {{0}};
+
+    bitset__set(&from, bit);
+    for (enum dir_t d = FIRST_DIR; d <= LAST_DIR; d++)
+        reached = bitset__or(reached, bitboard__ray(bb, from, empty, d));
+    return reached;
+}
+
+struct bitset_t bitboard__reachable(struct bitboard_t* bb, uint pos) {
+    return reachable_from(bb, bitboard__to_bit(bb, pos), bitboard__empty(bb));
+}
+
+// The cells an arrow can reach once a queen has moved from src to dst, src being left empty
+static struct bitset_t arrow_targets(struct bitboard_t* bb, struct bitset_t empty, uint src, uint dst) {
+    bitset__set(&empty, src);
+    bitset__clear(&empty, dst);
+    return reachable_from(bb, dst, empty);
+}
+
+size_t bitboard__generate(struct bitboard_t* bb, uint player_id, struct move_t* out, size_t cap) {
+    struct bitset_t empty = bitboard__empty(bb);
+    struct bitset_t queens = bb->queens[player_id];
+    size_t count = 0;
+
+    while (!bitset__is_empty(queens)) {
+        uint src = bitset__pop(&queens);
+        struct bitset_t dsts = reachable_from(bb, src, empty);
+        while (!bitset__is_empty(dsts)) {
+            uint dst = bitset__pop(&dsts);
+            struct bitset_t arrows = arrow_targets(bb, empty, src, dst);
+            while (!bitset__is_empty(arrows)) {
+                uint arrow = bitset__pop(&arrows);
+                if (count < cap)
+                    out[count] = (struct move_t){bitboard__to_vertex(bb, src), bitboard__to_vertex(bb, dst), bitboard__to_vertex(bb, arrow)};
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+size_t bitboard__count(struct bitboard_t* bb, uint player_id) {
+    struct bitset_t empty = bitboard__empty(bb);
+    struct bitset_t queens = bb->queens[player_id];
+    size_t count = 0;
+
+    while (!bitset__is_empty(queens)) {
+        uint src = bitset__pop(&queens);
+        struct bitset_t dsts = reachable_from(bb, src, empty);
+        while (!bitset__is_empty(dsts)) {
+            uint dst = bitset__pop(&dsts);
+            count += bitset__count(arrow_targets(bb, empty, src, dst));
+        }
+    }
+    return count;
+}
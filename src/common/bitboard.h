@@ -0,0 +1,202 @@
+/**
+ * @file bitboard.h
+ * @brief This file contains a bitboard representation of the board, used to compute queen moves with word operations.
+ */
+
+#ifndef _AMAZON_BITBOARD_H_
+#define _AMAZON_BITBOARD_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dir.h"
+#include "graph.h"
+#include "move.h"
+#include "queens.h"
+#include "utils.h"
+
+#define BITBOARD__MAX_SIZE 16
+#define BITBOARD__NUM_WORDS (BITBOARD__MAX_SIZE * BITBOARD__MAX_SIZE / 64)
+
+/**
+ * @struct bitset_t
+ * @brief A set of cells of a board of at most BITBOARD__MAX_SIZE x BITBOARD__MAX_SIZE cells.
+ *
+ * The cell (i, j) is stored in bit i * BITBOARD__MAX_SIZE + j, whatever the size of the board.
+ */
+struct bitset_t {
+    uint64_t words[BITBOARD__NUM_WORDS];
+};
+
+/**
+ * @struct bitboard_t
+ * @brief A board stored as masks of cells.
+ */
+struct bitboard_t {
+    uint size; /**< Width of the board */
+    struct bitset_t valid; /**< Cells belonging to the shape of the board */
+    struct bitset_t blocked; /**< Holes and arrows */
+    struct bitset_t queens[2]; /**< Queens of each player */
+    struct bitset_t edges[NUM_DIRS]; /**< edges[d - FIRST_DIR] holds the cells with an edge in direction d */
+};
+
+/**
+ * @brief Check whether a graph fits in a bitboard.
+ *
+ * @param num_vertices The number of vertices of the graph.
+ * @return 1 if the graph is a square board of at most BITBOARD__MAX_SIZE cells wide, 0 otherwise.
+ */
+int bitboard__is_supported(uint num_vertices);
+
+/**
+ * @brief Create a new bitboard.
+ *
+ * @return A pointer to the newly created bitboard.
+ */
+struct bitboard_t* bitboard__new();
+
+/**
+ * @brief Initialize a bitboard from a graph and the queens placed on it.
+ *
+ * Cells without any neighbor in the graph are considered as blocked.
+ *
+ * @param bb The bitboard to initialize.
+ * @param board The graph of the board, as built by shape__init_graph.
+ * @param queens The queens placement on the board.
+ */
+void bitboard__init(struct bitboard_t* bb, struct graph_t* board, struct queens_t* queens);
+
+/**
+ * @brief Free a bitboard.
+ *
+ * @param bb The bitboard to free.
+ */
+void bitboard__free(struct bitboard_t* bb);
+
+/**
+ * @brief Play a move on a bitboard: move the queen, then shoot the arrow.
+ *
+ * @param bb The bitboard.
+ * @param player_id The ID of the player making the move.
+ * @param move The move to play.
+ */
+void bitboard__play(struct bitboard_t* bb, uint player_id, struct move_t move);
+
+/**
+ * @brief Get the set of empty cells of a bitboard.
+ *
+ * @param bb The bitboard.
+ * @return The cells of the shape holding neither an arrow nor a queen.
+ */
+struct bitset_t bitboard__empty(struct bitboard_t* bb);
+
+/**
+ * @brief Compute the cells reached by sliding from a set of cells in one direction.
+ *
+ * @param bb The bitboard.
+ * @param from The cells to slide from.
+ * @param empty The cells a ray can go through.
+ * @param dir The direction of the ray.
+ * @return The cells reached, sources excluded.
+ */
+struct bitset_t bitboard__ray(struct bitboard_t* bb, struct bitset_t from, struct bitset_t empty, enum dir_t dir);
+
+/**
+ * @brief Compute the cells a queen placed on a vertex can reach.
+ *
+ * @param bb The bitboard.
+ * @param pos The vertex of the queen.
+ * @return The cells reachable in any direction.
+ */
+struct bitset_t bitboard__reachable(struct bitboard_t* bb, uint pos);
+
+/**
+ * @brief Generate the legal moves of a player.
+ *
+ * Follows movegen__generate: the arrow is shot once the queen has moved, so it may go through or land on the vertex the queen left.
+ *
+ * @param bb The bitboard.
+ * @param player_id The ID of the player to move.
+ * @param out Where to write the moves. May be NULL if cap is 0.
+ * @param cap The number of moves out can hold, moves beyond it are counted but not written.
+ * @return The number of legal moves.
+ */
+size_t bitboard__generate(struct bitboard_t* bb, uint player_id, struct move_t* out, size_t cap);
+
+/**
+ * @brief Count the legal moves of a player without generating them.
+ *
+ * @param bb The bitboard.
+ * @param player_id The ID of the player to move.
+ * @return The number of legal moves, as returned by bitboard__generate.
+ */
+size_t bitboard__count(struct bitboard_t* bb, uint player_id);
+
+/**
+ * @brief Get the cell of a vertex.
+ *
+ * @param bb The bitboard.
+ * @param pos The vertex.
+ * @return The bit index of the vertex.
+ */
+uint bitboard__to_bit(struct bitboard_t* bb, uint pos);
+
+/**
+ * @brief Get the vertex of a cell.
+ *
+ * @param bb The bitboard.
+ * @param bit The bit index of the cell.
+ * @return The vertex of the cell.
+ */
+uint bitboard__to_vertex(struct bitboard_t* bb, uint bit);
+
+/**
+ * @brief Add a cell to a set.
+ *
+ * @param set The set.
+ * @param bit The bit index of the cell.
+ */
+void bitset__set(struct bitset_t* set, uint bit);
+
+/**
+ * @brief Remove a cell from a set.
+ *
+ * @param set The set.
+ * @param bit The bit index of the cell.
+ */
+void bitset__clear(struct bitset_t* set, uint bit);
+
+/**
+ * @brief Check if a cell belongs to a set.
+ *
+ * @param set The set.
+ * @param bit The bit index of the cell.
+ * @return 1 if the cell belongs to the set, 0 otherwise.
+ */
+int bitset__test(struct bitset_t* set, uint bit);
+
+/**
+ * @brief Count the cells of a set.
+ *
+ * @param set The set.
+ * @return The number of cells of the set.
+ */
+uint bitset__count(struct bitset_t set);
+
+/**
+ * @brief Remove the lowest cell of a set.
+ *
+ * @param set The set, must not be empty.
+ * @return The bit index of the removed cell.
+ */
+uint bitset__pop(struct bitset_t* set);
+
+/**
+ * @brief Check if a set is empty.
+ *
+ * @param set The set.
+ * @return 1 if the set is empty, 0 otherwise.
+ */
+int bitset__is_empty(struct bitset_t set);
+
+#endif // _AMAZON_BITBOARD_H_
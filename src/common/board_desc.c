@@ -0,0 +1,69 @@
+#define _DEFAULT_SOURCE
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "board_desc.h"
+
+// The offset of the image of the graph in the mapping, after the description and the queens, aligned on 8 bytes
+static size_t image_offset(uint num_queens) {
+    size_t offset = sizeof(struct board_desc_t) + 2 * num_queens * sizeof(uint);
+    return (offset + sizeof(uint64_t) - 1) / sizeof(uint64_t) * sizeof(uint64_t);
+}
+
+const struct board_desc_t* board_desc__publish(const struct graph_t* board, const struct queens_t* queens) {
+    if (!board || !board->neighbors) handle_error(__func__, "Invalid parameter 'board'", PROGRAM_EXIT);
+    if (!queens) handle_error(__func__, "Invalid parameter 'queens'", PROGRAM_EXIT);
+
+    size_t image_size = graph__image_size(board);
+    size_t size = image_offset(queens->nb_queens) + image_size;
+    void* mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED)
+        handle_error(__func__, "Not enough memory for the description", PROGRAM_EXIT);
+
+    struct board_desc_t* desc = mapping;
+    uint* queens_array = (uint*)(desc + 1);
+    void* image = (char*)mapping + image_offset(queens->nb_queens);
+
+    graph__write_image(board, image);
+    for (uint player_id = 0; player_id < 2; player_id++) {
+        memcpy(queens_array + player_id * queens->nb_queens, queens->array[player_id], queens->nb_queens * sizeof(uint));
+        desc->queens[player_id] = queens_array + player_id * queens->nb_queens;
+    }
+    desc->num_vertices = board->num_vertices;
+    desc->num_queens = queens->nb_queens;
+    desc->image = image;
+    desc->image_size = image_size;
+
+    // From now on, a client writing to the description crashes instead of corrupting the other one
+    if (mprotect(mapping, size, PROT_READ))
+        handle_error(__func__, "Could not protect the description", PROGRAM_CONTINUE);
+    return desc;
+}
+
+void board_desc__release(const struct board_desc_t* desc) {
+    if (desc)
+        munmap((void*)desc, image_offset(desc->num_queens) + desc->image_size);
+}
+
+struct graph_t* board_desc__to_graph(const struct board_desc_t* desc) {
+    if (!desc) handle_error(__func__, "Invalid parameter 'desc'", PROGRAM_EXIT);
+
+    struct graph_t* board = graph__new();
+    if (graph__init_from_image(board, desc->image, desc->image_size))
+        handle_error(__func__, "Invalid board image", PROGRAM_EXIT);
+    return board;
+}
+
+void board_desc__to_queens(const struct board_desc_t* desc, uint* queens[2]) {
+    if (!desc) handle_error(__func__, "Invalid parameter 'desc'", PROGRAM_EXIT);
+
+    for (uint player_id = 0; player_id < 2; player_id++) {
+        queens[player_id] = malloc(desc->num_queens * sizeof(uint));
+        if (!queens[player_id])
+            handle_error(__func__, "Not enough memory for 'queens[p]'", PROGRAM_EXIT);
+        memcpy(queens[player_id], desc->queens[player_id], desc->num_queens * sizeof(uint));
+    }
+}
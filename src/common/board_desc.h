@@ -0,0 +1,60 @@
+/**
+ * @file board_desc.h
+ * @brief This file contains the immutable description of an initial board shared by the server with the clients.
+ */
+
+#ifndef _AMAZON_BOARD_DESC_H_
+#define _AMAZON_BOARD_DESC_H_
+
+#include "graph.h"
+#include "queens.h"
+#include "utils.h"
+
+/**
+ * @brief A compact description of the initial board, published once in a read-only mapping.
+ *
+ * Every array lives in the same mapping as the structure, and is only valid until the description is released.
+ * The board is kept as the image of the compressed graph (see graph__write_image), so that a client copies it
+ * instead of compressing it again.
+ */
+struct board_desc_t {
+    uint num_vertices; // The number of vertices of the board
+    uint num_queens; // The number of queens of each player
+    const void* image; // The image of the compressed graph of the board
+    size_t image_size; // The number of bytes of the image
+    const uint* queens[2]; // The positions of the queens of each player
+};
+
+/**
+ * @brief Publish the description of a board in a read-only mapping.
+ *
+ * @param board The compressed game board.
+ * @param queens The queens placement on the board.
+ * @return The description, to be released with board_desc__release.
+ */
+const struct board_desc_t* board_desc__publish(const struct graph_t* board, const struct queens_t* queens);
+
+/**
+ * @brief Release a description published by board_desc__publish.
+ *
+ * @param desc The description to release, may be NULL.
+ */
+void board_desc__release(const struct board_desc_t* desc);
+
+/**
+ * @brief Build a private graph from a description.
+ *
+ * @param desc The description of the board.
+ * @return A newly allocated compressed graph, to be freed with graph__free.
+ */
+struct graph_t* board_desc__to_graph(const struct board_desc_t* desc);
+
+/**
+ * @brief Build private copies of the arrays of queens of a description.
+ *
+ * @param desc The description of the board.
+ * @param queens Where to write the newly allocated arrays of each player.
+ */
+void board_desc__to_queens(const struct board_desc_t* desc, uint* queens[2]);
+
+#endif // _AMAZON_BOARD_DESC_H_
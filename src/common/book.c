@@ -0,0 +1,258 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "book.h"
+#include "player.h"
+#include "zobrist.h"
+
+#define BOOK__VERSION 2
+
+static const char book_magic[4] = {'A', 'M', 'Z', 'B'};
+
+struct book_t {
+    void* map;
+    size_t map_size;
+    const struct book_header* header;
+    const struct book_entry* entries;
+};
+
+static uint board_size_of(struct graph_t* board) {
+    uint size = 0;
+    while ((size + 1) * (size + 1) <= board->num_vertices)
+        size++;
+    return size;
+}
+
+// Symmetry s swaps the coordinates if bit 2 is set, then mirrors x if bit 0 is set and y if bit 1 is set
+static uint transform(uint pos, uint size, uint symmetry) {
+    uint x = pos % size;
+    uint y = pos / size;
+    if (symmetry & 4) {
+        uint tmp = x;
+        x = y;
+        y = tmp;
+    }
+    if (symmetry & 1)
+        x = size - 1 - x;
+    if (symmetry & 2)
+        y = size - 1 - y;
+    return y * size + x;
+}
+
+// The moves along x and y of each direction, the first row being the north of the board
+static const int dir_dx[LAST_DIR + 1] = {0, 0, 1, 1, 1, 0, -1, -1, -1};
+static const int dir_dy[LAST_DIR + 1] = {0, -1, -1, 0, 1, 1, 1, 0, -1};
+
+static uint inverse_transform(uint pos, uint size, uint symmetry) {
+    uint x = pos % size;
+    uint y = pos / size;
+    if (symmetry & 1)
+        x = size - 1 - x;
+    if (symmetry & 2)
+        y = size - 1 - y;
+    if (symmetry & 4) {
+        uint tmp = x;
+        x = y;
+        y = tmp;
+    }
+    return y * size + x;
+}
+
+static int compare_entries(const void* a, const void* b) {
+    const struct book_entry* entry_a = a;
+    const struct book_entry* entry_b = b;
+    if (entry_a->key != entry_b->key)
+        return entry_a->key < entry_b->key ? -1 : 1;
+    if (entry_a->score != entry_b->score)
+        return entry_a->score > entry_b->score ? -1 : 1;
+    return memcmp(entry_a->move, entry_b->move, sizeof(entry_a->move));
+}
+
+/* **************************************************************** */
+
+uint64_t book__key(struct graph_t* board, struct queens_t* queens, uint player_id, uint* symmetry) {
+    if (!board) handle_error(__func__, "Invalid parameter 'board'", PROGRAM_EXIT);
+    if (!queens) handle_error(__func__, "Invalid parameter 'queens'", PROGRAM_EXIT);
+
+    uint size = board_size_of(board);
+    uint64_t keys[BOOK__NB_SYMMETRIES] = {0};
+    for (uint pos = 0; pos < size * size; pos++) {
+        if (is_isolated(board, pos))
+            for (uint s = 0; s < BOOK__NB_SYMMETRIES; s++)
+                keys[s] ^= zobrist__blocked(transform(pos, size, s));
+    }
+
+    // The queens of the player to move are keyed as those of the first player
+    for (uint player = 0; player < NUM_PLAYERS; player++) {
+        uint piece = player != player_id;
+        for (uint queen_id = 0; queen_id < queens->nb_queens; queen_id++) {
+            uint pos = queens->array[player][queen_id];
+            if (pos >= size * size)
+                continue;
+            for (uint s = 0; s < BOOK__NB_SYMMETRIES; s++)
+                keys[s] ^= zobrist__queen(piece, transform(pos, size, s));
+        }
+    }
+
+    uint best = 0;
+    for (uint s = 1; s < BOOK__NB_SYMMETRIES; s++)
+        if (keys[s] < keys[best])
+            best = s;
+    if (symmetry)
+        *symmetry = best;
+    return keys[best];
+}
+
+uint64_t book__board_key(struct graph_t* board) {
+    if (!board) handle_error(__func__, "Invalid parameter 'board'", PROGRAM_EXIT);
+
+    uint size = board_size_of(board);
+    uint64_t key = 0;
+    for (uint pos = 0; pos < size * size; pos++) {
+        if (is_isolated(board, pos))
+            continue;
+        for (enum dir_t d = FIRST_DIR; d <= LAST_DIR; d++) {
+            int x = (int)(pos % size) + dir_dx[d];
+            int y = (int)(pos / size) + dir_dy[d];
+            if (x < 0 || y < 0 || x >= (int)size || y >= (int)size)
+                continue;
+            uint neighbor = y * size + x;
+            if (!is_isolated(board, neighbor) && graph__get_neighbor(board, pos, d) != neighbor)
+                key ^= zobrist__mix((uint64_t)pos * NUM_DIRS + d - FIRST_DIR);
+        }
+    }
+    return key;
+}
+
+struct move_t book__to_key_frame(struct move_t move, uint size, uint symmetry) {
+    return (struct move_t){transform(move.queen_src, size, symmetry), transform(move.queen_dst, size, symmetry),
+                           transform(move.arrow_dst, size, symmetry)};
+}
+
+struct move_t book__from_key_frame(struct move_t move, uint size, uint symmetry) {
+    return (struct move_t){inverse_transform(move.queen_src, size, symmetry), inverse_transform(move.queen_dst, size, symmetry),
+                           inverse_transform(move.arrow_dst, size, symmetry)};
+}
+
+int book__write(const char* path, uint size, char board_shape, uint64_t board_key, uint depth, struct book_entry* entries, size_t nb_entries) {
+    if (!path) handle_error(__func__, "Invalid parameter 'path'", PROGRAM_EXIT);
+    if (!entries && nb_entries) handle_error(__func__, "Invalid parameter 'entries'", PROGRAM_EXIT);
+
+    qsort(entries, nb_entries, sizeof(struct book_entry), compare_entries);
+
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        handle_error(__func__, "Could not create the book", PROGRAM_CONTINUE);
+        return -1;
+    }
+    struct book_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, book_magic, sizeof(book_magic));
+    header.version = BOOK__VERSION;
+    header.size = size;
+    header.board_shape = board_shape;
+    header.board_key = board_key;
+    header.depth = depth;
+    header.nb_entries = nb_entries;
+
+    int error = fwrite(&header, sizeof(header), 1, file) != 1;
+    error |= nb_entries && fwrite(entries, sizeof(struct book_entry), nb_entries, file) != nb_entries;
+    error |= fclose(file) != 0;
+    return error ? -1 : 0;
+}
+
+struct book_t* book__open(const char* path) {
+    if (!path) handle_error(__func__, "Invalid parameter 'path'", PROGRAM_EXIT);
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+    struct stat st;
+    if (fstat(fd, &st) || (size_t)st.st_size < sizeof(struct book_header)) {
+        close(fd);
+        return NULL;
+    }
+    void* map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return NULL;
+
+    const struct book_header* header = map;
+    if (memcmp(header->magic, book_magic, sizeof(book_magic)) || header->version != BOOK__VERSION ||
+        header->nb_entries > (st.st_size - sizeof(struct book_header)) / sizeof(struct book_entry)) {
+        munmap(map, st.st_size);
+        return NULL;
+    }
+
+    struct book_t* book = malloc(sizeof(struct book_t));
+    if (!book)
+        handle_error(__func__, "Not enough memory for 'book'", PROGRAM_EXIT);
+    book->map = map;
+    book->map_size = st.st_size;
+    book->header = header;
+    book->entries = (const struct book_entry*)(header + 1);
+    return book;
+}
+
+void book__close(struct book_t* book) {
+    if (!book)
+        return;
+    munmap(book->map, book->map_size);
+    free(book);
+}
+
+const struct book_header* book__get_header(const struct book_t* book) {
+    if (!book) handle_error(__func__, "Invalid parameter 'book'", PROGRAM_EXIT);
+    return book->header;
+}
+
+const struct book_entry* book__find(const struct book_t* book, uint64_t key, size_t* nb_entries) {
+    if (!book) handle_error(__func__, "Invalid parameter 'book'", PROGRAM_EXIT);
+
+    // The first entry whose key is not below the key
+    size_t low = 0;
+    size_t high = book->header->nb_entries;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (book->entries[middle].key < key)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    size_t end = low;
+    while (end < book->header->nb_entries && book->entries[end].key == key)
+        end++;
+    if (nb_entries)
+        *nb_entries = end - low;
+    return end > low ? &book->entries[low] : NULL;
+}
+
+int book__probe(const struct book_t* book, struct graph_t* board, struct queens_t* queens, uint player_id, struct move_t* move, double* score) {
+    if (!book) handle_error(__func__, "Invalid parameter 'book'", PROGRAM_EXIT);
+    if (!move) handle_error(__func__, "Invalid parameter 'move'", PROGRAM_EXIT);
+
+    uint size = board_size_of(board);
+    if (size != book->header->size || size * size != board->num_vertices || book__board_key(board) != book->header->board_key)
+        return 0;
+
+    uint symmetry;
+    size_t nb_entries;
+    const struct book_entry* entry = book__find(book, book__key(board, queens, player_id, &symmetry), &nb_entries);
+    if (!entry)
+        return 0;
+
+    struct move_t book_move = {entry->move[0], entry->move[1], entry->move[2]};
+    book_move = book__from_key_frame(book_move, size, symmetry);
+    if (move__check(board, queens, player_id, book_move) != MOVE_REGULAR)
+        return 0;
+    *move = book_move;
+    if (score)
+        *score = entry->score;
+    return 1;
+}
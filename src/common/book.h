@@ -0,0 +1,163 @@
+/**
+ * @file book.h
+ * @brief This file contains the opening book shared by the book builder and the clients.
+ *
+ * A book maps positions to the best moves found by a deep search. The key of a position is taken in the frame of
+ * the symmetry of the square giving the smallest key, the player to move being seen as the first one, so that the
+ * positions differing by a rotation, a reflection or the colors of the queens share their entries. The moves of an
+ * entry are stored in that frame too.
+ *
+ * The file is a header followed by the entries sorted by key then by decreasing score, so that a position is found
+ * by a binary search in the mapped file, without any lock or allocation. The integers are stored in the byte order
+ * of the machine.
+ */
+
+#ifndef _AMAZON_BOOK_H_
+#define _AMAZON_BOOK_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "graph.h"
+#include "move.h"
+#include "queens.h"
+#include "utils.h"
+
+#define BOOK__NB_SYMMETRIES 8
+
+/**
+ * @brief A struct representing the header of a book.
+ * size is the size of the square board of its positions, board_shape its shape and board_key the key of that shape
+ * (see book__board_key), depth the depth of the search giving the scores.
+ */
+struct book_header {
+    char magic[4];
+    uint32_t version;
+    uint32_t size;
+    uint32_t depth;
+    uint32_t board_shape;
+    uint32_t reserved; // Zero
+    uint64_t board_key;
+    uint64_t nb_entries;
+};
+
+/**
+ * @brief A struct representing a move of a position of a book.
+ * key is the key of the position, move the move in the frame of the key (queen_src, queen_dst, arrow_dst),
+ * score its value for the player to move.
+ */
+struct book_entry {
+    uint64_t key;
+    uint16_t move[3];
+    uint16_t reserved; // Zero
+    float score;
+    uint32_t padding; // Zero
+};
+
+/**
+ * @brief A book mapped in memory.
+ */
+struct book_t;
+
+/**
+ * @brief Computes the key of a position of a square board.
+ *
+ * @param board The game board, whose num_vertices is size * size.
+ * @param queens The queens placement on the board.
+ * @param player_id The player to move.
+ * @param symmetry Where to write the symmetry giving the key, to pass to book__from_key_frame. May be NULL.
+ * @return The key of the position.
+ */
+uint64_t book__key(struct graph_t* board, struct queens_t* queens, uint player_id, uint* symmetry);
+
+/**
+ * @brief Computes the key of the shape of a square board.
+ *
+ * The positions of two shapes of the same size may have the same key, a clover only cutting edges between its
+ * playable cells. The shape is thus keyed by the edges missing between two neighboring cells which both have edges,
+ * which the arrows shot on the board do not change.
+ *
+ * @param board The game board, whose num_vertices is size * size.
+ * @return The key of the shape of the board.
+ */
+uint64_t book__board_key(struct graph_t* board);
+
+/**
+ * @brief Maps a move from the frame of the board to the frame of the key of the position.
+ * @param move The move, not the initial move.
+ * @param size The size of the board.
+ * @param symmetry The symmetry given by book__key.
+ * @return The move in the frame of the key.
+ */
+struct move_t book__to_key_frame(struct move_t move, uint size, uint symmetry);
+
+/**
+ * @brief Maps a move from the frame of the key of the position back to the frame of the board.
+ * @param move The move in the frame of the key.
+ * @param size The size of the board.
+ * @param symmetry The symmetry given by book__key.
+ * @return The move on the board.
+ */
+struct move_t book__from_key_frame(struct move_t move, uint size, uint symmetry);
+
+/**
+ * @brief Sorts entries and writes them to a book.
+ *
+ * @param path The path of the book file.
+ * @param size The size of the board.
+ * @param board_shape The shape of the board.
+ * @param board_key The key of the shape of the board, given by book__board_key.
+ * @param depth The depth of the search giving the scores.
+ * @param entries The entries, sorted in place.
+ * @param nb_entries The number of entries.
+ * @return 0 if the book was written, -1 otherwise.
+ */
+int book__write(const char* path, uint size, char board_shape, uint64_t board_key, uint depth, struct book_entry* entries, size_t nb_entries);
+
+/**
+ * @brief Maps a book in memory, read-only.
+ * @param path The path of the book file.
+ * @return The book, NULL if the file could not be read or is not a book.
+ */
+struct book_t* book__open(const char* path);
+
+/**
+ * @brief Unmaps a book opened by book__open.
+ * @param book The book, may be NULL.
+ */
+void book__close(struct book_t* book);
+
+/**
+ * @brief Gets the header of a book.
+ * @param book The book.
+ * @return The header, valid until the book is closed.
+ */
+const struct book_header* book__get_header(const struct book_t* book);
+
+/**
+ * @brief Looks for the entries of a key in a book.
+ *
+ * @param book The book.
+ * @param key The key of the position, given by book__key.
+ * @param nb_entries Where to write the number of entries of the position.
+ * @return The entries of the position, best first, NULL if there is none.
+ */
+const struct book_entry* book__find(const struct book_t* book, uint64_t key, size_t* nb_entries);
+
+/**
+ * @brief Looks for the best move of a position in a book.
+ *
+ * The book is only probed on boards of its size and shape, and the move is checked on the board, in case another
+ * position has the same key.
+ *
+ * @param book The book.
+ * @param board The game board.
+ * @param queens The queens placement on the board.
+ * @param player_id The player to move.
+ * @param move Where to write the move, in the frame of the board.
+ * @param score Where to write the score of the move. May be NULL.
+ * @return 1 if the position is in the book, 0 otherwise.
+ */
+int book__probe(const struct book_t* book, struct graph_t* board, struct queens_t* queens, uint player_id, struct move_t* move, double* score);
+
+#endif // _AMAZON_BOOK_H_
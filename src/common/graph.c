@@ -1,7 +1,9 @@
 #include <limits.h>
-#include <math.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "graph.h"
+#include "zobrist.h"
 
 struct graph_t* graph__new() {
     struct graph_t* new_b = malloc(sizeof(struct graph_t));
@@ -10,63 +12,287 @@ struct graph_t* graph__new() {
     return new_b;
 }
 
+// Returns the index of the neighbor of pos in direction d in the neighbor table
+static inline uint neighbor_idx(uint pos, enum dir_t d) {
+    return pos * NUM_DIRS + (d - FIRST_DIR);
+}
+
+// Fills the neighbor table from the edges of the CSR matrix
+static void build_neighbors(struct graph_t* board) {
+    for (uint i = 0; i < board->num_vertices * NUM_DIRS; i++)
+        board->neighbors[i] = GRAPH__NO_NEIGHBOR;
+    for (uint pos = 0; pos < board->num_vertices; pos++)
+        for (int k = board->t->p[pos]; k < board->t->p[pos + 1]; k++)
+            if (board->t->data[k] != NO_DIR)
+                board->neighbors[neighbor_idx(pos, board->t->data[k])] = board->t->i[k];
+}
+
+// Fills the twin of every entry of the CSR matrix, -1 if the edge has no reverse edge
+static void build_twins(struct graph_t* board) {
+    gsl_spmatrix_uint* t = board->t;
+    for (uint pos = 0; pos < board->num_vertices; pos++) {
+        for (int k = t->p[pos]; k < t->p[pos + 1]; k++) {
+            uint neighbor = t->i[k];
+            board->twins[k] = -1;
+            for (int l = t->p[neighbor]; l < t->p[neighbor + 1]; l++) {
+                if ((uint)t->i[l] == pos) {
+                    board->twins[k] = l;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+// Resizes the twin array to hold one entry per edge of the CSR matrix
+static void alloc_twins(struct graph_t* board) {
+    size_t nz = board->t->p[board->num_vertices];
+    board->twins = realloc(board->twins, (nz ? nz : 1) * sizeof(int));
+    if (!board->twins)
+        handle_error(__func__, "Not enough memory for 'twins'", PROGRAM_EXIT);
+}
+
+// Returns the width of the grid, given by the first edge going south
+static uint find_width(struct graph_t* board) {
+    for (uint pos = 0; pos < board->num_vertices; pos++)
+        for (int k = board->t->p[pos]; k < board->t->p[pos + 1]; k++)
+            if (board->t->data[k] == DIR_SOUTH)
+                return board->t->i[k] - pos;
+    return 0;
+}
+
 void graph__init(struct graph_t* board, uint num_vertices) {
     board->num_vertices = num_vertices;
+    board->width = 0;
     board->t = gsl_spmatrix_uint_alloc(num_vertices, num_vertices);
+    board->neighbors = NULL;
+    board->twins = NULL;
+    board->key = 0;
+}
+
+// Builds the neighbor table, the width, the reverse-edge index and the key of a compressed graph
+static void build_tables(struct graph_t* board) {
+    free(board->neighbors);
+    board->neighbors = malloc(board->num_vertices * NUM_DIRS * sizeof(uint));
+    if (!board->neighbors)
+        handle_error(__func__, "Not enough memory for 'neighbors'", PROGRAM_EXIT);
+    build_neighbors(board);
+    board->width = find_width(board);
+
+    alloc_twins(board);
+    build_twins(board);
+
+    board->key = 0;
+    for (uint pos = 0; pos < board->num_vertices; pos++)
+        if (is_isolated(board, pos))
+            board->key ^= zobrist__blocked(pos);
 }
 
 void graph__compress(struct graph_t* board) {
     gsl_spmatrix_uint* tmp = board->t;
     board->t = gsl_spmatrix_uint_compress(board->t, GSL_SPMATRIX_CSR);
     gsl_spmatrix_uint_free(tmp);
+    build_tables(board);
+}
+
+void graph__init_from_csr(struct graph_t* board, uint num_vertices, const int* p, const int* i, const uint* data) {
+    size_t nz = p[num_vertices];
+    board->num_vertices = num_vertices;
+    board->t = gsl_spmatrix_uint_alloc_nzmax(num_vertices, num_vertices, nz ? nz : 1, GSL_SPMATRIX_CSR);
+    if (!board->t)
+        handle_error(__func__, "Not enough memory for the graph", PROGRAM_EXIT);
+    memcpy(board->t->p, p, (num_vertices + 1) * sizeof(int));
+    memcpy(board->t->i, i, nz * sizeof(int));
+    memcpy(board->t->data, data, nz * sizeof(uint));
+    board->t->nz = nz;
+    board->neighbors = NULL;
+    board->twins = NULL;
+    build_tables(board);
+}
+
+void graph__memcpy(struct graph_t* dst, struct graph_t* src) {
+    dst->num_vertices = src->num_vertices;
+    dst->width = src->width;
+    gsl_spmatrix_uint_memcpy(dst->t, src->t);
+    memcpy(dst->neighbors, src->neighbors, src->num_vertices * NUM_DIRS * sizeof(uint));
+    alloc_twins(dst);
+    memcpy(dst->twins, src->twins, src->t->p[src->num_vertices] * sizeof(int));
+    dst->key = src->key;
 }
 
 struct graph_t* graph__copy(struct graph_t* board) {
     struct graph_t* new_copy = graph__new();
     graph__init(new_copy, board->num_vertices);
     graph__compress(new_copy);
-    gsl_spmatrix_uint_memcpy(new_copy->t, board->t);
+    graph__memcpy(new_copy, board);
     return new_copy;
 }
 
+// The header of the image of a graph, followed by p, i, data, neighbors and twins
+struct graph_image {
+    uint32_t num_vertices;
+    uint32_t width;
+    uint64_t nz;
+    uint64_t key;
+};
+
+// The number of bytes of the image of a graph, 0 if it cannot have that many edges
+static size_t image_size_for(uint num_vertices, size_t nz) {
+    if (nz > (size_t)num_vertices * NUM_DIRS)
+        return 0;
+    size_t bytes = sizeof(struct graph_image) + (num_vertices + 1 + 3 * nz + (size_t)num_vertices * NUM_DIRS) * sizeof(int);
+    return (bytes + sizeof(uint64_t) - 1) / sizeof(uint64_t) * sizeof(uint64_t);
+}
+
+size_t graph__image_size(const struct graph_t* board) {
+    return image_size_for(board->num_vertices, board->t->p[board->num_vertices]);
+}
+
+void graph__write_image(const struct graph_t* board, void* image) {
+    size_t nz = board->t->p[board->num_vertices];
+    struct graph_image* header = image;
+    memset(image, 0, graph__image_size(board));
+    header->num_vertices = board->num_vertices;
+    header->width = board->width;
+    header->nz = nz;
+    header->key = board->key;
+
+    int* p = (int*)(header + 1);
+    int* i = p + board->num_vertices + 1;
+    uint* data = (uint*)(i + nz);
+    uint* neighbors = data + nz;
+    int* twins = (int*)(neighbors + (size_t)board->num_vertices * NUM_DIRS);
+    memcpy(p, board->t->p, (board->num_vertices + 1) * sizeof(int));
+    memcpy(i, board->t->i, nz * sizeof(int));
+    memcpy(data, board->t->data, nz * sizeof(uint));
+    memcpy(neighbors, board->neighbors, (size_t)board->num_vertices * NUM_DIRS * sizeof(uint));
+    memcpy(twins, board->twins, nz * sizeof(int));
+}
+
+uint graph__check_image(const void* image, size_t size) {
+    const struct graph_image* header = image;
+    if (size < sizeof(struct graph_image) || !header->num_vertices || image_size_for(header->num_vertices, header->nz) != size)
+        return 0;
+
+    uint num_vertices = header->num_vertices;
+    size_t nz = header->nz;
+    const int* p = (const int*)(header + 1);
+    const int* i = p + num_vertices + 1;
+    const uint* data = (const uint*)(i + nz);
+    const uint* neighbors = data + nz;
+    const int* twins = (const int*)(neighbors + (size_t)num_vertices * NUM_DIRS);
+
+    // The indices are checked so that a damaged image cannot make the graph read out of its arrays
+    if (p[0] != 0 || (size_t)p[num_vertices] != nz)
+        return 0;
+    for (uint pos = 0; pos < num_vertices; pos++)
+        if (p[pos + 1] < p[pos])
+            return 0;
+    for (size_t k = 0; k < nz; k++)
+        if ((uint)i[k] >= num_vertices || data[k] > LAST_DIR || twins[k] < -1 || twins[k] >= (int)nz)
+            return 0;
+    for (size_t k = 0; k < (size_t)num_vertices * NUM_DIRS; k++)
+        if (neighbors[k] != GRAPH__NO_NEIGHBOR && neighbors[k] >= num_vertices)
+            return 0;
+    return num_vertices;
+}
+
+void graph__copy_image(struct graph_t* board, const void* image) {
+    const struct graph_image* header = image;
+    uint num_vertices = header->num_vertices;
+    size_t nz = header->nz;
+    const int* p = (const int*)(header + 1);
+    const int* i = p + num_vertices + 1;
+    const uint* data = (const uint*)(i + nz);
+    const uint* neighbors = data + nz;
+    const int* twins = (const int*)(neighbors + (size_t)num_vertices * NUM_DIRS);
+
+    board->num_vertices = num_vertices;
+    board->width = header->width;
+    board->key = header->key;
+    board->t = gsl_spmatrix_uint_alloc_nzmax(num_vertices, num_vertices, nz ? nz : 1, GSL_SPMATRIX_CSR);
+    board->neighbors = malloc((size_t)num_vertices * NUM_DIRS * sizeof(uint));
+    board->twins = malloc((nz ? nz : 1) * sizeof(int));
+    if (!board->t || !board->neighbors || !board->twins)
+        handle_error(__func__, "Not enough memory for the graph", PROGRAM_EXIT);
+    memcpy(board->t->p, p, (num_vertices + 1) * sizeof(int));
+    memcpy(board->t->i, i, nz * sizeof(int));
+    memcpy(board->t->data, data, nz * sizeof(uint));
+    board->t->nz = nz;
+    memcpy(board->neighbors, neighbors, (size_t)num_vertices * NUM_DIRS * sizeof(uint));
+    memcpy(board->twins, twins, nz * sizeof(int));
+}
+
+int graph__init_from_image(struct graph_t* board, const void* image, size_t size) {
+    if (!graph__check_image(image, size))
+        return -1;
+    graph__copy_image(board, image);
+    return 0;
+}
+
 void graph__free(struct graph_t* board) {
     if (board) {
         gsl_spmatrix_uint_free(board->t);
+        free(board->neighbors);
+        free(board->twins);
     }
     free(board);
     board = NULL;
 }
 
-static inline void graph__replace_neighbors(struct graph_t* board, uint x, uint size, int to_no_dir) {
-    enum dir_t dirs[] = {DIR_SOUTH, DIR_NORTH, DIR_EAST, DIR_WEST, DIR_SE, DIR_NW, DIR_NE, DIR_SW};
-    uint i = x / size, j = x % size;
-    uint* ptr = NULL;
-    if (to_no_dir)
-        for (uint i = 0; i < NUM_DIRS; i++)
-            dirs[i] = NO_DIR;
-    if (i > 0 && (ptr = gsl_spmatrix_uint_ptr(board->t, x - size, x)))
-        *ptr = dirs[0];
-    if (i < size - 1 && (ptr = gsl_spmatrix_uint_ptr(board->t, x + size, x)))
-        *ptr = dirs[1];
-    if (j > 0 && (ptr = gsl_spmatrix_uint_ptr(board->t, x - 1, x)))
-        *ptr = dirs[2];
-    if (j < size - 1 && (ptr = gsl_spmatrix_uint_ptr(board->t, x + 1, x)))
-        *ptr = dirs[3];
-    if (i > 0 && j > 0 && (ptr = gsl_spmatrix_uint_ptr(board->t, x - size - 1, x)))
-        *ptr = dirs[4];
-    if (i < size - 1 && j < size - 1 &&
-        (ptr = gsl_spmatrix_uint_ptr(board->t, x + size + 1, x)))
-        *ptr = dirs[5];
-    if (j > 0 && i < size - 1 && (ptr = gsl_spmatrix_uint_ptr(board->t, x - 1 + size, x)))
-        *ptr = dirs[6];
-    if (j < size - 1 && i > 0 && (ptr = gsl_spmatrix_uint_ptr(board->t, x + 1 - size, x)))
-        *ptr = dirs[7];
+void graph__disconnect(struct graph_t* board, uint pos) {
+    gsl_spmatrix_uint* t = board->t;
+    if (!is_isolated(board, pos))
+        board->key ^= zobrist__blocked(pos);
+    for (int k = t->p[pos]; k < t->p[pos + 1]; k++) {
+        int twin = board->twins[k];
+        if (twin >= 0 && t->data[twin] != NO_DIR) {
+            uint neighbor = t->i[k];
+            board->neighbors[neighbor_idx(neighbor, t->data[twin])] = GRAPH__NO_NEIGHBOR;
+            t->data[twin] = NO_DIR;
+            if (is_isolated(board, neighbor))
+                board->key ^= zobrist__blocked(neighbor);
+        }
+        t->data[k] = NO_DIR;
+    }
+    for (enum dir_t d = FIRST_DIR; d <= LAST_DIR; d++)
+        board->neighbors[neighbor_idx(pos, d)] = GRAPH__NO_NEIGHBOR;
 }
 
-void graph__disconnect(struct graph_t* board, uint pos) {
-    graph__replace_neighbors(board, pos, (int)sqrt(board->num_vertices), 1);
-    for (int k = board->t->p[pos]; k < board->t->p[pos + 1]; k++) {
-        board->t->data[k] = NO_DIR;
+void graph__disconnect_saved(struct graph_t* board, uint pos, struct graph_undo_t* undo) {
+    gsl_spmatrix_uint* t = board->t;
+    int first = t->p[pos];
+
+    undo->pos = pos;
+    undo->key = board->key;
+    undo->nb_edges = t->p[pos + 1] - first;
+    assert(undo->nb_edges <= NUM_DIRS);
+    for (uint e = 0; e < undo->nb_edges; e++) {
+        int twin = board->twins[first + e];
+        undo->row[e] = t->data[first + e];
+        undo->twins[e] = twin >= 0 ? t->data[twin] : NO_DIR;
+    }
+
+    graph__disconnect(board, pos);
+}
+
+void graph__reconnect(struct graph_t* board, struct graph_undo_t* undo) {
+    gsl_spmatrix_uint* t = board->t;
+    int first = t->p[undo->pos];
+
+    board->key = undo->key;
+    for (uint e = 0; e < undo->nb_edges; e++) {
+        int k = first + e;
+        int twin = board->twins[k];
+        uint neighbor = t->i[k];
+        t->data[k] = undo->row[e];
+        if (undo->row[e] != NO_DIR)
+            board->neighbors[neighbor_idx(undo->pos, undo->row[e])] = neighbor;
+        if (twin >= 0) {
+            t->data[twin] = undo->twins[e];
+            if (undo->twins[e] != NO_DIR)
+                board->neighbors[neighbor_idx(neighbor, undo->twins[e])] = undo->pos;
+        }
     }
 }
 
@@ -74,19 +300,30 @@ void graph__disconnect(struct graph_t* board, uint pos) {
 uint graph__get_neighbor(struct graph_t* g, uint pos, enum dir_t d) {
     if (pos == UINT_MAX)
         return pos;
-    for (int k = g->t->p[pos]; k < g->t->p[pos + 1]; k++) {
-        if (g->t->data[k] == d)
-            return g->t->i[k];
-    }
-    return UINT_MAX;
+    return g->neighbors[neighbor_idx(pos, d)];
+}
+
+enum dir_t graph__get_direction(struct graph_t* board, uint pos1, uint pos2) {
+    if (!board->width)
+        return DIR_ERROR;
+    int d_row = (int)(pos2 / board->width) - (int)(pos1 / board->width);
+    int d_col = (int)(pos2 % board->width) - (int)(pos1 % board->width);
+
+    if (d_row && d_col && d_row != d_col && d_row != -d_col)
+        return NO_DIR;
+    if (d_row < 0)
+        return d_col < 0 ? DIR_NW : (d_col > 0 ? DIR_NE : DIR_NORTH);
+    if (d_row > 0)
+        return d_col < 0 ? DIR_SW : (d_col > 0 ? DIR_SE : DIR_SOUTH);
+    return d_col < 0 ? DIR_WEST : (d_col > 0 ? DIR_EAST : NO_DIR);
 }
 
 // Returns 1 if pos is isolated 0 otherwise
 int is_isolated(struct graph_t* g, uint pos) {
     if (pos == UINT_MAX)
         return 1;
-    for (int k = g->t->p[pos]; k < g->t->p[pos + 1]; k++)
-        if (g->t->data[k])
+    for (enum dir_t d = FIRST_DIR; d <= LAST_DIR; d++)
+        if (g->neighbors[neighbor_idx(pos, d)] != GRAPH__NO_NEIGHBOR)
             return 0;
     return 1;
 }
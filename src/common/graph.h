@@ -9,18 +9,41 @@
 #include <gsl/gsl_spblas.h>
 #include <gsl/gsl_spmatrix.h>
 #include <gsl/gsl_spmatrix_uint.h>
+#include <limits.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #include "dir.h"
 #include "utils.h"
 
+#define GRAPH__NO_NEIGHBOR UINT_MAX
+
 struct graph_t {
     unsigned int num_vertices; // Number of vertices in the graph
+    unsigned int width; // Width of the grid the vertices are laid out on in row-major order,
+                        // deduced from the edges, 0 if the graph has no DIR_SOUTH edge
     gsl_spmatrix_uint* t; // Sparse matrix of size n*n,
                           // t[i][j] > 0 means there is an edge from i to j
                           // t[i][j] == DIR_NORTH means that j is NORTH of i
                           // t[i][j] == DIR_SOUTH means that j is SOUTH of i
                           // and so on
+    uint* neighbors; // Dense table of size num_vertices*NUM_DIRS,
+                     // neighbors[i*NUM_DIRS + (d - FIRST_DIR)] is the neighbor
+                     // of i in direction d, GRAPH__NO_NEIGHBOR if there is none
+    int* twins; // Reverse-edge index of size nz, if t->data[k] is the edge from i
+                // to j, t->data[twins[k]] is the edge from j to i (-1 if none)
+    uint64_t key; // Zobrist key of the vertices without any edge (see zobrist.h)
+};
+
+/**
+ * @brief The edges overwritten when a vertex is disconnected, used to reconnect it.
+ */
+struct graph_undo_t {
+    uint pos; // The disconnected vertex
+    uint nb_edges; // The number of edges leaving pos
+    uint row[NUM_DIRS]; // The previous values of the edges leaving pos
+    uint twins[NUM_DIRS]; // The previous values of the edges reaching pos
+    uint64_t key; // The previous Zobrist key of the graph
 };
 
 /**
@@ -39,12 +62,25 @@ struct graph_t* graph__new();
 void graph__init(struct graph_t* board, uint num_vertices);
 
 /**
- * @brief Compresses a graph using the compressed sparse row (CSR) format.
+ * @brief Compresses a graph using the compressed sparse row (CSR) format
+ * and builds its neighbor table and reverse-edge index.
  *
  * @param board The graph to compress.
  */
 void graph__compress(struct graph_t* board);
 
+/**
+ * @brief Initializes a compressed graph from the arrays of its CSR matrix,
+ * and builds its neighbor table and reverse-edge index.
+ *
+ * @param board The graph to initialize.
+ * @param num_vertices The number of vertices of the graph.
+ * @param p The index of the first edge of each vertex in i and data, followed by the number of edges.
+ * @param i The vertex reached by each edge, in increasing order for the edges of a vertex.
+ * @param data The direction of each edge.
+ */
+void graph__init_from_csr(struct graph_t* board, uint num_vertices, const int* p, const int* i, const uint* data);
+
 /**
  * @brief Creates a copy of a graph.
  *
@@ -54,20 +90,88 @@ void graph__compress(struct graph_t* board);
 struct graph_t* graph__copy(struct graph_t* board);
 
 /**
- * @brief Compress the matrix of the graph and replace it by the compressed matrix. Free the old matrix.
+ * @brief Copies a compressed graph into another one of the same size.
+ *
+ * @param dst The destination graph, already initialized and compressed.
+ * @param src The graph to copy.
+ */
+void graph__memcpy(struct graph_t* dst, struct graph_t* src);
+
+/**
+ * @brief Returns the number of bytes of the image of a compressed graph.
+ *
+ * The image holds the CSR matrix, the neighbor table, the reverse-edge index and the Zobrist key of the graph,
+ * so that the graph is rebuilt from it by copies only. Its integers are in the byte order of the machine.
+ *
+ * @param board The compressed graph.
+ * @return The size of the image, a multiple of 8.
+ */
+size_t graph__image_size(const struct graph_t* board);
+
+/**
+ * @brief Writes the image of a compressed graph.
+ *
+ * @param board The compressed graph.
+ * @param image Where to write the image, of graph__image_size bytes, aligned on 8 bytes.
+ */
+void graph__write_image(const struct graph_t* board, void* image);
+
+/**
+ * @brief Checks that an image was written by graph__write_image, so that a graph copied from it stays in its arrays.
+ *
+ * @param image The image, aligned on 8 bytes.
+ * @param size The number of bytes of the image.
+ * @return The number of vertices of the graph of the image, 0 if the image is not that of a graph.
+ */
+uint graph__check_image(const void* image, size_t size);
+
+/**
+ * @brief Initializes a compressed graph from an image already checked by graph__check_image, by copies only.
  *
- * @param b - The address of the graph.
+ * @param board The graph to initialize.
+ * @param image The image, aligned on 8 bytes.
  */
-void graph__compress(struct graph_t* b);
+void graph__copy_image(struct graph_t* board, const void* image);
+
+/**
+ * @brief Initializes a compressed graph from an image written by graph__write_image, checking it first.
+ *
+ * @param board The graph to initialize.
+ * @param image The image, aligned on 8 bytes.
+ * @param size The number of bytes of the image.
+ * @return 0 if the graph was initialized, -1 if the image is not that of a graph, the graph being left uninitialized.
+ */
+int graph__init_from_image(struct graph_t* board, const void* image, size_t size);
 
 /**
  * @brief Disconnects a vertex from its neighbors in a graph.
  *
+ * The Zobrist key of the graph is updated for the vertices left without any edge.
+ *
  * @param board The graph.
  * @param pos The position of the vertex to disconnect.
  */
 void graph__disconnect(struct graph_t* board, uint pos);
 
+/**
+ * @brief Disconnects a vertex from its neighbors in a graph, saving the overwritten edges.
+ *
+ * @param board The graph.
+ * @param pos The position of the vertex to disconnect.
+ * @param undo Where to save the edges overwritten by the disconnection.
+ */
+void graph__disconnect_saved(struct graph_t* board, uint pos, struct graph_undo_t* undo);
+
+/**
+ * @brief Restores the edges of a vertex disconnected by graph__disconnect_saved.
+ *
+ * Disconnections must be reverted in the reverse order they were made.
+ *
+ * @param board The graph.
+ * @param undo The edges saved by graph__disconnect_saved.
+ */
+void graph__reconnect(struct graph_t* board, struct graph_undo_t* undo);
+
 /**
  * @brief Returns the neighbor of a vertex in a graph in a given direction.
  *
@@ -78,6 +182,17 @@ void graph__disconnect(struct graph_t* board, uint pos);
  */
 uint graph__get_neighbor(struct graph_t* board, uint pos, enum dir_t dir);
 
+/**
+ * @brief Returns the direction of the line going from a vertex to another one.
+ *
+ * @param board The graph.
+ * @param pos1 The position of the first vertex.
+ * @param pos2 The position of the second vertex.
+ * @return The direction from pos1 to pos2 if they are on a same row, column or diagonal of the
+ * grid, NO_DIR otherwise, DIR_ERROR if the width of the grid is unknown.
+ */
+enum dir_t graph__get_direction(struct graph_t* board, uint pos1, uint pos2);
+
 /**
  * @brief Checks if a vertex in a graph is isolated.
  *
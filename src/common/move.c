@@ -1,6 +1,7 @@
 #include "move.h"
 #include <string.h>
 #include "queens.h"
+#include "zobrist.h"
 
 struct move_t create_initial_move() {
     return (struct move_t){UINT_MAX, UINT_MAX, UINT_MAX};
@@ -10,19 +11,28 @@ int is_initial_move(struct move_t m) {
     return m.arrow_dst == UINT_MAX || m.queen_dst == UINT_MAX || m.queen_src == UINT_MAX;
 }
 
-int can_reach_direction(struct graph_t* board, struct queens_t* queens, uint pos1, uint pos2, enum dir_t dir) {
-    if (pos1 == UINT_MAX || queens__exist_queens(queens, pos1)) {
-        return 0;
-    }
-    if (pos1 == pos2) {
-        return 1;
+// Returns 1 if pos2 is reached by sliding from pos1 in direction dir through empty vertices, 0 otherwise
+static int can_reach_direction(struct graph_t* board, struct queens_t* queens, uint pos1, uint pos2, enum dir_t dir) {
+    uint pos = graph__get_neighbor(board, pos1, dir);
+    while (pos != GRAPH__NO_NEIGHBOR && !queens__exist_queens(queens, pos)) {
+        if (pos == pos2)
+            return 1;
+        pos = graph__get_neighbor(board, pos, dir);
     }
-    return can_reach_direction(board, queens, graph__get_neighbor(board, pos1, dir), pos2, dir);
+    return 0;
 }
 
 int can_reach_position(struct graph_t* board, struct queens_t* queens, uint pos1, uint pos2) {
+    if (pos1 >= board->num_vertices || pos2 >= board->num_vertices)
+        return 0;
+
+    /* Only the ray going towards pos2 is walked when the layout of the grid is known */
+    enum dir_t dir = graph__get_direction(board, pos1, pos2);
+    if (dir != DIR_ERROR)
+        return dir != NO_DIR && can_reach_direction(board, queens, pos1, pos2, dir) ? dir : 0;
+
     for (enum dir_t d = FIRST_DIR; d <= LAST_DIR; d++) {
-        if (can_reach_direction(board, queens, graph__get_neighbor(board, pos1, d), pos2, d)) {
+        if (can_reach_direction(board, queens, pos1, pos2, d)) {
             return d;
         }
     }
@@ -35,16 +45,52 @@ int is_valid_move_for_player(struct graph_t* board, struct queens_t* queens, uin
     return can_reach_position(board, queens, id_src, id_dst);
 }
 
+int move__check(struct graph_t* board, struct queens_t* queens, uint player_id, struct move_t move) {
+    if (!is_valid_move_for_player(board, queens, player_id, move.queen_src, move.queen_dst, 0))
+        return MOVE_INVALID_QUEEN_MISPLACED;
+
+    // The arrow may go through or land on the source the queen left
+    move_queen(queens, player_id, move);
+    int is_valid_arrow_move = is_valid_move_for_player(board, queens, player_id, move.queen_dst, move.arrow_dst, 1);
+    move_queen(queens, player_id, (struct move_t){move.queen_dst, move.queen_src, move.arrow_dst});
+
+    if (!is_valid_arrow_move)
+        return MOVE_INVALID_ARROW_MISPLACED;
+    return MOVE_REGULAR;
+}
+
 void move_queen(struct queens_t* queens, uint player_id, struct move_t move) {
-    for (uint queen_id = 0; queen_id < queens->nb_queens; queen_id++) {
-        if (queens->array[player_id][queen_id] == move.queen_src) { // If the queen is the one to be moved
-            queens->array[player_id][queen_id] = move.queen_dst; // Move the queen to its destination position
-            return;
-        }
-    }
+    uint queen_id = queens__get_queen_id(queens, player_id, move.queen_src);
+
+    // The queen to be moved must exist
+    assert(queen_id != QUEENS__NO_QUEEN);
+    queens__set(queens, player_id, queen_id, move.queen_dst); // Move the queen to its destination position
+}
+
+void move__make(struct graph_t* board, struct queens_t* queens, uint player_id, struct move_t move, struct move_undo_t* undo) {
+    undo->move = move;
+    undo->player_id = player_id;
+    undo->is_played = !is_initial_move(move);
+    if (!undo->is_played)
+        return;
+
+    undo->queen_id = queens__get_queen_id(queens, player_id, move.queen_src);
+    assert(undo->queen_id != QUEENS__NO_QUEEN);
+    queens__set(queens, player_id, undo->queen_id, move.queen_dst);
+
+    graph__disconnect_saved(board, move.arrow_dst, &undo->arrow);
+}
+
+void move__unmake(struct graph_t* board, struct queens_t* queens, struct move_undo_t* undo) {
+    if (!undo->is_played)
+        return;
+
+    graph__reconnect(board, &undo->arrow);
+    queens__set(queens, undo->player_id, undo->queen_id, undo->move.queen_src);
+}
 
-    // If the function reaches this point, it means the queen to be moved was not found
-    assert(0);
+uint64_t move__position_key(struct graph_t* board, struct queens_t* queens, uint player_id) {
+    return board->key ^ queens->key ^ (player_id ? zobrist__side() : 0);
 }
 
 int can_move(struct graph_t* board, struct queens_t* queens, uint pos) {
@@ -8,6 +8,7 @@
 
 #include <limits.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #include "graph.h"
 #include "queens.h"
@@ -19,10 +20,23 @@ struct move_t {
     unsigned int arrow_dst; // The id of the cell where the arrow fell
 };
 
+/**
+ * @brief The state overwritten by move__make, used by move__unmake to take the move back.
+ */
+struct move_undo_t {
+    struct move_t move; // The move that was made
+    uint player_id; // The player who made the move
+    uint queen_id; // The slot of the moved queen in the queens array of the player
+    int is_played; // 0 if the move was the initial move and nothing was changed
+    struct graph_undo_t arrow; // The edges cut by the arrow
+};
+
 enum { MOVE_REGULAR,
        MOVE_INVALID,
        MOVE_INVALID_ARROW_MISPLACED,
-       MOVE_INVALID_QUEEN_MISPLACED };
+       MOVE_INVALID_QUEEN_MISPLACED,
+       MOVE_INVALID_TIMEOUT,
+       MOVE_INVALID_CRASH };
 
 /**
  * @brief Get the initial move, which is defined as a move with all three fields set to UINT_MAX.
@@ -65,6 +79,18 @@ int can_reach_position(struct graph_t* board, struct queens_t* queens, uint pos1
  */
 int is_valid_move_for_player(struct graph_t* board, struct queens_t* queens, uint player_id, uint id_src, uint id_dst, int is_arrow);
 
+/**
+ * @brief Check a whole move of a player, the arrow being shot once the queen has left its source.
+ *
+ * @param board The game board.
+ * @param queens The queens placement on the board, left unchanged.
+ * @param player_id The id of the player making the move.
+ * @param move The move to check.
+ *
+ * @return MOVE_REGULAR if the move is legal, MOVE_INVALID_QUEEN_MISPLACED or MOVE_INVALID_ARROW_MISPLACED otherwise.
+ */
+int move__check(struct graph_t* board, struct queens_t* queens, uint player_id, struct move_t move);
+
 /**
  * @brief Move a queen piece in a queens_t structure.
  *
@@ -74,6 +100,43 @@ int is_valid_move_for_player(struct graph_t* board, struct queens_t* queens, uin
  */
 void move_queen(struct queens_t* queens, uint player_id, struct move_t move);
 
+/**
+ * @brief Play a move on a board, saving what is needed to take it back.
+ *
+ * The queen is moved, then the vertex hit by the arrow is disconnected.
+ * Nothing is done for the initial move.
+ *
+ * @param board The game board.
+ * @param queens The queens placement on the board.
+ * @param player_id The ID of the player making the move.
+ * @param move The move to play.
+ * @param undo Where to save the state overwritten by the move.
+ */
+void move__make(struct graph_t* board, struct queens_t* queens, uint player_id, struct move_t move, struct move_undo_t* undo);
+
+/**
+ * @brief Take back a move played by move__make.
+ *
+ * Moves must be taken back in the reverse order they were made.
+ *
+ * @param board The game board.
+ * @param queens The queens placement on the board.
+ * @param undo The state saved by move__make.
+ */
+void move__unmake(struct graph_t* board, struct queens_t* queens, struct move_undo_t* undo);
+
+/**
+ * @brief Get the Zobrist key of a position.
+ *
+ * The key is maintained incrementally by graph__disconnect, move_queen and move__make.
+ *
+ * @param board The game board.
+ * @param queens The queens placement on the board.
+ * @param player_id The ID of the player to move.
+ * @return The 64-bit key of the position.
+ */
+uint64_t move__position_key(struct graph_t* board, struct queens_t* queens, uint player_id);
+
 /**
  * @brief Check if a queen at a certain position can move to a neighboring empty cell.
  *
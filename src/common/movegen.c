@@ -0,0 +1,82 @@
+#include "movegen.h"
+
+// Returns 1 if a queen or an arrow can go through pos
+static inline int is_free(struct queens_t* queens, uint pos, uint vacated) {
+    return pos == vacated || !queens__exist_queens(queens, pos);
+}
+
+uint movegen__ray(struct graph_t* board, struct queens_t* queens, uint src, enum dir_t dir, uint vacated, uint* out) {
+    uint count = 0;
+    uint pos = graph__get_neighbor(board, src, dir);
+    while (pos != GRAPH__NO_NEIGHBOR && is_free(queens, pos, vacated)) {
+        if (out)
+            out[count] = pos;
+        count++;
+        pos = graph__get_neighbor(board, pos, dir);
+    }
+    return count;
+}
+
+uint movegen__targets(struct graph_t* board, struct queens_t* queens, uint src, uint vacated, uint* out) {
+    uint count = 0;
+    for (enum dir_t d = FIRST_DIR; d <= LAST_DIR; d++)
+        count += movegen__ray(board, queens, src, d, vacated, out ? out + count : NULL);
+    return count;
+}
+
+size_t movegen__generate(struct graph_t* board, struct queens_t* queens, uint player_id, struct move_t* out, size_t cap) {
+    size_t count = 0;
+    for (uint queen_id = 0; queen_id < queens->nb_queens; queen_id++) {
+        uint queen_src = queens->array[player_id][queen_id];
+        if (queen_src >= board->num_vertices)
+            continue;
+        for (enum dir_t d1 = FIRST_DIR; d1 <= LAST_DIR; d1++) {
+            uint queen_dst = graph__get_neighbor(board, queen_src, d1);
+            while (queen_dst != GRAPH__NO_NEIGHBOR && is_free(queens, queen_dst, MOVEGEN__NO_VACATED)) {
+                for (enum dir_t d2 = FIRST_DIR; d2 <= LAST_DIR; d2++) {
+                    uint arrow_dst = graph__get_neighbor(board, queen_dst, d2);
+                    while (arrow_dst != GRAPH__NO_NEIGHBOR && is_free(queens, arrow_dst, queen_src)) {
+                        if (count < cap)
+                            out[count] = (struct move_t){queen_src, queen_dst, arrow_dst};
+                        count++;
+                        arrow_dst = graph__get_neighbor(board, arrow_dst, d2);
+                    }
+                }
+                queen_dst = graph__get_neighbor(board, queen_dst, d1);
+            }
+        }
+    }
+    return count;
+}
+
+// Returns the direction going back along dir
+static inline enum dir_t opposite_dir(enum dir_t dir) {
+    return (dir - FIRST_DIR + NUM_DIRS / 2) % NUM_DIRS + FIRST_DIR;
+}
+
+size_t movegen__count(struct graph_t* board, struct queens_t* queens, uint player_id) {
+    size_t count = 0;
+    for (uint queen_id = 0; queen_id < queens->nb_queens; queen_id++) {
+        uint queen_src = queens->array[player_id][queen_id];
+        if (queen_src >= board->num_vertices)
+            continue;
+        uint lengths[LAST_DIR + 1];
+        for (enum dir_t d = FIRST_DIR; d <= LAST_DIR; d++)
+            lengths[d] = movegen__ray(board, queens, queen_src, d, MOVEGEN__NO_VACATED, NULL);
+
+        for (enum dir_t d1 = FIRST_DIR; d1 <= LAST_DIR; d1++) {
+            // Along the line of the move, the arrows reach both ends of the line through queen_src wherever the queen stops
+            enum dir_t back = opposite_dir(d1);
+            count += (size_t)lengths[d1] * (lengths[d1] + lengths[back]);
+
+            uint queen_dst = queen_src;
+            for (uint step = 0; step < lengths[d1]; step++) {
+                queen_dst = graph__get_neighbor(board, queen_dst, d1);
+                for (enum dir_t d2 = FIRST_DIR; d2 <= LAST_DIR; d2++)
+                    if (d2 != d1 && d2 != back)
+                        count += movegen__ray(board, queens, queen_dst, d2, queen_src, NULL);
+            }
+        }
+    }
+    return count;
+}
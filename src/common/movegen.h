@@ -0,0 +1,71 @@
+/**
+ * @file movegen.h
+ * @brief This file contains the legal move generator shared by the server and the clients.
+ */
+
+#ifndef _AMAZON_MOVEGEN_H_
+#define _AMAZON_MOVEGEN_H_
+
+#include <stddef.h>
+
+#include "dir.h"
+#include "graph.h"
+#include "move.h"
+#include "queens.h"
+#include "utils.h"
+
+#define MOVEGEN__NO_VACATED UINT_MAX
+
+/**
+ * @brief List the empty vertices met by sliding from a vertex in one direction.
+ *
+ * @param board The game board.
+ * @param queens The queens placement on the board.
+ * @param src The vertex to slide from.
+ * @param dir The direction to slide in.
+ * @param vacated A vertex considered as empty even if a queen is on it, MOVEGEN__NO_VACATED if none.
+ * @param out Where to write the vertices, from the nearest to the farthest. May be NULL to only count them.
+ * @return The number of vertices met.
+ */
+uint movegen__ray(struct graph_t* board, struct queens_t* queens, uint src, enum dir_t dir, uint vacated, uint* out);
+
+/**
+ * @brief List the empty vertices reachable from a vertex in any direction.
+ *
+ * @param board The game board.
+ * @param queens The queens placement on the board.
+ * @param src The vertex to slide from.
+ * @param vacated A vertex considered as empty even if a queen is on it, MOVEGEN__NO_VACATED if none.
+ * @param out Where to write the vertices, direction by direction. May be NULL to only count them.
+ * @return The number of vertices reachable.
+ */
+uint movegen__targets(struct graph_t* board, struct queens_t* queens, uint src, uint vacated, uint* out);
+
+/**
+ * @brief Generate the legal moves of a player.
+ *
+ * The arrow is shot once the queen has moved, so it may go through or land on the vertex the queen left.
+ *
+ * @param board The game board.
+ * @param queens The queens placement on the board.
+ * @param player_id The ID of the player to move.
+ * @param out Where to write the moves. May be NULL if cap is 0.
+ * @param cap The number of moves out can hold, moves beyond it are counted but not written.
+ * @return The number of legal moves.
+ */
+size_t movegen__generate(struct graph_t* board, struct queens_t* queens, uint player_id, struct move_t* out, size_t cap);
+
+/**
+ * @brief Count the legal moves of a player without listing them.
+ *
+ * The arrows shot along the line of the move of a queen are counted once per line rather than once per destination,
+ * as they always reach both ends of the line through the vertex the queen left.
+ *
+ * @param board The game board.
+ * @param queens The queens placement on the board.
+ * @param player_id The ID of the player to move.
+ * @return The number of legal moves.
+ */
+size_t movegen__count(struct graph_t* board, struct queens_t* queens, uint player_id);
+
+#endif // _AMAZON_MOVEGEN_H_
@@ -5,6 +5,7 @@
 
 #define NUM_PLAYERS 2
 
+#include "board_desc.h"
 #include "graph.h"
 #include "move.h"
 
@@ -14,6 +15,16 @@
  */
 char const* get_player_name();
 
+/* Gives the seed of the random generator of the player, drawn from the
+   seed of the game, so that a game can be played again exactly
+ * OPTIONAL: the server only calls it if the player defines it, before
+ *           `initialize`; the players built on player_common get it
+ *           through `pc__random`
+ * PARAM:
+ * - seed: the seed of the player
+ */
+void set_seed(unsigned long long seed);
+
 /* Player initialization
  * PARAM:
  * - player_id:    the id of the player, between 0 and NUM_PLAYERS-1
@@ -34,6 +45,18 @@ char const* get_player_name();
  */
 void initialize(unsigned int player_id, struct graph_t* graph, unsigned int num_queens, unsigned int* queens[NUM_PLAYERS]);
 
+/* Player initialization from a board shared with the server
+ * OPTIONAL: if the player defines it, the server calls it instead of
+ * `initialize` and does not build a private copy of the board
+ * PARAM:
+ * - player_id: the id of the player, between 0 and NUM_PLAYERS-1
+ * - board:     a read-only description of the initial board and queens,
+ *              from which the player builds its own structures
+ * PRECOND:
+ * - `board` is owned by the server and only valid during this call
+ */
+void initialize_shared(unsigned int player_id, const struct board_desc_t* board);
+
 /* Computes next move
  * PARAM:
  * - previous_move: the move from the previous player. If this is the
@@ -43,6 +66,46 @@ void initialize(unsigned int player_id, struct graph_t* graph, unsigned int num_
  */
 struct move_t play(struct move_t previous_move);
 
+/* Gives the time left to the player, called before each call to play
+ * OPTIONAL: the server only calls it if the player defines it
+ * PARAM:
+ * - move_time: the number of seconds left to compute the coming move,
+ *              negative if the moves are not timed
+ * - game_time: the number of seconds left on the clock of the player
+ *              for the rest of the game, negative if the game is not timed
+ */
+void set_remaining_time(double move_time, double game_time);
+
+/* Gives the evaluation of the last move of the player
+ * OPTIONAL: the server only calls it if the player defines it, right
+ *           after each call to `play`
+ * RETURNS: the value of the position reached by the move returned by
+ *          `play`, from the point of view of the player, the higher the
+ *          better, in the unit of the player's own evaluation
+ */
+double get_move_score();
+
+/* Thinks on the opponent's time
+ * OPTIONAL: the server only calls it if the player defines both `ponder`
+ *           and `ponderhit`, and if it was asked to let the players ponder
+ * PARAM:
+ * - my_last_move: the move the player just returned from `play`
+ * Called on a thread of its own after each call to `play`, while the
+ * opponent is playing. It must return soon after `ponderhit` is called,
+ * and it is always stopped before the next call to `set_remaining_time`,
+ * `play` or `finalize`.
+ */
+void ponder(struct move_t my_last_move);
+
+/* Stops pondering, called from the server thread while `ponder` runs
+ * PARAM:
+ * - opponent_move: the move the opponent played, or { UINT_MAX, UINT_MAX,
+ *                  UINT_MAX } if the game ended
+ * The time `ponder` takes to return once asked counts in the time spent
+ * on the next move.
+ */
+void ponderhit(struct move_t opponent_move);
+
 /* Announces the end of the game to the player, and cleans up the
    memory he may have been using.
  * POSTCOND:
@@ -1,8 +1,10 @@
 #include <stdlib.h>
+#include <string.h>
 
 #include "player.h"
 #include "queens.h"
 #include "utils.h"
+#include "zobrist.h"
 
 // Converts 2D coordinates to a 1D index using row-major order
 static inline uint pos_to_idx(uint size, uint x, uint y) {
@@ -27,9 +29,16 @@ struct queens_t* queens__new() {
     struct queens_t* queens_new = malloc(sizeof(struct queens_t));
     if (!queens_new)
         handle_error(__func__, "Not enough memory for 'queens_new'", PROGRAM_EXIT);
+    queens_new->num_vertices = 0;
+    queens_new->owner = NULL;
+    queens_new->slot = NULL;
     return queens_new;
 }
 
+uint queens__default_count(uint size) {
+    return 4 * (size / 10 + 1);
+}
+
 void queens__alloc(struct queens_t* queens, uint nb_queens) {
     queens->nb_queens = nb_queens;
     for (uint player_id = 0; player_id < NUM_PLAYERS; player_id++) {
@@ -47,6 +56,37 @@ void queens__copy(struct queens_t* queens_src, struct queens_t* queens_dst) {
             queens_dst->array[player_id][queen_id] = queens_src->array[player_id][queen_id];
         }
     }
+    queens_dst->key = queens_src->key;
+    if (queens_src->owner)
+        queens__build_index(queens_dst, queens_src->num_vertices);
+}
+
+void queens__build_index(struct queens_t* queens, uint num_vertices) {
+    queens__free_index(queens);
+    queens->num_vertices = num_vertices;
+    queens->owner = malloc(num_vertices * sizeof(unsigned char));
+    queens->slot = malloc(num_vertices * sizeof(uint));
+    if (!queens->owner || !queens->slot)
+        handle_error(__func__, "Not enough memory for the index", PROGRAM_EXIT);
+
+    memset(queens->owner, QUEENS__NO_OWNER, num_vertices * sizeof(unsigned char));
+    for (uint player_id = 0; player_id < NUM_PLAYERS; player_id++) {
+        for (uint queen_id = 0; queen_id < queens__get_nb_queens(queens); queen_id++) {
+            uint pos = queens->array[player_id][queen_id];
+            if (pos < num_vertices) {
+                queens->owner[pos] = player_id;
+                queens->slot[pos] = queen_id;
+            }
+        }
+    }
+}
+
+void queens__free_index(struct queens_t* queens) {
+    free(queens->owner);
+    free(queens->slot);
+    queens->owner = NULL;
+    queens->slot = NULL;
+    queens->num_vertices = 0;
 }
 
 void queens__init(struct queens_t* queens, uint size) {
@@ -60,26 +100,60 @@ void queens__init(struct queens_t* queens, uint size) {
     }
 
     place_other_player_queens(queens, size);
+    queens__rehash(queens);
+    queens__build_index(queens, size * size);
+}
+
+void queens__rehash(struct queens_t* queens) {
+    queens->key = 0;
+    for (uint player_id = 0; player_id < NUM_PLAYERS; player_id++)
+        for (uint queen_id = 0; queen_id < queens__get_nb_queens(queens); queen_id++)
+            queens->key ^= zobrist__queen(player_id, queens->array[player_id][queen_id]);
+}
+
+void queens__set(struct queens_t* queens, uint player_id, uint queen_id, uint pos) {
+    uint old_pos = queens->array[player_id][queen_id];
+    queens->key ^= zobrist__queen(player_id, old_pos) ^ zobrist__queen(player_id, pos);
+    queens->array[player_id][queen_id] = pos;
+
+    if (queens->owner) {
+        if (old_pos < queens->num_vertices)
+            queens->owner[old_pos] = QUEENS__NO_OWNER;
+        if (pos < queens->num_vertices) {
+            queens->owner[pos] = player_id;
+            queens->slot[pos] = queen_id;
+        }
+    }
+}
+
+uint queens__get_queen_id(struct queens_t* queens, uint player_id, uint pos) {
+    if (queens->owner) {
+        if (pos < queens->num_vertices && queens->owner[pos] == player_id)
+            return queens->slot[pos];
+        return QUEENS__NO_QUEEN;
+    }
+    for (uint queen_id = 0; queen_id < queens->nb_queens; queen_id++)
+        if (queens->array[player_id][queen_id] == pos)
+            return queen_id;
+    return QUEENS__NO_QUEEN;
 }
 
 void queens__free(struct queens_t* queens) {
     // Frees each array of queen positions for each player
     for (uint player_id = 0; player_id < NUM_PLAYERS; player_id++)
         free(queens->array[player_id]);
+    queens__free_index(queens);
     // Frees the overall struct
     free(queens);
 }
 
 int queens__queen_exist_for_player(struct queens_t* queens, uint player_id, uint idx) {
-    for (uint id_queen = 0; id_queen < queens->nb_queens; id_queen++) {
-        if (queens->array[player_id][id_queen] == idx) {
-            return 1;
-        }
-    }
-    return 0;
+    return queens__get_queen_id(queens, player_id, idx) != QUEENS__NO_QUEEN;
 }
 
 int queens__exist_queens(struct queens_t* queens, uint idx) {
+    if (queens->owner)
+        return idx < queens->num_vertices && queens->owner[idx] != QUEENS__NO_OWNER;
     for (uint player_id = 0; player_id < NUM_PLAYERS; player_id++) {
         if (queens__queen_exist_for_player(queens, player_id, idx)) {
             return 1;
@@ -6,8 +6,14 @@
 #ifndef __QUEENS_H__
 #define __QUEENS_H__
 
+#include <limits.h>
+#include <stdint.h>
+
 #include "utils.h"
 
+#define QUEENS__NO_OWNER UCHAR_MAX
+#define QUEENS__NO_QUEEN UINT_MAX
+
 /**
  * @struct queens_t
  * @brief A structure to hold the queen pieces of the game.
@@ -18,6 +24,10 @@
 struct queens_t {
     uint nb_queens; /* The number of queens per player */
     uint* array[2]; /** Array of arrays of uints to store the positions of each player's queens */
+    uint64_t key; /** Zobrist key of the queens of both players (see zobrist.h) */
+    uint num_vertices; /** Number of vertices covered by the index, 0 if there is no index */
+    unsigned char* owner; /** Index of size num_vertices: owner[pos] is the player owning the queen on pos, QUEENS__NO_OWNER if none */
+    uint* slot; /** Index of size num_vertices: slot[pos] is the index of the queen on pos in the array of its owner */
 };
 
 /**
@@ -43,6 +53,14 @@ uint** queens__get_array(struct queens_t* queens);
  */
 struct queens_t* queens__new();
 
+/**
+ * @brief Get the number of queens each player starts with on a board of a given size.
+ *
+ * @param size The size of the game board.
+ * @return The number of queens of each player.
+ */
+uint queens__default_count(uint size);
+
 /**
  * @brief Allocate memory for the queen pieces of a queens_t structure.
  *
@@ -51,13 +69,41 @@ struct queens_t* queens__new();
 void queens__alloc(struct queens_t* queens, uint nb_queens);
 
 /**
- * @brief Initialize the queen pieces of a queens_t structure.
+ * @brief Initialize the queen pieces of a queens_t structure and build their index.
  *
  * @param queens The queens_t structure to initialize.
  * @param size The size of the game board.
  */
 void queens__init(struct queens_t* queens, uint size);
 
+/**
+ * @brief Build the index of the vertices occupied by the queen pieces of a queens_t structure.
+ *
+ * Once built, the index is kept up to date by queens__set, and occupancy tests take constant time.
+ * It must be called after the arrays of positions are filled by hand.
+ *
+ * @param queens The queens_t structure to index.
+ * @param num_vertices The number of vertices of the board.
+ */
+void queens__build_index(struct queens_t* queens, uint num_vertices);
+
+/**
+ * @brief Free the index of the vertices occupied by the queen pieces of a queens_t structure.
+ *
+ * @param queens The queens_t structure.
+ */
+void queens__free_index(struct queens_t* queens);
+
+/**
+ * @brief Get the index of the queen piece of a player on a vertex.
+ *
+ * @param queens The queens_t structure containing the queen pieces.
+ * @param player_id The ID of the player owning the queen piece.
+ * @param pos The vertex.
+ * @return The index of the queen piece in the array of the player, QUEENS__NO_QUEEN if there is none.
+ */
+uint queens__get_queen_id(struct queens_t* queens, uint player_id, uint pos);
+
 /**
  * @brief Copy the queen pieces of a queens_t structure to another array of arrays of uints.
  *
@@ -66,6 +112,25 @@ void queens__init(struct queens_t* queens, uint size);
  */
 void queens__copy(struct queens_t* queens_src, struct queens_t* queens_dst);
 
+/**
+ * @brief Recompute from scratch the Zobrist key of the queen pieces of a queens_t structure.
+ *
+ * It must be called after the arrays of positions are filled by hand.
+ *
+ * @param queens The queens_t structure to hash.
+ */
+void queens__rehash(struct queens_t* queens);
+
+/**
+ * @brief Place a queen piece on a vertex, keeping the Zobrist key up to date.
+ *
+ * @param queens The queens_t structure containing the queen pieces.
+ * @param player_id The ID of the player owning the queen piece.
+ * @param queen_id The index of the queen piece in the array of the player.
+ * @param pos The vertex to place the queen piece on.
+ */
+void queens__set(struct queens_t* queens, uint player_id, uint queen_id, uint pos);
+
 /**
  * @brief Free the memory allocated for the queen pieces of a queens_t structure.
  *
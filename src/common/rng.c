@@ -0,0 +1,47 @@
+#include "rng.h"
+
+static uint64_t splitmix64(uint64_t* x) {
+    uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static uint64_t rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+void rng__seed(struct rng_t* rng, uint64_t seed) {
+    if (!rng) handle_error(__func__, "Invalid parameter 'rng'", PROGRAM_EXIT);
+    // splitmix64 never gives four zeros in a row
+    for (uint i = 0; i < 4; i++)
+        rng->state[i] = splitmix64(&seed);
+}
+
+uint64_t rng__next(struct rng_t* rng) {
+    uint64_t* s = rng->state;
+    uint64_t result = rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return result;
+}
+
+uint rng__below(struct rng_t* rng, uint bound) {
+    // Lemire's multiply and shift, the few low products that would favor some numbers being drawn again
+    uint64_t product = (rng__next(rng) >> 32) * bound;
+    uint32_t low = (uint32_t)product;
+    if (low < bound) {
+        uint32_t threshold = -bound % bound;
+        while (low < threshold) {
+            product = (rng__next(rng) >> 32) * bound;
+            low = (uint32_t)product;
+        }
+    }
+    return product >> 32;
+}
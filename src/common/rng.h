@@ -0,0 +1,47 @@
+/**
+ * @file rng.h
+ * @brief This file contains the pseudo-random generator owned by each game and each player.
+ *
+ * The generator is xoshiro256**, its state being filled from the seed with splitmix64. Unlike rand, its state
+ * is held by its owner, so the draws of a game only depend on its seed, whatever the other games running in the
+ * same process do, and no lock is taken.
+ */
+
+#ifndef _AMAZON_RNG_H_
+#define _AMAZON_RNG_H_
+
+#include <stdint.h>
+
+#include "utils.h"
+
+/**
+ * @struct rng_t
+ * @brief The state of a generator, never all zero.
+ */
+struct rng_t {
+    uint64_t state[4];
+};
+
+/**
+ * @brief Initializes a generator.
+ * @param rng The generator.
+ * @param seed Any seed, the same seed giving the same draws.
+ */
+void rng__seed(struct rng_t* rng, uint64_t seed);
+
+/**
+ * @brief Draws 64 random bits.
+ * @param rng The generator.
+ * @return The next number of the generator.
+ */
+uint64_t rng__next(struct rng_t* rng);
+
+/**
+ * @brief Draws a number below a bound, each number being equally likely.
+ * @param rng The generator.
+ * @param bound The number of possible draws, not 0.
+ * @return A number between 0 and bound - 1.
+ */
+uint rng__below(struct rng_t* rng, uint bound);
+
+#endif // _AMAZON_RNG_H_
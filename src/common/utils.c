@@ -1,5 +1,8 @@
+#define _POSIX_C_SOURCE 199309L
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
 
 #include "utils.h"
 
@@ -7,4 +10,23 @@ void handle_error(const char* func, char* error_msg, int quit) {
     fprintf(stderr, "[Error][%s] %s\n", func, error_msg);
     if (quit)
         exit(EXIT_FAILURE);
-}
\ No newline at end of file
+}
+
+double get_monotonic_time() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void print_json_string(FILE* file, const char* string) {
+    fputc('"', file);
+    for (const unsigned char* c = (const unsigned char*)string; *c; c++) {
+        if (*c == '"' || *c == '\\')
+            fprintf(file, "\\%c", *c);
+        else if (*c < 0x20)
+            fprintf(file, "\\u%04x", *c);
+        else
+            fputc(*c, file);
+    }
+    fputc('"', file);
+}
@@ -7,6 +7,7 @@
 #define __UTILS_H__
 
 #include <assert.h>
+#include <stdio.h>
 
 #define PROGRAM_CONTINUE 0
 #define PROGRAM_EXIT 1
@@ -25,4 +26,18 @@ typedef unsigned int uint;
  */
 void handle_error(const char* func, char* error_msg, int quit);
 
+/**
+ * @brief Get the time elapsed since an arbitrary point, which is not affected by changes of the system clock.
+ * @return A time in seconds, only meaningful when compared to another call.
+ */
+double get_monotonic_time();
+
+/**
+ * @brief Print a string as a JSON string, quoted and escaped.
+ *
+ * @param file The file to print to.
+ * @param string The string to print.
+ */
+void print_json_string(FILE* file, const char* string);
+
 #endif // __UTILS_H__
\ No newline at end of file
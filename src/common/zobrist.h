@@ -0,0 +1,64 @@
+/**
+ * @file zobrist.h
+ * @brief This file contains the Zobrist keys used to hash the positions of the game.
+ *
+ * The key of a position is the XOR of the keys of its blocked vertices, of the keys
+ * of the vertices of the queens of each player, and of zobrist__side() when the
+ * second player is to move. Each key is derived from its vertex with the splitmix64
+ * finalizer, so no table has to be allocated or shared, and keys are the same in
+ * every process.
+ */
+
+#ifndef _AMAZON_ZOBRIST_H_
+#define _AMAZON_ZOBRIST_H_
+
+#include <stdint.h>
+
+#include "utils.h"
+
+enum zobrist_piece {
+    ZOBRIST_BLOCKED = 0,
+    ZOBRIST_QUEEN_P1 = 1,
+    ZOBRIST_QUEEN_P2 = 2,
+    ZOBRIST_NUM_PIECES = 3
+};
+
+// splitmix64 finalizer, a bijection of 64-bit integers with good avalanche
+static inline uint64_t zobrist__mix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+/**
+ * @brief Get the key of a blocked vertex (hole, arrow or vertex without any edge left).
+ *
+ * @param pos The vertex.
+ * @return The key of the vertex.
+ */
+static inline uint64_t zobrist__blocked(uint pos) {
+    return zobrist__mix((uint64_t)pos * ZOBRIST_NUM_PIECES + ZOBRIST_BLOCKED);
+}
+
+/**
+ * @brief Get the key of a queen on a vertex.
+ *
+ * @param player_id The player owning the queen.
+ * @param pos The vertex of the queen.
+ * @return The key of the queen.
+ */
+static inline uint64_t zobrist__queen(uint player_id, uint pos) {
+    return zobrist__mix((uint64_t)pos * ZOBRIST_NUM_PIECES + ZOBRIST_QUEEN_P1 + player_id);
+}
+
+/**
+ * @brief Get the key XORed in when the second player is to move.
+ *
+ * @return The key of the side to move.
+ */
+static inline uint64_t zobrist__side() {
+    return zobrist__mix(UINT64_MAX);
+}
+
+#endif // _AMAZON_ZOBRIST_H_
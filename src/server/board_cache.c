@@ -0,0 +1,186 @@
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "board_cache.h"
+
+#define BOARD_CACHE__VERSION 1
+
+static const char snapshot_magic[4] = {'A', 'M', 'Z', 'G'};
+
+// The header of a snapshot, followed by the image of the graph
+struct snapshot_header {
+    char magic[4];
+    uint32_t version;
+    uint32_t board_shape;
+    uint32_t size;
+    uint64_t image_size;
+};
+
+struct cache_entry {
+    char board_shape;
+    uint size;
+    void* image;
+    size_t image_size;
+    void* map; // The mapping of the snapshot holding the image, NULL if the image was allocated
+    size_t map_size;
+};
+
+static struct cache_entry* entries = NULL;
+static uint nb_entries = 0;
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER; // Protects entries, the games of a tournament sharing them
+
+static char* snapshot_path_of(const char* directory, char board_shape, uint size) {
+    size_t length = strlen(directory) + 32;
+    char* path = malloc(length);
+    if (!path)
+        handle_error(__func__, "Not enough memory for 'path'", PROGRAM_EXIT);
+    snprintf(path, length, "%s/%c-%u%s", directory, board_shape, size, BOARD_CACHE__SUFFIX);
+    return path;
+}
+
+// Maps the image of a snapshot, 0 if the file is missing or is not a snapshot of that board
+static int load_snapshot(struct cache_entry* entry, const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return 0;
+    struct stat st;
+    if (fstat(fd, &st) || (size_t)st.st_size < sizeof(struct snapshot_header)) {
+        close(fd);
+        return 0;
+    }
+    void* map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return 0;
+
+    const struct snapshot_header* header = map;
+    if (memcmp(header->magic, snapshot_magic, sizeof(snapshot_magic)) || header->version != BOARD_CACHE__VERSION ||
+        header->board_shape != (uint32_t)entry->board_shape || header->size != entry->size ||
+        header->image_size != st.st_size - sizeof(struct snapshot_header)) {
+        munmap(map, st.st_size);
+        return 0;
+    }
+
+    // The image is checked once, the graphs being copied from it afterwards
+    if (graph__check_image(header + 1, header->image_size) != entry->size * entry->size) {
+        munmap(map, st.st_size);
+        return 0;
+    }
+
+    entry->map = map;
+    entry->map_size = st.st_size;
+    entry->image = (struct snapshot_header*)map + 1;
+    entry->image_size = header->image_size;
+    return 1;
+}
+
+// Writes a snapshot under a temporary name first, so that other processes never read a partial one
+static void write_snapshot(const struct cache_entry* entry, const char* path) {
+    size_t length = strlen(path) + 32;
+    char* tmp_path = malloc(length);
+    if (!tmp_path)
+        handle_error(__func__, "Not enough memory for 'tmp_path'", PROGRAM_EXIT);
+    snprintf(tmp_path, length, "%s.%ld", path, (long)getpid());
+
+    struct snapshot_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, snapshot_magic, sizeof(snapshot_magic));
+    header.version = BOARD_CACHE__VERSION;
+    header.board_shape = entry->board_shape;
+    header.size = entry->size;
+    header.image_size = entry->image_size;
+
+    FILE* file = fopen(tmp_path, "wb");
+    int error = !file;
+    if (file) {
+        error |= fwrite(&header, sizeof(header), 1, file) != 1;
+        error |= fwrite(entry->image, entry->image_size, 1, file) != 1;
+        error |= fclose(file) != 0;
+    }
+    if (!error)
+        error = rename(tmp_path, path) != 0;
+    if (error) {
+        handle_error(__func__, "Could not write the board snapshot", PROGRAM_CONTINUE);
+        remove(tmp_path);
+    }
+    free(tmp_path);
+}
+
+static void build_image(struct cache_entry* entry, struct shape_t* shape) {
+    struct graph_t* board = graph__new();
+    shape__build_graph(shape, board);
+
+    entry->image_size = graph__image_size(board);
+    entry->image = malloc(entry->image_size);
+    if (!entry->image)
+        handle_error(__func__, "Not enough memory for 'image'", PROGRAM_EXIT);
+    graph__write_image(board, entry->image);
+    entry->map = NULL;
+    graph__free(board);
+}
+
+// Returns the entry of a board, read from its snapshot or built if it is not in the cache yet
+static struct cache_entry* find_entry(struct shape_t* shape, const char* directory) {
+    char board_shape = shape__get_board_shape(shape);
+    uint size = shape__get_size(shape);
+    for (uint entry_id = 0; entry_id < nb_entries; entry_id++)
+        if (entries[entry_id].board_shape == board_shape && entries[entry_id].size == size)
+            return &entries[entry_id];
+
+    entries = realloc(entries, (nb_entries + 1) * sizeof(struct cache_entry));
+    if (!entries)
+        handle_error(__func__, "Not enough memory for 'entries'", PROGRAM_EXIT);
+    struct cache_entry* entry = &entries[nb_entries++];
+    entry->board_shape = board_shape;
+    entry->size = size;
+
+    char* path = directory ? snapshot_path_of(directory, board_shape, size) : NULL;
+    if (!path || !load_snapshot(entry, path)) {
+        build_image(entry, shape);
+        if (path)
+            write_snapshot(entry, path);
+    }
+    free(path);
+    return entry;
+}
+
+/* **************************************************************** */
+
+void board_cache__init_graph(struct shape_t* shape, struct graph_t* board, const char* directory) {
+    if (!shape) handle_error(__func__, "Invalid parameter 'shape'", PROGRAM_EXIT);
+    if (!board) handle_error(__func__, "Invalid parameter 'board'", PROGRAM_EXIT);
+
+    // A board file may change between two games, and is built in a single pass anyway
+    if (shape__get_board_shape(shape) == SHAPE_MASK) {
+        shape__build_graph(shape, board);
+        return;
+    }
+
+    pthread_mutex_lock(&cache_lock);
+    const void* image = find_entry(shape, directory)->image; // The entries may move, but not their images
+    pthread_mutex_unlock(&cache_lock);
+
+    // The images are built here or checked when their snapshot is read, and never change until the cache is cleared
+    graph__copy_image(board, image);
+}
+
+void board_cache__clear() {
+    pthread_mutex_lock(&cache_lock);
+    for (uint entry_id = 0; entry_id < nb_entries; entry_id++) {
+        if (entries[entry_id].map)
+            munmap(entries[entry_id].map, entries[entry_id].map_size);
+        else
+            free(entries[entry_id].image);
+    }
+    free(entries);
+    entries = NULL;
+    nb_entries = 0;
+    pthread_mutex_unlock(&cache_lock);
+}
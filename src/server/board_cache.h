@@ -0,0 +1,36 @@
+/**
+ * @file board_cache.h
+ * @brief This file contains the cache of the boards built for each shape and size.
+ *
+ * Building the graph of a board sets each of its edges in a triplet matrix before compressing it, which shows for
+ * large boards when many games are played. The first board of a shape and size is kept as a graph image (see
+ * graph__write_image), from which the next ones are copied. The images may also be kept in a directory, as snapshot
+ * files read by the next processes, named after the shape and the size of the board with the suffix
+ * BOARD_CACHE__SUFFIX. A snapshot which cannot be read is built and written again. The boards read from a file
+ * (SHAPE_MASK) are not cached.
+ */
+
+#ifndef __BOARD_CACHE_H__
+#define __BOARD_CACHE_H__
+
+#include "graph.h"
+#include "shape.h"
+#include "utils.h"
+
+#define BOARD_CACHE__SUFFIX ".board"
+
+/**
+ * @brief Initializes and compresses the graph of a shape, as shape__init_graph and graph__compress would.
+ *
+ * @param shape The shape of the board.
+ * @param board The graph to initialize.
+ * @param directory The directory of the snapshots, NULL to keep the boards in memory only.
+ */
+void board_cache__init_graph(struct shape_t* shape, struct graph_t* board, const char* directory);
+
+/**
+ * @brief Forgets every board of the cache, the snapshots being kept.
+ */
+void board_cache__clear();
+
+#endif // __BOARD_CACHE_H__
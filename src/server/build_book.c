@@ -0,0 +1,393 @@
+#include <float.h>
+#include <getopt.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "book.h"
+#include "graph.h"
+#include "move.h"
+#include "movegen.h"
+#include "player.h"
+#include "queens.h"
+#include "shape.h"
+#include "utils.h"
+
+#define BUILD_BOOK__DEFAULT_PLIES 3
+#define BUILD_BOOK__DEFAULT_DEPTH 2
+#define BUILD_BOOK__DEFAULT_KEPT 3
+#define BUILD_BOOK__DEFAULT_PATH "book.bin"
+#define BUILD_BOOK__MAX_PLIES 16
+#define BUILD_BOOK__CANDIDATES 4 // Moves searched at full depth per kept move, the best ones at depth 1
+#define BUILD_BOOK__LOSS (-1e9)
+
+// A position of the book, given by the moves leading to it from the initial position
+struct line_t {
+    uint starting_player;
+    uint nb_moves;
+    struct move_t moves[BUILD_BOOK__MAX_PLIES];
+    uint64_t key;
+};
+
+// The moves generated at each ply, grown on demand
+struct move_buffer {
+    struct move_t* moves;
+    size_t cap;
+};
+
+struct scored_move {
+    struct move_t move;
+    double score;
+};
+
+// The positions of a ply searched by the workers, and the entries they found
+struct builder_t {
+    struct graph_t* board;
+    struct queens_t* queens;
+    struct line_t* lines;
+    size_t nb_lines;
+    size_t next_line; // The next line to search by the workers
+    struct scored_move* results; // kept moves per line, the missing ones with a NAN score
+    pthread_mutex_t lock; // Protects next_line
+};
+
+static uint size = SHAPE__DEFAULT_SIZE;
+static char board_shape = SHAPE__DEFAULT_SHAPE;
+static uint nb_plies = BUILD_BOOK__DEFAULT_PLIES;
+static uint depth = BUILD_BOOK__DEFAULT_DEPTH;
+static uint kept = BUILD_BOOK__DEFAULT_KEPT;
+static uint nb_workers = 0;
+static const char* path = BUILD_BOOK__DEFAULT_PATH;
+
+static void usage(const char* command) {
+    printf("Usage: %s [-m size] [-t shape] [-p plies] [-d depth] [-k moves] [-j workers] [-o file]\n", command);
+    printf("Options:\n");
+    printf("\t-m : set the game board size (minimum: %d) [default: %d]\n", 5, SHAPE__DEFAULT_SIZE);
+    printf("\t-t : set the game board shape (c: square, 8: eight, t: clover, d: donut) [default: c]\n");
+    printf("\t-p : set the number of plies covered from the initial position (maximum: %d) [default: %d]\n", BUILD_BOOK__MAX_PLIES,
+           BUILD_BOOK__DEFAULT_PLIES);
+    printf("\t-d : set the depth of the search of each position [default: %d]\n", BUILD_BOOK__DEFAULT_DEPTH);
+    printf("\t-k : set the number of moves kept per position, the next plies following each of them [default: %d]\n",
+           BUILD_BOOK__DEFAULT_KEPT);
+    printf("\t-j : set the number of threads searching positions, 0 for one per core [default: 0]\n");
+    printf("\t-o : set the path of the book [default: %s]\n", BUILD_BOOK__DEFAULT_PATH);
+}
+
+static int parse_int_arg(const char* arg) {
+    char* end_ptr;
+    long value = strtol(arg, &end_ptr, 10);
+
+    if (*arg == '\0' || *end_ptr != '\0' || value < 0) {
+        handle_error(__func__, "Invalid argument", PROGRAM_EXIT);
+    }
+
+    return (int)value;
+}
+
+static void handle_args(int argc, char* argv[]) {
+    int opt;
+
+    while ((opt = getopt(argc, argv, "m:t:p:d:k:j:o:")) != -1) {
+        switch (opt) {
+            case 'm':
+                size = parse_int_arg(optarg);
+                break;
+            case 't':
+                board_shape = optarg[0];
+                break;
+            case 'p':
+                nb_plies = parse_int_arg(optarg);
+                if (nb_plies > BUILD_BOOK__MAX_PLIES)
+                    handle_error(__func__, "Too many plies", PROGRAM_EXIT);
+                break;
+            case 'd':
+                depth = parse_int_arg(optarg);
+                if (!depth)
+                    handle_error(__func__, "The depth must be at least 1", PROGRAM_EXIT);
+                break;
+            case 'k':
+                kept = parse_int_arg(optarg);
+                if (!kept)
+                    handle_error(__func__, "At least one move must be kept", PROGRAM_EXIT);
+                break;
+            case 'j':
+                nb_workers = parse_int_arg(optarg);
+                break;
+            case 'o':
+                path = optarg;
+                break;
+            default:
+                usage(argv[0]);
+                exit(EXIT_FAILURE);
+        }
+    }
+
+    if (optind != argc) {
+        usage(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+}
+
+static size_t generate(struct graph_t* board, struct queens_t* queens, uint player_id, struct move_buffer* buffer) {
+    size_t count = movegen__generate(board, queens, player_id, buffer->moves, buffer->cap);
+    if (count > buffer->cap) {
+        buffer->moves = realloc(buffer->moves, count * sizeof(struct move_t));
+        if (!buffer->moves)
+            handle_error(__func__, "Not enough memory for 'moves'", PROGRAM_EXIT);
+        buffer->cap = count;
+        movegen__generate(board, queens, player_id, buffer->moves, buffer->cap);
+    }
+    return count;
+}
+
+// The mobility of the player to move minus that of its opponent
+static double evaluate(struct graph_t* board, struct queens_t* queens, uint player_id) {
+    return (double)movegen__count(board, queens, player_id) - (double)movegen__count(board, queens, player_id ^ 1);
+}
+
+// Negamax with alpha-beta pruning, from the point of view of the player to move
+static double search(struct graph_t* board, struct queens_t* queens, uint player_id, uint remaining, double alpha, double beta,
+                     struct move_buffer* buffers) {
+    if (remaining == 0)
+        return evaluate(board, queens, player_id);
+
+    size_t count = generate(board, queens, player_id, &buffers[remaining]);
+    if (count == 0)
+        return BUILD_BOOK__LOSS;
+
+    double best = -DBL_MAX;
+    struct move_undo_t undo;
+    for (size_t i = 0; i < count && best < beta; i++) {
+        move__make(board, queens, player_id, buffers[remaining].moves[i], &undo);
+        double value = -search(board, queens, player_id ^ 1, remaining - 1, -beta, -(alpha > best ? alpha : best), buffers);
+        move__unmake(board, queens, &undo);
+        if (value > best)
+            best = value;
+    }
+    return best;
+}
+
+static int compare_scored_moves(const void* a, const void* b) {
+    double score_a = ((const struct scored_move*)a)->score;
+    double score_b = ((const struct scored_move*)b)->score;
+    return (score_a < score_b) - (score_a > score_b);
+}
+
+// Scores every move at depth 1, then searches the best ones at full depth and keeps the best of those
+static void search_root(struct graph_t* board, struct queens_t* queens, uint player_id, struct scored_move* out, struct move_buffer* buffers) {
+    size_t count = generate(board, queens, player_id, &buffers[depth + 1]);
+    struct scored_move* moves = malloc((count ? count : 1) * sizeof(struct scored_move));
+    if (!moves)
+        handle_error(__func__, "Not enough memory for 'moves'", PROGRAM_EXIT);
+
+    struct move_undo_t undo;
+    for (size_t i = 0; i < count; i++) {
+        moves[i].move = buffers[depth + 1].moves[i];
+        move__make(board, queens, player_id, moves[i].move, &undo);
+        moves[i].score = -evaluate(board, queens, player_id ^ 1);
+        move__unmake(board, queens, &undo);
+    }
+    qsort(moves, count, sizeof(struct scored_move), compare_scored_moves);
+
+    if (depth > 1) {
+        size_t nb_candidates = (size_t)kept * BUILD_BOOK__CANDIDATES;
+        if (nb_candidates > count)
+            nb_candidates = count;
+        for (size_t i = 0; i < nb_candidates; i++) {
+            move__make(board, queens, player_id, moves[i].move, &undo);
+            moves[i].score = -search(board, queens, player_id ^ 1, depth - 1, -DBL_MAX, DBL_MAX, buffers);
+            move__unmake(board, queens, &undo);
+        }
+        qsort(moves, nb_candidates, sizeof(struct scored_move), compare_scored_moves);
+    }
+
+    for (uint i = 0; i < kept; i++)
+        out[i] = i < count ? moves[i] : (struct scored_move){create_initial_move(), NAN};
+    free(moves);
+}
+
+// Searches the lines not taken yet by the other workers, on a private copy of the board
+static void* search_lines(void* arg) {
+    struct builder_t* builder = arg;
+    struct graph_t* board = graph__copy(builder->board);
+    struct queens_t* queens = queens__new();
+    queens__copy(builder->queens, queens);
+    queens__build_index(queens, board->num_vertices);
+    struct move_buffer* buffers = calloc(depth + 2, sizeof(struct move_buffer));
+    if (!buffers)
+        handle_error(__func__, "Not enough memory for 'buffers'", PROGRAM_EXIT);
+
+    while (1) {
+        pthread_mutex_lock(&builder->lock);
+        size_t line_id = builder->next_line++;
+        pthread_mutex_unlock(&builder->lock);
+        if (line_id >= builder->nb_lines)
+            break;
+
+        struct line_t* line = &builder->lines[line_id];
+        struct move_undo_t undo[BUILD_BOOK__MAX_PLIES];
+        uint player_id = line->starting_player;
+        for (uint i = 0; i < line->nb_moves; i++, player_id ^= 1)
+            move__make(board, queens, player_id, line->moves[i], &undo[i]);
+        search_root(board, queens, player_id, &builder->results[line_id * kept], buffers);
+        for (uint i = line->nb_moves; i > 0; i--)
+            move__unmake(board, queens, &undo[i - 1]);
+    }
+
+    for (uint i = 0; i < depth + 2; i++)
+        free(buffers[i].moves);
+    free(buffers);
+    queens__free(queens);
+    graph__free(board);
+    return NULL;
+}
+
+static void search_ply(struct builder_t* builder) {
+    uint nb_threads = nb_workers;
+    if (nb_threads == 0) {
+        long nb_cores = sysconf(_SC_NPROCESSORS_ONLN);
+        nb_threads = nb_cores > 0 ? (uint)nb_cores : 1;
+    }
+    if (nb_threads > builder->nb_lines)
+        nb_threads = builder->nb_lines;
+
+    builder->next_line = 0;
+    pthread_t* workers = malloc((nb_threads ? nb_threads : 1) * sizeof(pthread_t));
+    if (!workers)
+        handle_error(__func__, "Not enough memory for 'workers'", PROGRAM_EXIT);
+
+    // The calling thread is a worker too, so the lines are searched even if no thread could be created
+    uint nb_created = 0;
+    for (uint i = 1; i < nb_threads; i++) {
+        if (pthread_create(&workers[nb_created], NULL, search_lines, builder) == 0)
+            nb_created++;
+    }
+    search_lines(builder);
+    for (uint i = 0; i < nb_created; i++)
+        pthread_join(workers[i], NULL);
+    free(workers);
+}
+
+// The key of the position at the end of a line
+static uint64_t line_key(struct graph_t* board, struct queens_t* queens, struct line_t* line) {
+    struct move_undo_t undo[BUILD_BOOK__MAX_PLIES];
+    uint player_id = line->starting_player;
+    for (uint i = 0; i < line->nb_moves; i++, player_id ^= 1)
+        move__make(board, queens, player_id, line->moves[i], &undo[i]);
+    uint64_t key = book__key(board, queens, player_id, NULL);
+    for (uint i = line->nb_moves; i > 0; i--)
+        move__unmake(board, queens, &undo[i - 1]);
+    return key;
+}
+
+static int compare_lines(const void* a, const void* b) {
+    uint64_t key_a = ((const struct line_t*)a)->key;
+    uint64_t key_b = ((const struct line_t*)b)->key;
+    return (key_a > key_b) - (key_a < key_b);
+}
+
+// Keeps one line per position, the positions differing by a symmetry or the colors being the same
+static size_t remove_duplicates(struct line_t* lines, size_t nb_lines) {
+    qsort(lines, nb_lines, sizeof(struct line_t), compare_lines);
+    size_t nb_unique = 0;
+    for (size_t i = 0; i < nb_lines; i++)
+        if (nb_unique == 0 || lines[i].key != lines[nb_unique - 1].key)
+            lines[nb_unique++] = lines[i];
+    return nb_unique;
+}
+
+int main(int argc, char* argv[]) {
+    handle_args(argc, argv);
+
+    struct shape_t* shape = shape__new();
+    struct graph_t* board = graph__new();
+    struct queens_t* queens = queens__new();
+
+    shape__init(shape, size, board_shape);
+    shape__build_graph(shape, board);
+    queens__alloc(queens, queens__default_count(shape__get_size(shape)));
+    queens__init(queens, shape__get_size(shape));
+    queens__build_index(queens, board->num_vertices);
+
+    struct builder_t builder = {.board = board, .queens = queens};
+    pthread_mutex_init(&builder.lock, NULL);
+    builder.lines = malloc(NUM_PLAYERS * sizeof(struct line_t));
+    if (!builder.lines)
+        handle_error(__func__, "Not enough memory for 'lines'", PROGRAM_EXIT);
+    for (uint player_id = 0; player_id < NUM_PLAYERS; player_id++) {
+        builder.lines[player_id] = (struct line_t){.starting_player = player_id, .nb_moves = 0};
+        builder.lines[player_id].key = line_key(board, queens, &builder.lines[player_id]);
+    }
+    builder.nb_lines = remove_duplicates(builder.lines, NUM_PLAYERS);
+
+    struct book_entry* entries = NULL;
+    size_t nb_entries = 0;
+    uint nb_squares = shape__get_size(shape);
+    uint64_t board_key = book__board_key(board);
+    for (uint ply = 0; ply < nb_plies && builder.nb_lines; ply++) {
+        double start = get_monotonic_time();
+        builder.results = malloc(builder.nb_lines * kept * sizeof(struct scored_move));
+        entries = realloc(entries, (nb_entries + builder.nb_lines * kept) * sizeof(struct book_entry));
+        if (!builder.results || !entries)
+            handle_error(__func__, "Not enough memory for the results", PROGRAM_EXIT);
+        search_ply(&builder);
+
+        // The kept moves go to the book in the frame of the key, and lead to the positions of the next ply
+        struct line_t* next_lines = malloc((builder.nb_lines * kept + 1) * sizeof(struct line_t));
+        if (!next_lines)
+            handle_error(__func__, "Not enough memory for 'next_lines'", PROGRAM_EXIT);
+        size_t nb_next_lines = 0;
+        for (size_t line_id = 0; line_id < builder.nb_lines; line_id++) {
+            struct line_t* line = &builder.lines[line_id];
+            struct move_undo_t undo[BUILD_BOOK__MAX_PLIES];
+            uint player_id = line->starting_player;
+            for (uint i = 0; i < line->nb_moves; i++, player_id ^= 1)
+                move__make(board, queens, player_id, line->moves[i], &undo[i]);
+            uint symmetry;
+            book__key(board, queens, player_id, &symmetry);
+            for (uint i = line->nb_moves; i > 0; i--)
+                move__unmake(board, queens, &undo[i - 1]);
+
+            for (uint i = 0; i < kept; i++) {
+                struct scored_move* result = &builder.results[line_id * kept + i];
+                if (is_initial_move(result->move))
+                    continue;
+                struct move_t move = book__to_key_frame(result->move, nb_squares, symmetry);
+                struct book_entry* entry = &entries[nb_entries++];
+                memset(entry, 0, sizeof(*entry));
+                entry->key = line->key;
+                entry->move[0] = move.queen_src;
+                entry->move[1] = move.queen_dst;
+                entry->move[2] = move.arrow_dst;
+                entry->score = result->score;
+
+                struct line_t* next = &next_lines[nb_next_lines++];
+                *next = *line;
+                next->moves[next->nb_moves++] = result->move;
+                next->key = line_key(board, queens, next);
+            }
+        }
+        printf("ply %u: %zu positions searched in %.3f s\n", ply, builder.nb_lines, get_monotonic_time() - start);
+
+        free(builder.results);
+        free(builder.lines);
+        builder.lines = next_lines;
+        builder.nb_lines = remove_duplicates(next_lines, nb_next_lines);
+    }
+
+    int status = book__write(path, nb_squares, board_shape, board_key, depth, entries, nb_entries);
+    if (!status)
+        printf("%zu entries written to %s\n", nb_entries, path);
+
+    free(entries);
+    free(builder.lines);
+    pthread_mutex_destroy(&builder.lock);
+    queens__free(queens);
+    graph__free(board);
+    shape__delete(shape);
+
+    return status ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -1,18 +1,227 @@
+#define _GNU_SOURCE
+
 #include <dlfcn.h>
+#include <linux/futex.h>
+#include <math.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
 
 #include "client_api.h"
+#include "player.h"
 #include "utils.h"
 
+#define CHANNEL__POLL_TIME 10000000 // How often a waiting server checks that the client is alive, in nanoseconds
+#define CHANNEL__GRACE_TIME 0.1     // The time given to a client after its time limit before being killed, in seconds
+#define CHANNEL__FINALIZE_TIME 1.0  // The time given to a client to finalize
+
+// The requests forwarded to a client hosted in its own process
+enum channel_op {
+    CHANNEL_PLAY,
+    CHANNEL_FINALIZE,
+};
+
+// Shared between the server and the process hosting a client, the futex words counting the requests and the responses
+struct client_channel {
+    uint32_t request;  // Incremented by the server to post a request
+    uint32_t response; // Set to request by the client once it is done
+    int op;
+    struct move_t move; // The previous move for CHANNEL_PLAY, then the move played
+    int has_times;      // Whether move_time and game_time are to be given to the client before it plays
+    double move_time;
+    double game_time;
+    double score; // The evaluation of the move played
+};
+
 struct player {
     void* client_dl;
     char const* (*get_player_name)();
     void (*initialize)(uint, struct graph_t*, uint, uint**);
     struct move_t (*play)(struct move_t);
     void (*finalize)();
+    void (*set_remaining_time)(double, double); // Optional, NULL if the client does not define it
+    double (*get_move_score)(); // Optional, NULL if the client does not define it
+    void (*set_seed)(unsigned long long); // Optional, NULL if the client does not define it
+    void (*initialize_shared)(uint, const struct board_desc_t*); // Optional, NULL if the client does not define it
+    void (*ponder)(struct move_t);    // Optional, NULL unless the client defines both ponder and ponderhit
+    void (*ponderhit)(struct move_t);
+    int can_ponder;              // Whether the client may ponder, set by client__allow_ponder
+    int is_pondering;            // Whether ponder_thread is running
+    pthread_t ponder_thread;
+    struct move_t ponder_move;   // The move given to ponder
+    int has_times;               // Whether the time left is to be given to the client once it stopped pondering
+    double move_time;
+    double game_time;
+    double score;                // The evaluation of the last move given by the client, NAN if it gives none
+    struct client_channel* channel; // The channel to the process hosting the client in isolation mode, NULL otherwise
+    pid_t pid; // The process hosting the client, -1 if it is not running
+    size_t memory_limit; // The memory the process hosting the client may allocate, 0 for no limit
+    double init_time; // The time the client may spend on its initialization, 0 for no limit
+    double time_limit; // The time the client may spend on its next move, 0 for no limit
+    int has_failed; // Set when the process hosting the client crashed, ran out of time or of memory
 };
 
+static void* run_ponder(void* arg) {
+    struct player* p = arg;
+    p->ponder(p->ponder_move);
+    return NULL;
+}
+
+// Lets the client think on a thread of its own after playing my_last_move, if it can
+static void start_pondering(struct player* p, struct move_t my_last_move) {
+    if (!p->can_ponder || !p->ponder)
+        return;
+    p->ponder_move = my_last_move;
+    p->is_pondering = !pthread_create(&p->ponder_thread, NULL, run_ponder, p);
+}
+
+static void stop_pondering(struct player* p, struct move_t opponent_move) {
+    if (!p->is_pondering)
+        return;
+    p->ponderhit(opponent_move);
+    pthread_join(p->ponder_thread, NULL);
+    p->is_pondering = 0;
+}
+
+static long futex(uint32_t* word, int op, uint32_t value, const struct timespec* timeout) {
+    return syscall(SYS_futex, word, op, value, timeout, NULL, 0);
+}
+
+static void kill_client(struct player* p) {
+    if (p->pid > 0) {
+        kill(p->pid, SIGKILL);
+        waitpid(p->pid, NULL, 0);
+    }
+    p->pid = -1;
+    p->has_failed = 1;
+}
+
+// Waits for the client to answer the given request, returns -1 if its process died or it took longer than time_limit
+static int wait_response(struct player* p, uint32_t request, double time_limit) {
+    struct client_channel* channel = p->channel;
+    double deadline = time_limit > 0 ? get_monotonic_time() + time_limit : -1;
+    struct timespec poll_time = {0, CHANNEL__POLL_TIME};
+
+    while (1) {
+        uint32_t response = __atomic_load_n(&channel->response, __ATOMIC_ACQUIRE);
+        if (response == request)
+            return 0;
+        futex(&channel->response, FUTEX_WAIT, response, &poll_time);
+        if (__atomic_load_n(&channel->response, __ATOMIC_ACQUIRE) == request)
+            return 0;
+        if (waitpid(p->pid, NULL, WNOHANG) != 0 || (deadline > 0 && get_monotonic_time() > deadline))
+            return -1;
+    }
+}
+
+// Posts a request to the client and waits for its answer, the client being killed if it does not come
+static int call_client(struct player* p, enum channel_op op, double time_limit) {
+    if (p->has_failed)
+        return -1;
+
+    p->channel->op = op;
+    uint32_t request = __atomic_add_fetch(&p->channel->request, 1, __ATOMIC_RELEASE);
+    futex(&p->channel->request, FUTEX_WAKE, 1, NULL);
+    if (wait_response(p, request, time_limit)) {
+        kill_client(p);
+        return -1;
+    }
+    return 0;
+}
+
+// Answers the requests of the server until it asks to finalize, in the process hosting the client
+static void serve_client(struct player* p) {
+    struct client_channel* channel = p->channel;
+    uint32_t request = __atomic_load_n(&channel->request, __ATOMIC_ACQUIRE);
+
+    // The initialization was the first request
+    __atomic_store_n(&channel->response, request, __ATOMIC_RELEASE);
+    futex(&channel->response, FUTEX_WAKE, 1, NULL);
+
+    while (1) {
+        uint32_t next;
+        while ((next = __atomic_load_n(&channel->request, __ATOMIC_ACQUIRE)) == request)
+            futex(&channel->request, FUTEX_WAIT, request, NULL);
+        request = next;
+
+        struct move_t move = create_initial_move();
+        if (channel->op == CHANNEL_FINALIZE) {
+            stop_pondering(p, move);
+            p->finalize();
+        } else {
+            stop_pondering(p, channel->move);
+            if (channel->has_times && p->set_remaining_time)
+                p->set_remaining_time(channel->move_time, channel->game_time);
+            channel->has_times = 0;
+            move = p->play(channel->move);
+            channel->move = move;
+            channel->score = p->get_move_score ? p->get_move_score() : NAN;
+        }
+
+        __atomic_store_n(&channel->response, request, __ATOMIC_RELEASE);
+        futex(&channel->response, FUTEX_WAKE, 1, NULL);
+        if (channel->op == CHANNEL_FINALIZE)
+            _exit(EXIT_SUCCESS);
+        start_pondering(p, move);
+    }
+}
+
+// The process hosting the client may allocate memory_limit bytes more than the server it is forked from
+static void limit_memory(size_t memory_limit) {
+    unsigned long nb_pages = 0;
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if (statm) {
+        if (fscanf(statm, "%lu", &nb_pages) != 1)
+            nb_pages = 0;
+        fclose(statm);
+    }
+
+    struct rlimit limit;
+    limit.rlim_cur = limit.rlim_max = nb_pages * sysconf(_SC_PAGESIZE) + memory_limit;
+    setrlimit(RLIMIT_AS, &limit);
+}
+
+/* Forks the process hosting an isolated client, which is initialized with the given arguments.
+   Returns 1 in the server, the child never returns. */
+static int start_client(struct player* p, uint player_id, struct graph_t* graph, uint num_queens, uint** queens, const struct board_desc_t* board) {
+    p->channel->request = 1;
+    p->channel->response = 0;
+
+    fflush(stdout);
+    fflush(stderr);
+    p->pid = fork();
+    if (p->pid < 0) {
+        handle_error(__func__, "Could not fork the client", PROGRAM_CONTINUE);
+        p->has_failed = 1;
+        return 1;
+    }
+
+    if (p->pid == 0) {
+        prctl(PR_SET_PDEATHSIG, SIGKILL);
+        if (p->memory_limit)
+            limit_memory(p->memory_limit);
+        if (board)
+            p->initialize_shared(player_id, board);
+        else
+            p->initialize(player_id, graph, num_queens, queens);
+        serve_client(p);
+    }
+
+    // A client still initializing past its time is killed, and loses the game on its first move
+    if (wait_response(p, 1, p->init_time))
+        kill_client(p);
+    return 1;
+}
+
 // Checks for errors in dlsym function
 static void check_dlsym(const char* func) {
     char* dl_error;
@@ -46,25 +255,151 @@ struct player* client__load(const char* client_path) {
     client_p->play = load_and_check_dlsym(__func__, client_p, "play");
     client_p->finalize = load_and_check_dlsym(__func__, client_p, "finalize");
 
+    // Retrieves the optional functions, which may be missing
+    client_p->set_remaining_time = dlsym(client_p->client_dl, "set_remaining_time");
+    client_p->initialize_shared = dlsym(client_p->client_dl, "initialize_shared");
+    client_p->get_move_score = dlsym(client_p->client_dl, "get_move_score");
+    client_p->set_seed = dlsym(client_p->client_dl, "set_seed");
+    client_p->ponder = dlsym(client_p->client_dl, "ponder");
+    client_p->ponderhit = dlsym(client_p->client_dl, "ponderhit");
+    if (!client_p->ponderhit)
+        client_p->ponder = NULL;
+    dlerror();
+
+    client_p->channel = NULL;
+    client_p->pid = -1;
+    client_p->memory_limit = 0;
+    client_p->init_time = 0;
+    client_p->time_limit = 0;
+    client_p->has_failed = 0;
+    client_p->can_ponder = 0;
+    client_p->is_pondering = 0;
+    client_p->has_times = 0;
+    client_p->score = NAN;
+
     return client_p;
 }
 
+void client__isolate(struct player* p, size_t memory_limit, double init_time) {
+    p->channel = mmap(NULL, sizeof(struct client_channel), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (p->channel == MAP_FAILED)
+        handle_error(__func__, "Not enough memory for the channel", PROGRAM_EXIT);
+    p->channel->has_times = 0;
+    p->memory_limit = memory_limit;
+    p->init_time = init_time;
+}
+
+int client__has_failed(const struct player* p) {
+    return p->has_failed;
+}
+
+void client__allow_ponder(struct player* p) {
+    p->can_ponder = 1;
+}
+
+int client__shares_library(const struct player* p1, const struct player* p2) {
+    return p1->client_dl == p2->client_dl;
+}
+
 void client__unload(struct player* p) {
+    if (p->channel) {
+        if (p->pid > 0)
+            kill_client(p);
+        munmap(p->channel, sizeof(struct client_channel));
+    }
     if (dlclose(p->client_dl))
         handle_error(__func__, "Failed on freeing the configuration file player", 0);
     free(p);
 }
 
+void client__set_seed(struct player* p, uint64_t seed) {
+    // An isolated client is only forked at its initialization, so it gets its seed from the server's copy of the library
+    if (p->set_seed)
+        p->set_seed(seed);
+}
+
 char const* client__get_player_name(const struct player* p) {
     return p->get_player_name();
 }
 
 void client__initialize(struct player* p, uint player_id, struct graph_t* graph, uint num_queens, uint** queens) {
-    return p->initialize(player_id, graph, num_queens, queens);
+    if (!p->channel) {
+        p->initialize(player_id, graph, num_queens, queens);
+        return;
+    }
+
+    // The client owns its copies in its own process, those of the server are not used by anyone
+    start_client(p, player_id, graph, num_queens, queens, NULL);
+    graph__free(graph);
+    for (uint i = 0; i < NUM_PLAYERS; i++)
+        free(queens[i]);
+}
+
+int client__has_shared_initialize(const struct player* p) {
+    return p->initialize_shared != NULL;
+}
+
+void client__initialize_shared(struct player* p, uint player_id, const struct board_desc_t* board) {
+    if (p->channel)
+        start_client(p, player_id, NULL, 0, NULL, board);
+    else
+        p->initialize_shared(player_id, board);
 }
 
 struct move_t client__play(struct player* p, struct move_t previous_move) {
-    return p->play(previous_move);
+    if (!p->channel) {
+        stop_pondering(p, previous_move);
+        if (p->has_times)
+            p->set_remaining_time(p->move_time, p->game_time);
+        p->has_times = 0;
+        struct move_t move = p->play(previous_move);
+        p->score = p->get_move_score ? p->get_move_score() : NAN;
+        start_pondering(p, move);
+        return move;
+    }
+
+    p->channel->move = previous_move;
+    if (call_client(p, CHANNEL_PLAY, p->time_limit > 0 ? p->time_limit + CHANNEL__GRACE_TIME : 0)) {
+        p->score = NAN;
+        return create_initial_move();
+    }
+    p->score = p->channel->score;
+    return p->channel->move;
+}
+
+double client__get_move_score(const struct player* p) {
+    return p->score;
 }
 
-void client__finalize(struct player* p) { p->finalize(); }
\ No newline at end of file
+void client__set_remaining_time(struct player* p, double move_time, double game_time) {
+    if (p->channel) {
+        // A client running out of time is killed, whether it asks for the time left or not
+        p->time_limit = move_time > 0 && (game_time < 0 || move_time < game_time) ? move_time : game_time;
+        p->channel->move_time = move_time;
+        p->channel->game_time = game_time;
+        p->channel->has_times = 1;
+        return;
+    }
+    if (!p->set_remaining_time)
+        return;
+    if (p->is_pondering) {
+        // The client is told once it stopped pondering, on the opponent's move
+        p->move_time = move_time;
+        p->game_time = game_time;
+        p->has_times = 1;
+    } else
+        p->set_remaining_time(move_time, game_time);
+}
+
+void client__finalize(struct player* p) {
+    if (!p->channel) {
+        stop_pondering(p, create_initial_move());
+        p->finalize();
+        return;
+    }
+
+    if (!call_client(p, CHANNEL_FINALIZE, CHANNEL__FINALIZE_TIME)) {
+        waitpid(p->pid, NULL, 0);
+        p->pid = -1;
+    }
+}
\ No newline at end of file
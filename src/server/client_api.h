@@ -6,6 +6,9 @@
 #ifndef __CLIENT_API_H__
 #define __CLIENT_API_H__
 
+#include <stdint.h>
+
+#include "board_desc.h"
 #include "graph.h"
 #include "move.h"
 
@@ -19,6 +22,44 @@ struct player;
  */
 struct player* client__load(const char* client_path);
 
+/**
+ * @brief Host a loaded client library in its own process from its initialization on.
+ *
+ * The calls to initialize, play and finalize are then forwarded through shared memory to a forked process,
+ * so that a client crashing, running out of memory, or still playing past its time limit is killed without
+ * harming the server. Such a client is reported by client__has_failed.
+ *
+ * @param p A pointer to the struct containing the loaded client library, not initialized yet.
+ * @param memory_limit The number of bytes the client may allocate, 0 for no limit.
+ * @param init_time The number of seconds the client may spend on its initialization, 0 for no limit.
+ */
+void client__isolate(struct player* p, size_t memory_limit, double init_time);
+
+/**
+ * @brief Check if an isolated client library was killed.
+ * @param p A pointer to the struct containing the loaded client library.
+ * @return 1 if the process hosting the client crashed or was killed, 0 otherwise.
+ */
+int client__has_failed(const struct player* p);
+
+/**
+ * @brief Let a loaded client library think on the opponent's time, if it defines ponder and ponderhit.
+ *
+ * After each move of the client, its ponder function then runs on a thread of its own until the opponent's move
+ * is known, ponderhit being called just before the next call to play or finalize.
+ *
+ * @param p A pointer to the struct containing the loaded client library, not initialized yet.
+ */
+void client__allow_ponder(struct player* p);
+
+/**
+ * @brief Check if two loaded clients come from the same library, and so share its global state.
+ * @param p1 A pointer to the struct containing the first loaded client library.
+ * @param p2 A pointer to the struct containing the second loaded client library.
+ * @return 1 if both were loaded from the same library, 0 otherwise.
+ */
+int client__shares_library(const struct player* p1, const struct player* p2);
+
 /**
  * @brief Unload a previously loaded client shared library and free its memory.
  *
@@ -34,6 +75,16 @@ void client__unload(struct player* p);
  */
 char const* client__get_player_name(const struct player* p);
 
+/**
+ * @brief Give the seed of its random generator to a loaded client library, if it defines set_seed.
+ *
+ * The clients of a same library share the seed last given, so each client is given its own just before its initialization.
+ *
+ * @param p A pointer to the struct containing the loaded client library, not initialized yet.
+ * @param seed The seed of the client.
+ */
+void client__set_seed(struct player* p, uint64_t seed);
+
 /**
  * @brief Initialize a loaded client library with the given parameters.
  *
@@ -45,6 +96,21 @@ char const* client__get_player_name(const struct player* p);
  */
 void client__initialize(struct player* p, uint player_id, struct graph_t* graph, uint num_queens, uint** queens);
 
+/**
+ * @brief Check if a loaded client library can be initialized from a shared board description.
+ * @param p A pointer to the struct containing the loaded client library.
+ * @return 1 if the library defines initialize_shared, 0 otherwise.
+ */
+int client__has_shared_initialize(const struct player* p);
+
+/**
+ * @brief Initialize a loaded client library from a shared board description.
+ * @param p A pointer to the struct containing the loaded client library, which must define initialize_shared.
+ * @param player_id The ID of the player being initialized.
+ * @param board The description of the initial board, only valid during the call.
+ */
+void client__initialize_shared(struct player* p, uint player_id, const struct board_desc_t* board);
+
 /**
  * @brief Let a loaded client library make a move.
  *
@@ -54,6 +120,21 @@ void client__initialize(struct player* p, uint player_id, struct graph_t* graph,
  */
 struct move_t client__play(struct player* p, struct move_t previous_move);
 
+/**
+ * @brief Get the evaluation a loaded client library gave of its last move, if it defines get_move_score.
+ * @param p A pointer to the struct containing the loaded client library.
+ * @return The value of the last move from the point of view of the client, NAN if it does not give any.
+ */
+double client__get_move_score(const struct player* p);
+
+/**
+ * @brief Give the time left to a loaded client library, if it asks for it.
+ * @param p A pointer to the struct containing the loaded client library.
+ * @param move_time The number of seconds left for the coming move, negative if unlimited.
+ * @param game_time The number of seconds left for the rest of the game, negative if unlimited.
+ */
+void client__set_remaining_time(struct player* p, double move_time, double game_time);
+
 /**
  * @brief Finalize a loaded client library.
  *
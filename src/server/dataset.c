@@ -0,0 +1,283 @@
+#define _DEFAULT_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "dataset.h"
+#include "export.h"
+
+#define DATASET__VERSION 1
+
+static const char header_magic[4] = {'A', 'M', 'Z', 'D'};
+
+struct dataset_writer {
+    int fd;
+    int index_fd;
+    struct dataset_header header;
+    unsigned char* positions; // The positions of the game being written
+    uint nb_positions;
+    uint positions_cap;
+    int error;
+};
+
+static size_t nb_blocked_words(uint size) {
+    return (size * size + 63) / 64;
+}
+
+// The blocked vertices then the queens, rounded up so that the next position is aligned too
+static uint position_size_for(uint size, uint nb_queens) {
+    size_t bytes = sizeof(struct dataset_position) + nb_blocked_words(size) * sizeof(uint64_t) + NUM_PLAYERS * nb_queens * sizeof(uint16_t);
+    return (bytes + sizeof(uint64_t) - 1) / sizeof(uint64_t) * sizeof(uint64_t);
+}
+
+static int is_valid_header(const struct dataset_header* header) {
+    return !memcmp(header->magic, header_magic, sizeof(header_magic)) && header->version == DATASET__VERSION && header->size &&
+           header->size * header->size <= DATASET__NO_COORD && header->position_size == position_size_for(header->size, header->nb_queens);
+}
+
+static uint16_t* position_queens(const struct dataset_header* header, void* position, uint player_id) {
+    return (uint16_t*)((unsigned char*)position + sizeof(struct dataset_position) + nb_blocked_words(header->size) * sizeof(uint64_t)) +
+           player_id * header->nb_queens;
+}
+
+static int write_all(int fd, const void* buf, size_t size) {
+    const char* p = buf;
+    while (size) {
+        ssize_t n = write(fd, p, size);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return -1;
+        p += n;
+        size -= n;
+    }
+    return 0;
+}
+
+static char* index_path_of(const char* path) {
+    char* index_path = malloc(strlen(path) + sizeof(DATASET__INDEX_SUFFIX));
+    if (!index_path)
+        handle_error(__func__, "Not enough memory for 'index_path'", PROGRAM_EXIT);
+    strcpy(index_path, path);
+    strcat(index_path, DATASET__INDEX_SUFFIX);
+    return index_path;
+}
+
+// Writes the header of a new dataset, or checks that of an existing one, the file being locked by the caller
+static int init_header(int fd, const struct dataset_header* header) {
+    struct stat st;
+    if (fstat(fd, &st))
+        return -1;
+    if (st.st_size == 0)
+        return write_all(fd, header, sizeof(*header));
+
+    struct dataset_header existing;
+    if (pread(fd, &existing, sizeof(existing), 0) != sizeof(existing))
+        return -1;
+    return memcmp(&existing, header, sizeof(existing)) ? -1 : 0;
+}
+
+/* **************************************************************** */
+
+dataset_writer dataset__open(const char* path, char board_shape, uint size, uint nb_queens) {
+    if (!path) handle_error(__func__, "Invalid parameter 'path'", PROGRAM_EXIT);
+    if (!size || size * size > DATASET__NO_COORD) handle_error(__func__, "Invalid parameter 'size'", PROGRAM_EXIT);
+
+    dataset_writer writer = malloc(sizeof(struct dataset_writer));
+    if (!writer)
+        handle_error(__func__, "Not enough memory for 'writer'", PROGRAM_EXIT);
+    memset(writer, 0, sizeof(*writer));
+    memcpy(writer->header.magic, header_magic, sizeof(header_magic));
+    writer->header.version = DATASET__VERSION;
+    writer->header.board_shape = board_shape;
+    writer->header.size = size;
+    writer->header.nb_queens = nb_queens;
+    writer->header.position_size = position_size_for(size, nb_queens);
+
+    char* index_path = index_path_of(path);
+    writer->fd = open(path, O_RDWR | O_CREAT | O_APPEND, 0666);
+    writer->index_fd = open(index_path, O_WRONLY | O_CREAT | O_APPEND, 0666);
+    free(index_path);
+
+    int status = writer->fd < 0 || writer->index_fd < 0 || flock(writer->fd, LOCK_EX);
+    if (!status) {
+        status = init_header(writer->fd, &writer->header);
+        flock(writer->fd, LOCK_UN);
+    }
+    if (status) {
+        handle_error(__func__, "Could not open the dataset, or it holds positions of another board", PROGRAM_CONTINUE);
+        if (writer->fd >= 0)
+            close(writer->fd);
+        if (writer->index_fd >= 0)
+            close(writer->index_fd);
+        free(writer);
+        return NULL;
+    }
+    return writer;
+}
+
+void dataset__add_position(dataset_writer writer, const unsigned char* cells, uint side_to_move, struct move_t move, double score) {
+    if (!writer) handle_error(__func__, "Invalid parameter 'writer'", PROGRAM_EXIT);
+    if (!cells) handle_error(__func__, "Invalid parameter 'cells'", PROGRAM_EXIT);
+
+    uint position_size = writer->header.position_size;
+    if (writer->nb_positions == writer->positions_cap) {
+        writer->positions_cap = writer->positions_cap ? 2 * writer->positions_cap : 64;
+        writer->positions = realloc(writer->positions, (size_t)writer->positions_cap * position_size);
+        if (!writer->positions)
+            handle_error(__func__, "Not enough memory for 'positions'", PROGRAM_EXIT);
+    }
+
+    struct dataset_position* position = (struct dataset_position*)(writer->positions + (size_t)writer->nb_positions * position_size);
+    memset(position, 0, position_size);
+    position->ply = writer->nb_positions++;
+    position->side_to_move = side_to_move;
+    uint coords[3] = {move.queen_src, move.queen_dst, move.arrow_dst};
+    for (uint i = 0; i < 3; i++)
+        position->move[i] = is_initial_move(move) ? DATASET__NO_COORD : coords[i];
+    position->score = score;
+
+    uint nb_found[NUM_PLAYERS] = {0, 0};
+    uint16_t* queens[NUM_PLAYERS] = {position_queens(&writer->header, position, 0), position_queens(&writer->header, position, 1)};
+    for (uint pos = 0; pos < writer->header.size * writer->header.size; pos++) {
+        if (cells[pos] == EXPORT__BLOCKED)
+            position->blocked[pos / 64] |= (uint64_t)1 << (pos % 64);
+        else if (cells[pos] != EXPORT__EMPTY) {
+            uint player_id = cells[pos] == EXPORT__QUEEN_2;
+            if (nb_found[player_id] < writer->header.nb_queens)
+                queens[player_id][nb_found[player_id]++] = pos;
+        }
+    }
+    for (uint player_id = 0; player_id < NUM_PLAYERS; player_id++)
+        for (uint i = nb_found[player_id]; i < writer->header.nb_queens; i++)
+            queens[player_id][i] = DATASET__NO_COORD;
+}
+
+int dataset__end_game(dataset_writer writer, int seed, uint winner) {
+    if (!writer) handle_error(__func__, "Invalid parameter 'writer'", PROGRAM_EXIT);
+
+    uint position_size = writer->header.position_size;
+    for (uint i = 0; i < writer->nb_positions; i++) {
+        struct dataset_position* position = (struct dataset_position*)(writer->positions + (size_t)i * position_size);
+        position->seed = seed;
+        position->nb_plies = writer->nb_positions;
+        position->result = position->side_to_move == winner ? 1 : -1;
+    }
+
+    // The positions of a game and its entry in the index are appended together, whatever the other writers do
+    if (flock(writer->fd, LOCK_EX)) {
+        writer->error = 1;
+        return -1;
+    }
+    struct stat st;
+    int status = fstat(writer->fd, &st);
+    if (!status) {
+        struct dataset_game game = {(st.st_size - sizeof(struct dataset_header)) / position_size, writer->nb_positions, seed};
+        status = write_all(writer->fd, writer->positions, (size_t)writer->nb_positions * position_size) ||
+                 write_all(writer->index_fd, &game, sizeof(game));
+    }
+    flock(writer->fd, LOCK_UN);
+
+    writer->nb_positions = 0;
+    if (status)
+        writer->error = 1;
+    return status ? -1 : 0;
+}
+
+int dataset__close(dataset_writer writer) {
+    if (!writer) handle_error(__func__, "Invalid parameter 'writer'", PROGRAM_EXIT);
+
+    int error = writer->error;
+    error |= close(writer->fd) != 0;
+    error |= close(writer->index_fd) != 0;
+    free(writer->positions);
+    free(writer);
+    return error ? -1 : 0;
+}
+
+struct dataset_t* dataset__load(const char* path) {
+    if (!path) handle_error(__func__, "Invalid parameter 'path'", PROGRAM_EXIT);
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+    struct stat st;
+    if (fstat(fd, &st) || (size_t)st.st_size < sizeof(struct dataset_header)) {
+        close(fd);
+        return NULL;
+    }
+    void* map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return NULL;
+
+    struct dataset_t* dataset = malloc(sizeof(struct dataset_t));
+    if (!dataset)
+        handle_error(__func__, "Not enough memory for 'dataset'", PROGRAM_EXIT);
+    memcpy(&dataset->header, map, sizeof(struct dataset_header));
+    if (!is_valid_header(&dataset->header)) {
+        munmap(map, st.st_size);
+        free(dataset);
+        return NULL;
+    }
+    dataset->map = map;
+    dataset->map_size = st.st_size;
+    dataset->positions = (const unsigned char*)map + sizeof(struct dataset_header);
+    dataset->nb_positions = (st.st_size - sizeof(struct dataset_header)) / dataset->header.position_size;
+
+    // Only the games whose positions are all in the file are indexed
+    dataset->index_map = NULL;
+    dataset->index_size = 0;
+    dataset->games = NULL;
+    dataset->nb_games = 0;
+    char* index_path = index_path_of(path);
+    fd = open(index_path, O_RDONLY);
+    free(index_path);
+    if (fd >= 0) {
+        if (!fstat(fd, &st) && (size_t)st.st_size >= sizeof(struct dataset_game)) {
+            void* index_map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+            if (index_map != MAP_FAILED) {
+                dataset->index_map = index_map;
+                dataset->index_size = st.st_size;
+                dataset->games = index_map;
+                size_t nb_games = st.st_size / sizeof(struct dataset_game);
+                while (nb_games && dataset->games[nb_games - 1].first_position + dataset->games[nb_games - 1].nb_positions > dataset->nb_positions)
+                    nb_games--;
+                dataset->nb_games = nb_games;
+            }
+        }
+        close(fd);
+    }
+    return dataset;
+}
+
+void dataset__free(struct dataset_t* dataset) {
+    if (!dataset)
+        return;
+    munmap(dataset->map, dataset->map_size);
+    if (dataset->index_map)
+        munmap(dataset->index_map, dataset->index_size);
+    free(dataset);
+}
+
+const struct dataset_position* dataset__get(const struct dataset_t* dataset, size_t position_id) {
+    if (!dataset) handle_error(__func__, "Invalid parameter 'dataset'", PROGRAM_EXIT);
+    if (position_id >= dataset->nb_positions) handle_error(__func__, "Invalid parameter 'position_id'", PROGRAM_EXIT);
+    return (const struct dataset_position*)(dataset->positions + position_id * dataset->header.position_size);
+}
+
+const uint16_t* dataset__get_queens(const struct dataset_t* dataset, const struct dataset_position* position, uint player_id) {
+    if (!dataset) handle_error(__func__, "Invalid parameter 'dataset'", PROGRAM_EXIT);
+    if (player_id >= NUM_PLAYERS) handle_error(__func__, "Invalid parameter 'player_id'", PROGRAM_EXIT);
+    return position_queens(&dataset->header, (void*)position, player_id);
+}
+
+int dataset__is_blocked(const struct dataset_position* position, uint pos) {
+    return (position->blocked[pos / 64] >> (pos % 64)) & 1;
+}
@@ -0,0 +1,169 @@
+/**
+ * @file dataset.h
+ * @brief This file contains the declarations of functions and data types used to store the positions of many games.
+ *
+ * A dataset is an append-only file starting with a header, followed by positions of a fixed size, so that position i
+ * is found at a known offset once the file is mapped in memory. A game is only appended once it is over, in one
+ * write, and the index file next to it, whose path ends with DATASET__INDEX_SUFFIX, then gets the first position and
+ * the number of positions of the game. Several processes may append to the same dataset.
+ * The integers are stored in the byte order of the machine.
+ */
+
+#ifndef __DATASET_H__
+#define __DATASET_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "move.h"
+#include "player.h"
+#include "utils.h"
+
+#define DATASET__INDEX_SUFFIX ".idx"
+#define DATASET__NO_COORD UINT16_MAX // The coordinates of the move losing a game by forfeit, and of missing queens
+
+/**
+ * @brief A struct representing the header of a dataset.
+ * board_shape and size are the shape and the size of the board of every game.
+ * nb_queens is the number of queens per player.
+ * position_size is the number of bytes of each position.
+ */
+struct dataset_header {
+    char magic[4];
+    uint32_t version;
+    uint32_t board_shape;
+    uint32_t size;
+    uint32_t nb_queens;
+    uint32_t position_size;
+};
+
+/**
+ * @brief A struct representing a position of a dataset, before the move of side_to_move.
+ * seed is the seed of the game, ply the number of moves played by the clients before the position,
+ * nb_plies the number of positions of the game.
+ * result is 1 if side_to_move won the game, -1 otherwise.
+ * move is the move played from the position (queen_src, queen_dst, arrow_dst), DATASET__NO_COORD if it lost by forfeit.
+ * score is the evaluation of that move by its player, NAN if its client gives none.
+ * blocked has a bit set for each vertex without any neighbor, the arrows and the holes of the shape,
+ * followed by the queens of each player, given by dataset__get_queens.
+ */
+struct dataset_position {
+    int32_t seed;
+    uint16_t ply;
+    uint16_t nb_plies;
+    uint8_t side_to_move;
+    int8_t result;
+    uint16_t move[3];
+    float score;
+    uint32_t reserved; // Zero
+    uint64_t blocked[];
+};
+
+/**
+ * @brief A struct representing an entry of the index of a dataset, a game.
+ */
+struct dataset_game {
+    uint64_t first_position;
+    uint32_t nb_positions;
+    int32_t seed;
+};
+
+/**
+ * @brief The structure pointer used to append games to a dataset.
+ */
+typedef struct dataset_writer* dataset_writer;
+
+/**
+ * @brief A struct representing a dataset mapped in memory.
+ * nb_positions is the number of complete positions of the file, nb_games the number of games of the index.
+ */
+struct dataset_t {
+    struct dataset_header header;
+    const unsigned char* positions;
+    size_t nb_positions;
+    const struct dataset_game* games;
+    size_t nb_games;
+    void* map;         // The mapping of the whole file
+    size_t map_size;
+    void* index_map;   // The mapping of the index, NULL if it is empty or missing
+    size_t index_size;
+};
+
+/**
+ * @brief Opens a dataset to append games to it, creating it if it does not exist.
+ *
+ * @param path The path of the dataset file.
+ * @param board_shape The shape of the board.
+ * @param size The size of the board, of at most 255 vertices per side.
+ * @param nb_queens The number of queens per player.
+ * @return The writer of the dataset, NULL if the file could not be created or holds games of another kind of board.
+ */
+dataset_writer dataset__open(const char* path, char board_shape, uint size, uint nb_queens);
+
+/**
+ * @brief Adds a position to the game being written, which is kept in memory until dataset__end_game.
+ *
+ * @param writer The writer of the dataset.
+ * @param cells The content of each vertex of the board, as filled by game__export.
+ * @param side_to_move The player to move.
+ * @param move The move played from the position, or the initial move if it lost the game by forfeit.
+ * @param score The evaluation of the move by its player, NAN if none.
+ */
+void dataset__add_position(dataset_writer writer, const unsigned char* cells, uint side_to_move, struct move_t move, double score);
+
+/**
+ * @brief Sets the result of the positions added since the last game, and appends them to the dataset.
+ *
+ * @param writer The writer of the dataset.
+ * @param seed The seed of the game.
+ * @param winner The winner of the game.
+ * @return 0 if every write succeeded, -1 otherwise.
+ */
+int dataset__end_game(dataset_writer writer, int seed, uint winner);
+
+/**
+ * @brief Closes a dataset opened by dataset__open, dropping the positions of an unfinished game.
+ * @param writer The writer of the dataset.
+ * @return 0 if every write succeeded, -1 otherwise.
+ */
+int dataset__close(dataset_writer writer);
+
+/**
+ * @brief Maps a dataset and its index in memory, read-only.
+ * @param path The path of the dataset file.
+ * @return The dataset, NULL if the file could not be read or is not a dataset.
+ */
+struct dataset_t* dataset__load(const char* path);
+
+/**
+ * @brief Unmaps a dataset loaded by dataset__load.
+ * @param dataset The dataset.
+ */
+void dataset__free(struct dataset_t* dataset);
+
+/**
+ * @brief Gets a position of a dataset.
+ * @param dataset The dataset.
+ * @param position_id The index of the position, less than nb_positions.
+ * @return The position, valid until the dataset is freed.
+ */
+const struct dataset_position* dataset__get(const struct dataset_t* dataset, size_t position_id);
+
+/**
+ * @brief Gets the queens of a player in a position.
+ * @param dataset The dataset.
+ * @param position The position.
+ * @param player_id The player.
+ * @return The nb_queens vertices of the queens of the player, in increasing order.
+ */
+const uint16_t* dataset__get_queens(const struct dataset_t* dataset, const struct dataset_position* position, uint player_id);
+
+/**
+ * @brief Checks if a vertex is blocked in a position.
+ * @param position The position.
+ * @param pos The vertex.
+ * @return 1 if the vertex has no neighbor, 0 otherwise.
+ */
+int dataset__is_blocked(const struct dataset_position* position, uint pos);
+
+#endif // __DATASET_H__
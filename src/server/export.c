@@ -1,6 +1,9 @@
+#define _DEFAULT_SOURCE
+
 #include "export.h"
-#include <dirent.h>
 #include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -10,6 +13,404 @@
 
 #define PERMISSIONS S_IRWXU
 
+// The colors of the palette of the images
+enum export_color {
+    COLOR_BACKGROUND,
+    COLOR_GRID,
+    COLOR_EMPTY,
+    COLOR_ARROW,
+    COLOR_QUEEN_1,
+    COLOR_QUEEN_2,
+    NB_COLORS
+};
+
+static const unsigned char palette[NB_COLORS][3] = {
+    {255, 255, 255}, // Background, also drawn for the holes of the shape
+    {90, 90, 90},    // Grid lines
+    {220, 220, 220}, // Empty vertex
+    {50, 50, 50},    // Arrow
+    {220, 40, 40},   // Queen of player 1
+    {40, 80, 220},   // Queen of player 2
+};
+
+struct byte_buffer {
+    unsigned char* data;
+    size_t size;
+    size_t cap;
+};
+
+struct export_log_t {
+    FILE* file;
+    uint player_id;
+    uint nb_moves;
+    int error;
+};
+
+struct export_t {
+    uint size;
+    uint nb_frames;
+    uint cap;
+    unsigned char* cells;                 // nb_frames blocks of size * size cells
+    struct byte_buffer* compressed;       // The zlib stream of the pixels of each frame, filled by export__write
+    pthread_mutex_t lock;                 // Protects next_frame while rendering
+    uint next_frame;                      // The next frame to render by the workers
+    const char* directory;
+    int error;
+};
+
+static uint32_t crc_table[256];
+
+/* **************************************************************** */
+/* Byte and bit streams */
+
+static void buffer_reserve(struct byte_buffer* buffer, size_t extra) {
+    if (buffer->size + extra <= buffer->cap)
+        return;
+    while (buffer->size + extra > buffer->cap)
+        buffer->cap = buffer->cap ? 2 * buffer->cap : 4096;
+    buffer->data = realloc(buffer->data, buffer->cap);
+    if (!buffer->data)
+        handle_error(__func__, "Not enough memory for 'buffer'", PROGRAM_EXIT);
+}
+
+static void buffer_push(struct byte_buffer* buffer, unsigned char byte) {
+    buffer_reserve(buffer, 1);
+    buffer->data[buffer->size++] = byte;
+}
+
+static void buffer_push_u32(struct byte_buffer* buffer, uint32_t value) {
+    buffer_push(buffer, value >> 24);
+    buffer_push(buffer, value >> 16);
+    buffer_push(buffer, value >> 8);
+    buffer_push(buffer, value);
+}
+
+// The bits of deflate are packed from the least significant bit of each byte
+struct bit_writer {
+    struct byte_buffer* out;
+    uint32_t bits;
+    uint nb_bits;
+};
+
+static void bits_push(struct bit_writer* writer, uint32_t value, uint nb_bits) {
+    writer->bits |= value << writer->nb_bits;
+    writer->nb_bits += nb_bits;
+    while (writer->nb_bits >= 8) {
+        buffer_push(writer->out, writer->bits & 0xFF);
+        writer->bits >>= 8;
+        writer->nb_bits -= 8;
+    }
+}
+
+// The Huffman codes are stored from their most significant bit
+static void bits_push_code(struct bit_writer* writer, uint32_t code, uint nb_bits) {
+    uint32_t reversed = 0;
+    for (uint i = 0; i < nb_bits; i++)
+        reversed |= ((code >> i) & 1) << (nb_bits - 1 - i);
+    bits_push(writer, reversed, nb_bits);
+}
+
+static void bits_flush(struct bit_writer* writer) {
+    if (writer->nb_bits)
+        bits_push(writer, 0, 8 - writer->nb_bits);
+}
+
+/* **************************************************************** */
+/* Deflate with the fixed Huffman codes, only matching runs of a repeated byte */
+
+static void deflate_symbol(struct bit_writer* writer, uint symbol) {
+    if (symbol < 144)
+        bits_push_code(writer, 0x30 + symbol, 8);
+    else if (symbol < 256)
+        bits_push_code(writer, 0x190 + symbol - 144, 9);
+    else if (symbol < 280)
+        bits_push_code(writer, symbol - 256, 7);
+    else
+        bits_push_code(writer, 0xC0 + symbol - 280, 8);
+}
+
+// Copies length bytes from the previous one, with 3 <= length <= 258
+static void deflate_run(struct bit_writer* writer, uint length) {
+    static const uint base[] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+    static const uint extra[] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+
+    uint code = 28;
+    while (base[code] > length)
+        code--;
+    deflate_symbol(writer, 257 + code);
+    bits_push(writer, length - base[code], extra[code]);
+    bits_push_code(writer, 0, 5); // Distance 1
+}
+
+static void deflate(const unsigned char* data, size_t size, struct byte_buffer* out) {
+    struct bit_writer writer = {out, 0, 0};
+    bits_push(&writer, 1, 1); // Last block
+    bits_push(&writer, 1, 2); // Fixed Huffman codes
+
+    size_t i = 0;
+    while (i < size) {
+        deflate_symbol(&writer, data[i]);
+        size_t run = 0;
+        while (i + 1 + run < size && data[i + 1 + run] == data[i])
+            run++;
+        i += 1 + run;
+
+        while (run >= 3) {
+            uint length = run > 258 ? 258 : run;
+            if (run > 258 && run - 258 < 3)
+                length = run - 3;
+            deflate_run(&writer, length);
+            run -= length;
+        }
+        while (run-- > 0)
+            deflate_symbol(&writer, data[i - 1]);
+    }
+
+    deflate_symbol(&writer, 256); // End of block
+    bits_flush(&writer);
+}
+
+static uint32_t adler32(const unsigned char* data, size_t size) {
+    uint32_t a = 1, b = 0;
+    for (size_t i = 0; i < size; i++) {
+        a = (a + data[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    return (b << 16) | a;
+}
+
+static void zlib_compress(const unsigned char* data, size_t size, struct byte_buffer* out) {
+    buffer_push(out, 0x78);
+    buffer_push(out, 0x01);
+    deflate(data, size, out);
+    buffer_push_u32(out, adler32(data, size));
+}
+
+/* **************************************************************** */
+/* Rendering */
+
+static void crc_init() {
+    for (uint32_t n = 0; n < 256; n++) {
+        uint32_t c = n;
+        for (uint k = 0; k < 8; k++)
+            c = c & 1 ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+        crc_table[n] = c;
+    }
+}
+
+static uint32_t crc_update(uint32_t crc, const unsigned char* data, size_t size) {
+    for (size_t i = 0; i < size; i++)
+        crc = crc_table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return crc;
+}
+
+static uint image_width(uint size) {
+    return size * (EXPORT__CELL_SIZE + 1) + 1;
+}
+
+static unsigned char cell_color(const unsigned char* first, const unsigned char* cells, uint pos) {
+    switch (cells[pos]) {
+        case EXPORT__BLOCKED:
+            return first[pos] == EXPORT__BLOCKED ? COLOR_BACKGROUND : COLOR_ARROW;
+        case EXPORT__QUEEN_1:
+            return COLOR_QUEEN_1;
+        case EXPORT__QUEEN_2:
+            return COLOR_QUEEN_2;
+        default:
+            return COLOR_EMPTY;
+    }
+}
+
+// Draws a frame with one palette index per pixel, each row starting with its PNG filter byte
+static void render(const struct export_t* export, uint frame_id, unsigned char* pixels) {
+    uint width = image_width(export->size);
+    uint stride = width + 1;
+    const unsigned char* first = export->cells;
+    const unsigned char* cells = export->cells + (size_t)frame_id * export->size * export->size;
+    int radius = EXPORT__CELL_SIZE / 2 - 3;
+
+    for (uint y = 0; y < width; y++) {
+        unsigned char* row = pixels + (size_t)y * stride;
+        row[0] = 0; // No filter
+        for (uint x = 0; x < width; x++) {
+            uint cell_x = x / (EXPORT__CELL_SIZE + 1), cell_y = y / (EXPORT__CELL_SIZE + 1);
+            int in_x = x % (EXPORT__CELL_SIZE + 1) - 1, in_y = y % (EXPORT__CELL_SIZE + 1) - 1;
+            if (in_x < 0 || in_y < 0) {
+                row[1 + x] = COLOR_GRID;
+                continue;
+            }
+
+            // The queens are drawn as discs on an empty vertex
+            unsigned char color = cell_color(first, cells, cell_y * export->size + cell_x);
+            if (color == COLOR_QUEEN_1 || color == COLOR_QUEEN_2) {
+                int dx = 2 * in_x + 1 - EXPORT__CELL_SIZE, dy = 2 * in_y + 1 - EXPORT__CELL_SIZE;
+                if (dx * dx + dy * dy > 4 * radius * radius)
+                    color = COLOR_EMPTY;
+            }
+            row[1 + x] = color;
+        }
+    }
+
+    // The Up filter turns the rows repeated along the cells into runs of zeros
+    for (uint y = width - 1; y > 0; y--) {
+        unsigned char* row = pixels + (size_t)y * stride;
+        const unsigned char* above = row - stride;
+        row[0] = 2;
+        for (uint x = 1; x < stride; x++)
+            row[x] -= above[x];
+    }
+}
+
+/* **************************************************************** */
+/* PNG files */
+
+static void write_chunk(FILE* file, const char type[4], const unsigned char* data, size_t size, int* error) {
+    unsigned char header[8] = {size >> 24, size >> 16, size >> 8, size, type[0], type[1], type[2], type[3]};
+    uint32_t crc = crc_update(0xFFFFFFFF, header + 4, 4);
+    crc = crc_update(crc, data, size) ^ 0xFFFFFFFF;
+    unsigned char footer[4] = {crc >> 24, crc >> 16, crc >> 8, crc};
+
+    if (fwrite(header, 1, 8, file) != 8 || (size && fwrite(data, 1, size, file) != size) || fwrite(footer, 1, 4, file) != 4)
+        *error = 1;
+}
+
+static void write_png_header(FILE* file, uint width, int* error) {
+    static const unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    if (fwrite(signature, 1, sizeof(signature), file) != sizeof(signature))
+        *error = 1;
+
+    struct byte_buffer ihdr = {0};
+    buffer_push_u32(&ihdr, width);
+    buffer_push_u32(&ihdr, width);
+    buffer_push(&ihdr, 8); // Bit depth
+    buffer_push(&ihdr, 3); // Indexed colors
+    buffer_push(&ihdr, 0); // Compression
+    buffer_push(&ihdr, 0); // Filter
+    buffer_push(&ihdr, 0); // No interlace
+    write_chunk(file, "IHDR", ihdr.data, ihdr.size, error);
+    write_chunk(file, "PLTE", &palette[0][0], sizeof(palette), error);
+    free(ihdr.data);
+}
+
+static int write_png(const char* path, uint width, const struct byte_buffer* compressed) {
+    FILE* file = fopen(path, "wb");
+    if (!file)
+        return -1;
+
+    int error = 0;
+    write_png_header(file, width, &error);
+    write_chunk(file, "IDAT", compressed->data, compressed->size, &error);
+    write_chunk(file, "IEND", NULL, 0, &error);
+    if (fclose(file))
+        error = 1;
+    return error ? -1 : 0;
+}
+
+// The frame control chunk of an animated PNG
+static void push_frame_control(struct byte_buffer* chunk, uint sequence, uint width) {
+    buffer_push_u32(chunk, sequence);
+    buffer_push_u32(chunk, width);
+    buffer_push_u32(chunk, width);
+    buffer_push_u32(chunk, 0); // x offset
+    buffer_push_u32(chunk, 0); // y offset
+    buffer_push(chunk, EXPORT__FRAME_DELAY >> 8);
+    buffer_push(chunk, EXPORT__FRAME_DELAY & 0xFF);
+    buffer_push(chunk, 0);
+    buffer_push(chunk, 100); // Delay denominator
+    buffer_push(chunk, 0);   // No disposal
+    buffer_push(chunk, 0);   // No blending
+}
+
+static int write_animation(const struct export_t* export, const char* path) {
+    FILE* file = fopen(path, "wb");
+    if (!file)
+        return -1;
+
+    uint width = image_width(export->size);
+    int error = 0;
+    write_png_header(file, width, &error);
+
+    struct byte_buffer chunk = {0};
+    buffer_push_u32(&chunk, export->nb_frames);
+    buffer_push_u32(&chunk, 0); // Loop forever
+    write_chunk(file, "acTL", chunk.data, chunk.size, &error);
+
+    uint sequence = 0;
+    for (uint frame_id = 0; frame_id < export->nb_frames; frame_id++) {
+        chunk.size = 0;
+        push_frame_control(&chunk, sequence++, width);
+        write_chunk(file, "fcTL", chunk.data, chunk.size, &error);
+
+        // The first frame is also the image shown by the viewers without animation support
+        const struct byte_buffer* compressed = &export->compressed[frame_id];
+        if (frame_id == 0) {
+            write_chunk(file, "IDAT", compressed->data, compressed->size, &error);
+            continue;
+        }
+        chunk.size = 0;
+        buffer_push_u32(&chunk, sequence++);
+        buffer_reserve(&chunk, compressed->size);
+        memcpy(chunk.data + chunk.size, compressed->data, compressed->size);
+        chunk.size += compressed->size;
+        write_chunk(file, "fdAT", chunk.data, chunk.size, &error);
+    }
+    write_chunk(file, "IEND", NULL, 0, &error);
+
+    free(chunk.data);
+    if (fclose(file))
+        error = 1;
+    return error ? -1 : 0;
+}
+
+// Renders, compresses and writes the frames not taken yet by the other workers
+static void* render_frames(void* arg) {
+    struct export_t* export = arg;
+    uint width = image_width(export->size);
+    unsigned char* pixels = malloc((size_t)width * (width + 1));
+    if (!pixels)
+        handle_error(__func__, "Not enough memory for 'pixels'", PROGRAM_EXIT);
+
+    while (1) {
+        pthread_mutex_lock(&export->lock);
+        uint frame_id = export->next_frame++;
+        pthread_mutex_unlock(&export->lock);
+        if (frame_id >= export->nb_frames)
+            break;
+
+        render(export, frame_id, pixels);
+        zlib_compress(pixels, (size_t)width * (width + 1), &export->compressed[frame_id]);
+
+        char path[512];
+        snprintf(path, sizeof(path), "%s/%u.png", export->directory, frame_id);
+        if (write_png(path, width, &export->compressed[frame_id])) {
+            pthread_mutex_lock(&export->lock);
+            export->error = 1;
+            pthread_mutex_unlock(&export->lock);
+        }
+    }
+
+    free(pixels);
+    return NULL;
+}
+
+/* **************************************************************** */
+/* JSON lines */
+
+// Prints the vertices holding the given cell, in increasing order
+static void json_print_cells(FILE* file, uint size, const unsigned char* cells, unsigned char cell) {
+    int is_first = 1;
+    fputc('[', file);
+    for (uint pos = 0; pos < size * size; pos++) {
+        if (cells[pos] == cell) {
+            fprintf(file, is_first ? "%u" : ",%u", pos);
+            is_first = 0;
+        }
+    }
+    fputc(']', file);
+}
+
+/* **************************************************************** */
+
 int export__create_dir(const char* path) {
     struct stat st;
     if (stat(path, &st) == -1) {
@@ -22,29 +423,143 @@ int export__create_dir(const char* path) {
     return 0;
 }
 
-void export__compile_dot() {
-    DIR* dir;
-    struct dirent* ent;
+struct export_t* export__new(uint size) {
+    struct export_t* export = calloc(1, sizeof(struct export_t));
+    if (!export)
+        handle_error(__func__, "Not enough memory for 'export'", PROGRAM_EXIT);
+    export->size = size;
+    pthread_mutex_init(&export->lock, NULL);
+    return export;
+}
+
+void export__add_frame(struct export_t* export, const unsigned char* cells) {
+    if (!export) handle_error(__func__, "Invalid parameter 'export'", PROGRAM_EXIT);
+
+    size_t frame_size = (size_t)export->size * export->size;
+    if (export->nb_frames == export->cap) {
+        export->cap = export->cap ? 2 * export->cap : 64;
+        export->cells = realloc(export->cells, export->cap * frame_size);
+        if (!export->cells)
+            handle_error(__func__, "Not enough memory for 'cells'", PROGRAM_EXIT);
+    }
+    memcpy(export->cells + export->nb_frames * frame_size, cells, frame_size);
+    export->nb_frames++;
+}
+
+int export__write(struct export_t* export, const char* directory, uint nb_workers) {
+    if (!export) handle_error(__func__, "Invalid parameter 'export'", PROGRAM_EXIT);
+    if (!directory) handle_error(__func__, "Invalid parameter 'directory'", PROGRAM_EXIT);
+    if (export->nb_frames == 0)
+        return 0;
+
+    if (nb_workers == 0) {
+        long nb_cores = sysconf(_SC_NPROCESSORS_ONLN);
+        nb_workers = nb_cores > 0 ? (uint)nb_cores : 1;
+    }
+    if (nb_workers > export->nb_frames)
+        nb_workers = export->nb_frames;
+
+    crc_init();
+    export->compressed = calloc(export->nb_frames, sizeof(struct byte_buffer));
+    pthread_t* workers = malloc(nb_workers * sizeof(pthread_t));
+    if (!export->compressed || !workers)
+        handle_error(__func__, "Not enough memory for the frames", PROGRAM_EXIT);
+    export->directory = directory;
+    export->next_frame = 0;
+    export->error = 0;
+
+    // The calling thread renders frames too, the others only help it
+    uint nb_threads = 0;
+    for (uint i = 1; i < nb_workers; i++) {
+        if (pthread_create(&workers[nb_threads], NULL, render_frames, export) == 0)
+            nb_threads++;
+    }
+    render_frames(export);
+    for (uint i = 0; i < nb_threads; i++)
+        pthread_join(workers[i], NULL);
+    free(workers);
+
+    char path[512];
+    snprintf(path, sizeof(path), "%s/animation.png", directory);
+    if (write_animation(export, path))
+        export->error = 1;
 
-    char command[1024];
+    for (uint frame_id = 0; frame_id < export->nb_frames; frame_id++)
+        free(export->compressed[frame_id].data);
+    free(export->compressed);
+    export->compressed = NULL;
+
+    if (export->error)
+        handle_error(__func__, "Could not write the images", PROGRAM_CONTINUE);
+    return export->error ? -1 : 0;
+}
 
-    dir = opendir(EXPORT_DIR);
-    if (dir == NULL) {
-        handle_error(__func__, "Cannot open directory", 0);
+void export__free(struct export_t* export) {
+    if (!export)
         return;
+    pthread_mutex_destroy(&export->lock);
+    free(export->cells);
+    free(export);
+}
+
+struct export_log_t* export__log_open(const char* path, uint size, const unsigned char* cells, const char* names[NUM_PLAYERS], int seed,
+                                      uint starting_player) {
+    if (!path) handle_error(__func__, "Invalid parameter 'path'", PROGRAM_EXIT);
+    if (!cells) handle_error(__func__, "Invalid parameter 'cells'", PROGRAM_EXIT);
+
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        handle_error(__func__, "Could not create the export", PROGRAM_CONTINUE);
+        return NULL;
     }
 
-    while ((ent = readdir(dir)) != NULL) {
-        if (strstr(ent->d_name, ".dot") != NULL) {
-            snprintf(command, sizeof(command), "dot -Kneato -Tpng ./export/%s -o ./export/%s.png", ent->d_name, ent->d_name);
-            system(command);
-        }
+    struct export_log_t* export_log = calloc(1, sizeof(struct export_log_t));
+    if (!export_log)
+        handle_error(__func__, "Not enough memory for 'export_log'", PROGRAM_EXIT);
+    export_log->file = file;
+    export_log->player_id = starting_player;
+
+    // The board is only described once, the moves being enough to rebuild any turn from it
+    fprintf(file, "{\"size\":%u,\"seed\":%d,\"players\":[", size, seed);
+    for (uint player_id = 0; player_id < NUM_PLAYERS; player_id++) {
+        if (player_id)
+            fputc(',', file);
+        print_json_string(file, names && names[player_id] ? names[player_id] : "");
     }
+    fprintf(file, "],\"starting_player\":%u,\"holes\":", starting_player);
+    json_print_cells(file, size, cells, EXPORT__BLOCKED);
+    fprintf(file, ",\"queens\":[");
+    json_print_cells(file, size, cells, EXPORT__QUEEN_1);
+    fputc(',', file);
+    json_print_cells(file, size, cells, EXPORT__QUEEN_2);
+    fprintf(file, "]}\n");
+
+    return export_log;
+}
+
+void export__log_move(struct export_log_t* export_log, struct move_t move) {
+    if (!export_log) handle_error(__func__, "Invalid parameter 'export_log'", PROGRAM_EXIT);
+
+    if (fprintf(export_log->file, "{\"turn\":%u,\"player\":%u,\"queen_src\":%u,\"queen_dst\":%u,\"arrow_dst\":%u}\n", export_log->nb_moves,
+                export_log->player_id, move.queen_src, move.queen_dst, move.arrow_dst) < 0)
+        export_log->error = 1;
+    export_log->player_id ^= 1;
+    export_log->nb_moves++;
+}
+
+int export__log_close(struct export_log_t* export_log, int winner, int forfeit) {
+    if (!export_log) handle_error(__func__, "Invalid parameter 'export_log'", PROGRAM_EXIT);
 
-    closedir(dir);
+    if (fprintf(export_log->file, "{\"winner\":%d,\"forfeit\":%s,\"nb_moves\":%u}\n", winner, forfeit ? "true" : "false", export_log->nb_moves) < 0)
+        export_log->error = 1;
+    if (fclose(export_log->file))
+        export_log->error = 1;
 
-    // Removes dot files
-    system("rm ./export/*.dot");
+    int error = export_log->error;
+    free(export_log);
+    if (error)
+        handle_error(__func__, "Could not write the export", PROGRAM_CONTINUE);
+    return error ? -1 : 0;
 }
 
 void export__remove_dir(const char* directory) {
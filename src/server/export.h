@@ -1,7 +1,31 @@
 #ifndef __EXPORT_H__
 #define __EXPORT_H__
 
+#include "move.h"
+#include "player.h"
+#include "utils.h"
+
 #define EXPORT_DIR "./export"
+#define EXPORT__CELL_SIZE 24
+#define EXPORT__FRAME_DELAY 10 // The delay between two frames of the animation, in hundredths of a second
+
+/**
+ * @brief The content of a vertex in a frame.
+ *
+ * EXPORT__BLOCKED is a vertex without any neighbor: a hole of the shape if it is already blocked in the first frame,
+ * an arrow otherwise.
+ */
+enum export_cell {
+    EXPORT__EMPTY = 0,
+    EXPORT__BLOCKED = 1,
+    EXPORT__QUEEN_1 = 2,
+    EXPORT__QUEEN_2 = 3,
+};
+
+/**
+ * @brief The frames of a game to export, rendered at the end of the game.
+ */
+struct export_t;
 
 /**
  * @brief Creates a directory at the specified path.
@@ -15,12 +39,79 @@
 int export__create_dir(const char* path);
 
 /**
- * @brief Compiles Graphviz DOT files into PNG images.
+ * @brief Allocates the frames of a game played on a square grid.
+ * @param size The size of the board.
+ * @return The new export.
+ */
+struct export_t* export__new(uint size);
+
+/**
+ * @brief Adds a frame to an export.
+ * @param export The export.
+ * @param cells The content of each of the size * size vertices of the board, copied.
+ */
+void export__add_frame(struct export_t* export, const unsigned char* cells);
+
+/**
+ * @brief Renders the frames of an export to PNG images.
+ *
+ * Frame i is written to `directory/i.png`, and all the frames to the animated PNG `directory/animation.png`.
+ * The board is drawn directly from the grid, the frames being rendered and compressed in parallel.
  *
- * This function uses the `dot` command from Graphviz to convert all `.dot` files in the
- * `./export/` directory into `.png` images. The original `.dot` files are then removed.
+ * @param export The export.
+ * @param directory The directory of the images, which must exist.
+ * @param nb_workers The number of threads rendering the frames, 0 for one per online core.
+ * @return 0 if every image was written, -1 otherwise.
+ */
+int export__write(struct export_t* export, const char* directory, uint nb_workers);
+
+/**
+ * @brief Frees an export.
+ * @param export The export.
+ */
+void export__free(struct export_t* export);
+
+/**
+ * @brief A game exported move by move, as JSON lines.
+ */
+struct export_log_t;
+
+/**
+ * @brief Creates a JSON lines export of a game and writes its initial board.
+ *
+ * The first line describes the board once: its size, the seed, the players, the starting player,
+ * the holes of the shape and the queens of each player. Each move then takes one line, and the result one last line:
+ *
+ *     {"size":8,"seed":42,"players":["A","B"],"starting_player":0,"holes":[],"queens":[[2,5],[58,61]]}
+ *     {"turn":0,"player":0,"queen_src":2,"queen_dst":18,"arrow_dst":19}
+ *     {"winner":0,"forfeit":false,"nb_moves":1}
+ *
+ * @param path The path of the export file.
+ * @param size The size of the board.
+ * @param cells The content of each of the size * size vertices of the initial board, as filled by game__export.
+ * @param names The names of the players.
+ * @param seed The random seed of the game.
+ * @param starting_player The player who plays the first move.
+ * @return The export, NULL if the file could not be created.
+ */
+struct export_log_t* export__log_open(const char* path, uint size, const unsigned char* cells, const char* names[NUM_PLAYERS], int seed,
+                                      uint starting_player);
+
+/**
+ * @brief Appends a valid move to a JSON lines export.
+ * @param export_log The export.
+ * @param move The move, played by the player following the one of the previous move.
+ */
+void export__log_move(struct export_log_t* export_log, struct move_t move);
+
+/**
+ * @brief Writes the result of the game and closes a JSON lines export.
+ * @param export_log The export.
+ * @param winner The winner of the game.
+ * @param forfeit Whether the game ended by an invalid move.
+ * @return 0 if every write succeeded, -1 otherwise.
  */
-void export__compile_dot();
+int export__log_close(struct export_log_t* export_log, int winner, int forfeit);
 
 /**
  * @brief Removes the directory at the specified path.
@@ -32,4 +123,4 @@ void export__compile_dot();
  */
 void export__remove_dir(const char* directory);
 
-#endif // __EXPORT_H__
\ No newline at end of file
+#endif // __EXPORT_H__
@@ -6,12 +6,17 @@
 #include <string.h>
 #include <time.h>
 
+#include "board_cache.h"
 #include "client_api.h"
 #include "dir.h"
+#include "export.h"
 #include "game.h"
 #include "graph.h"
+#include "latency.h"
+#include "movegen.h"
 #include "player.h"
 #include "queens.h"
+#include "rng.h"
 #include "shape.h"
 #include "utils.h"
 
@@ -23,40 +28,131 @@ struct game_s {
     struct shape_t* shape;
     struct player* players[2];
     struct queens_t* queens;
+    int last_move_status;
+    int seed;
+    struct rng_t rng; // Seeded with seed, draws the starting player, the opening and the seeds of the clients
+    double move_time;
+    double game_time;
+    double time_left[NUM_PLAYERS];
+    unsigned char* is_movable[NUM_PLAYERS]; // is_movable[p][i] is 1 if the queen i of player p has an empty neighbor
+    uint nb_movable[NUM_PLAYERS]; // The number of queens of each player having an empty neighbor
+    struct latency_stats stats;
+    struct move_t* opening; // The random moves played by the server before the clients, nb_opening of them
+    uint nb_opening;
 };
 
+// The vertices whose queen may change its mobility after a move: the source, the destination, the arrow and their neighbors
+#define NB_TOUCHED_VERTICES (3 * (NUM_DIRS + 1))
+
 static int check_move(cgame g, struct move_t m) {
-    int is_valid_queen_move = is_valid_move_for_player(g->board, g->queens, g->current_player, m.queen_src, m.queen_dst, 0);
-    int is_valid_arrow_move = is_valid_move_for_player(g->board, g->queens, g->current_player, m.queen_dst, m.arrow_dst, 1) || m.queen_src == m.arrow_dst;
+    return move__check(g->board, g->queens, g->current_player, m);
+}
+
+static void board_init(game game, const char* board_cache) {
+    board_cache__init_graph(game->shape, game->board, board_cache);
+}
 
-    if (!is_valid_queen_move) {
-        return MOVE_INVALID_QUEEN_MISPLACED;
-    } else if (!is_valid_arrow_move) {
-        return MOVE_INVALID_ARROW_MISPLACED;
+static void mobility_init(game game) {
+    uint nb_queens = queens__get_nb_queens(game->queens);
+    for (uint player_id = 0; player_id < NUM_PLAYERS; player_id++) {
+        game->is_movable[player_id] = malloc(nb_queens * sizeof(unsigned char));
+        if (!game->is_movable[player_id])
+            handle_error(__func__, "Not enough memory for 'is_movable[p]'", PROGRAM_EXIT);
+        game->nb_movable[player_id] = 0;
+        for (uint queen_id = 0; queen_id < nb_queens; queen_id++) {
+            game->is_movable[player_id][queen_id] = can_move(game->board, game->queens, game->queens->array[player_id][queen_id]);
+            game->nb_movable[player_id] += game->is_movable[player_id][queen_id];
+        }
     }
-    return MOVE_REGULAR;
 }
 
-static void board_init(game game) {
-    uint board_size = shape__get_size(game->shape);
-    graph__init(game->board, board_size * board_size);
-    shape__init_graph(game->shape, game->board);
-    graph__compress(game->board);
+// Lists pos and its neighbors, which must be done before the arrow cuts the edges
+static uint touched_vertices(game game, uint pos, uint* touched, uint nb_touched) {
+    touched[nb_touched++] = pos;
+    for (enum dir_t dir = FIRST_DIR; dir <= LAST_DIR; dir++) {
+        uint neighbor = graph__get_neighbor(game->board, pos, dir);
+        if (neighbor != GRAPH__NO_NEIGHBOR)
+            touched[nb_touched++] = neighbor;
+    }
+    return nb_touched;
+}
+
+// Only a queen next to a vertex that changed can change its mobility
+static void mobility_update(game game, const uint* touched, uint nb_touched) {
+    for (uint i = 0; i < nb_touched; i++) {
+        uint pos = touched[i];
+        uint player_id = game->queens->owner[pos];
+        if (player_id == QUEENS__NO_OWNER)
+            continue;
+        uint queen_id = game->queens->slot[pos];
+        unsigned char is_movable = can_move(game->board, game->queens, pos);
+        game->nb_movable[player_id] += is_movable - game->is_movable[player_id][queen_id];
+        game->is_movable[player_id][queen_id] = is_movable;
+    }
 }
 
 static void board_update(game game, struct move_t move) {
+    uint touched[NB_TOUCHED_VERTICES];
+    uint nb_touched = touched_vertices(game, move.queen_src, touched, 0);
+    nb_touched = touched_vertices(game, move.queen_dst, touched, nb_touched);
+    nb_touched = touched_vertices(game, move.arrow_dst, touched, nb_touched);
+
     move_queen(game->queens, game->current_player, move);
     graph__disconnect(game->board, move.arrow_dst);
+    mobility_update(game, touched, nb_touched);
 }
 
 static enum player_n get_opposing_player_id(enum player_n player_id) {
     return player_id ^ 1;
 }
 
+// Plays nb_moves random moves from the initial position, stopping early if a player is blocked
+static void opening_play(game game, uint nb_moves) {
+    game->nb_opening = 0;
+    game->opening = malloc((nb_moves ? nb_moves : 1) * sizeof(struct move_t));
+    if (!game->opening)
+        handle_error(__func__, "Not enough memory for 'opening'", PROGRAM_EXIT);
+
+    for (uint i = 0; i < nb_moves; i++) {
+        size_t nb_legal = movegen__generate(game->board, game->queens, game->current_player, NULL, 0);
+        if (!nb_legal)
+            return;
+        struct move_t* legal = malloc(nb_legal * sizeof(struct move_t));
+        if (!legal)
+            handle_error(__func__, "Not enough memory for 'legal'", PROGRAM_EXIT);
+        movegen__generate(game->board, game->queens, game->current_player, legal, nb_legal);
+
+        struct move_t move = legal[rng__below(&game->rng, nb_legal)];
+        move_queen(game->queens, game->current_player, move);
+        graph__disconnect(game->board, move.arrow_dst);
+        game->opening[game->nb_opening++] = move;
+        game->current_player = get_opposing_player_id(game->current_player);
+        free(legal);
+    }
+}
+
 static void update_winner(game game, enum player_n player_id) {
     game->p_winner = player_id;
 }
 
+static int is_over(game game) {
+    /* This scenario occurs only when an invalid move has been made */
+    if (game->p_winner != UNDEFINED_PLAYER)
+        return 1;
+
+    /* Verify if all the queens of a player are trapped, the counts being kept up to date by each move */
+    for (uint player_id = 0; player_id < NUM_PLAYERS; player_id++) {
+        if (!game->nb_movable[player_id]) {
+            // All the queens in the player cannot move. The other player wins the game.
+            update_winner(game, get_opposing_player_id(player_id));
+            return 1;
+        }
+    }
+
+    // No one is blocked or has made a bad move: the game continues.
+    return 0;
+}
+
 /* **************************************************************** */
 
 struct game_config game__default_config() {
@@ -64,8 +160,19 @@ struct game_config game__default_config() {
     enum player_n default_starting_player = UNDEFINED_PLAYER;
     enum board_shape default_board_shape = SHAPE__DEFAULT_SHAPE;
     int default_seed = -1;
-
-    return (struct game_config){default_board_size, default_starting_player, default_board_shape, default_seed};
+    double default_move_time = 0;
+    double default_game_time = 0;
+    int default_isolate_clients = 0;
+    uint default_client_memory = 0;
+    double default_init_time = 0;
+    int default_ponder = 0;
+    uint default_opening_moves = 0;
+    const char* default_board_cache = NULL;
+    const char* default_shape_path = NULL;
+
+    return (struct game_config){default_board_size, default_starting_player, default_board_shape, default_seed, default_move_time, default_game_time,
+                                default_isolate_clients, default_client_memory, default_init_time, default_ponder, default_opening_moves, default_board_cache,
+                                default_shape_path};
 }
 
 game game__new() {
@@ -81,44 +188,77 @@ void game__init(game game, struct game_config* game_config, const char* lib_play
     if (!lib_player1) handle_error(__func__, "Invalid parameter 'p1'", PROGRAM_EXIT);
     if (!lib_player2) handle_error(__func__, "Invalid parameter 'p2'", PROGRAM_EXIT);
 
-    srand(game_config->seed < 0 ? time(NULL) : game_config->seed); /* Initialization of random seed */
+    game->seed = game_config->seed < 0 ? (int)(time(NULL) & INT_MAX) : game_config->seed;
+    rng__seed(&game->rng, game->seed); /* Initialization of the random generator of the game */
 
     game->shape = shape__new();
     game->board = graph__new();
     game->queens = queens__new();
 
-    shape__init(game->shape, game_config->size, game_config->board_shape);
-    board_init(game);
+    if (game_config->board_shape == SHAPE_MASK) {
+        if (!game_config->shape_path || shape__init_from_file(game->shape, game_config->shape_path))
+            handle_error(__func__, "Could not read the board file", PROGRAM_EXIT);
+    } else
+        shape__init(game->shape, game_config->size, game_config->board_shape);
+    board_init(game, game_config->board_cache);
 
     /* Initialization of initial data */
-    game->current_player = game_config->starting_player == UNDEFINED_PLAYER ? rand() % 2 : game_config->starting_player;
+    game->current_player = game_config->starting_player == UNDEFINED_PLAYER ? (enum player_n)rng__below(&game->rng, NUM_PLAYERS) : game_config->starting_player;
     update_winner(game, UNDEFINED_PLAYER);
     game->previous_move = create_initial_move();
+    game->last_move_status = MOVE_REGULAR;
+    game->move_time = game_config->move_time;
+    game->game_time = game_config->game_time;
+    for (enum player_n player_id = 0; player_id < NUM_PLAYERS; player_id++)
+        game->time_left[player_id] = game_config->game_time;
+    memset(&game->stats, 0, sizeof(game->stats));
 
     /* Allocation and creation of copies of queens */
-    uint nb_queens = 4 * ((int)(shape__get_size(game->shape) / 10 + 1));
+    uint nb_queens = queens__default_count(shape__get_size(game->shape));
     queens__alloc(game->queens, nb_queens);
     queens__init(game->queens, shape__get_size(game->shape));
-
-    uint** queens_players[NUM_PLAYERS];
-
-    struct queens_t* queens_player1 = queens__new();
-    struct queens_t* queens_player2 = queens__new();
-    queens__copy(game->queens, queens_player1);
-    queens__copy(game->queens, queens_player2);
-    queens_players[PLAYER_1] = queens__get_array(queens_player1);
-    queens_players[PLAYER_2] = queens__get_array(queens_player2);
+    for (enum player_n player_id = 0; player_id < NUM_PLAYERS; player_id++)
+        for (uint queen_id = 0; queen_id < nb_queens; queen_id++)
+            if (is_isolated(game->board, game->queens->array[player_id][queen_id]))
+                handle_error(__func__, "A queen starts on a hole of the board", PROGRAM_EXIT);
+    opening_play(game, game_config->opening_moves);
+    mobility_init(game);
 
     /* Launching clients when the server is operational */
     game->players[0] = client__load(lib_player1);
     game->players[1] = client__load(lib_player2);
+    if (game_config->isolate_clients)
+        for (enum player_n player_id = 0; player_id < NUM_PLAYERS; player_id++)
+            client__isolate(game->players[player_id], (size_t)game_config->client_memory << 20, game_config->init_time);
+
+    /* Two clients of the same library share its globals, so only one of them may run at a time unless they are isolated */
+    if (game_config->ponder && (game_config->isolate_clients || !client__shares_library(game->players[0], game->players[1])))
+        for (enum player_n player_id = 0; player_id < NUM_PLAYERS; player_id++)
+            client__allow_ponder(game->players[player_id]);
+
+    /* Initialization of clients, from a shared description of the board for those accepting it, from private copies otherwise.
+       Each client draws from its own generator, seeded from the game just before its initialization, as two clients of the
+       same library share the seed it was given */
+    const struct board_desc_t* shared_board = NULL;
+    for (enum player_n player_id = 0; player_id < NUM_PLAYERS; player_id++) {
+        struct player* player = game->players[player_id];
+        client__set_seed(player, rng__next(&game->rng));
+        if (client__has_shared_initialize(player)) {
+            if (!shared_board)
+                shared_board = board_desc__publish(game->board, game->queens);
+            client__initialize_shared(player, player_id, shared_board);
+            continue;
+        }
 
-    /* Initialization of clients */
-    for (enum player_n player_id = 0; player_id < NUM_PLAYERS; player_id++)
-        client__initialize(game->players[player_id], player_id, graph__copy(game->board), queens__get_nb_queens(game->queens), queens_players[player_id]);
+        struct queens_t* queens_player = queens__new();
+        queens__copy(game->queens, queens_player);
+        client__initialize(player, player_id, graph__copy(game->board), queens__get_nb_queens(game->queens), queens__get_array(queens_player));
 
-    free(queens_player1);
-    free(queens_player2);
+        /* The arrays now belong to the client */
+        queens__free_index(queens_player);
+        free(queens_player);
+    }
+    board_desc__release(shared_board);
 }
 
 void game__delete(game game) {
@@ -135,6 +275,9 @@ void game__delete(game game) {
         graph__free(game->board);
         queens__free(game->queens);
         shape__delete(game->shape);
+        for (uint player_id = 0; player_id < NUM_PLAYERS; player_id++)
+            free(game->is_movable[player_id]);
+        free(game->opening);
     }
     free(game); /* Free the game */
     game = NULL;
@@ -143,28 +286,10 @@ void game__delete(game game) {
 int game__is_over(game game) {
     if (!game) handle_error(__func__, "Invalid parameter 'g'", PROGRAM_EXIT);
 
-    /* This scenario occurs only when an invalid move has been made */
-    if (game->p_winner != UNDEFINED_PLAYER)
-        return 1;
-
-    /* Verify if a queen is trapped or non-existent */
-    for (uint player_id = 0; player_id < NUM_PLAYERS; player_id++) {
-        int is_queen_moveable = 0;
-        for (uint queen_id = 0; queen_id < queens__get_nb_queens(game->queens); queen_id++) {
-            if (can_move(game->board, game->queens, game->queens->array[player_id][queen_id])) {
-                is_queen_moveable = 1;
-            }
-        }
-
-        if (!is_queen_moveable) {
-            // All the queens in the player cannot move. The other player wins the game.
-            update_winner(game, get_opposing_player_id(player_id));
-            return 1;
-        }
-    }
-
-    // No one is blocked or has made a bad move: the game continues.
-    return 0;
+    double start = get_monotonic_time();
+    int result = is_over(game);
+    latency__add(&game->stats.is_over, get_monotonic_time() - start);
+    return result;
 }
 
 void game__next_player(game game) {
@@ -175,15 +300,33 @@ void game__next_player(game game) {
 void game__play(game game) {
     if (!game) handle_error(__func__, "Invalid parameter 'g'", PROGRAM_EXIT);
 
-    struct move_t t_move = client__play(game->players[game->current_player], game->previous_move);
-
-    /* If it is not a valid move, then the other player wins the game and the move is not played. */
-    if (check_move(game, t_move) != MOVE_REGULAR) {
+    struct player* player = game->players[game->current_player];
+    client__set_remaining_time(player, game->move_time > 0 ? game->move_time : -1, game->game_time > 0 ? game->time_left[game->current_player] : -1);
+
+    double start = get_monotonic_time();
+    struct move_t t_move = client__play(player, game->previous_move);
+    double elapsed = get_monotonic_time() - start;
+    game->time_left[game->current_player] -= elapsed;
+    latency__add(&game->stats.think[game->current_player], elapsed);
+
+    /* If it is not a valid move or it came too late, then the other player wins the game and the move is not played. */
+    if ((game->move_time > 0 && elapsed > game->move_time) || (game->game_time > 0 && game->time_left[game->current_player] < 0))
+        game->last_move_status = MOVE_INVALID_TIMEOUT;
+    else if (client__has_failed(player))
+        game->last_move_status = MOVE_INVALID_CRASH;
+    else {
+        start = get_monotonic_time();
+        game->last_move_status = check_move(game, t_move);
+        latency__add(&game->stats.check_move, get_monotonic_time() - start);
+    }
+    if (game->last_move_status != MOVE_REGULAR) {
         update_winner(game, get_opposing_player_id(game->current_player));
         return;
     }
 
+    start = get_monotonic_time();
     board_update(game, t_move);
+    latency__add(&game->stats.board_update, get_monotonic_time() - start);
     game->previous_move = t_move;
 }
 
@@ -192,41 +335,73 @@ enum player_n game__get_current_player(cgame game) {
     return game->current_player;
 }
 
+int game__is_forfeit(cgame game) {
+    if (!game) handle_error(__func__, "Invalid parameter 'g'", PROGRAM_EXIT);
+    return game->last_move_status != MOVE_REGULAR;
+}
+
 enum player_n game__get_winner(cgame game) {
     if (!game) handle_error(__func__, "Invalid parameter 'g'", PROGRAM_EXIT);
     return game->p_winner;
 }
 
+struct move_t game__get_previous_move(cgame game) {
+    if (!game) handle_error(__func__, "Invalid parameter 'g'", PROGRAM_EXIT);
+    return game->previous_move;
+}
+
+uint game__get_board_size(cgame game) {
+    if (!game) handle_error(__func__, "Invalid parameter 'g'", PROGRAM_EXIT);
+    return shape__get_size(game->shape);
+}
+
+enum board_shape game__get_board_shape(cgame game) {
+    if (!game) handle_error(__func__, "Invalid parameter 'g'", PROGRAM_EXIT);
+    return shape__get_board_shape(game->shape);
+}
+
+const unsigned char* game__get_board_mask(cgame game) {
+    if (!game) handle_error(__func__, "Invalid parameter 'g'", PROGRAM_EXIT);
+    return shape__get_mask(game->shape);
+}
+
+const struct move_t* game__get_opening(cgame game, uint* nb_moves) {
+    if (!game) handle_error(__func__, "Invalid parameter 'g'", PROGRAM_EXIT);
+    if (!nb_moves) handle_error(__func__, "Invalid parameter 'nb_moves'", PROGRAM_EXIT);
+    *nb_moves = game->nb_opening;
+    return game->opening;
+}
+
+int game__get_seed(cgame game) {
+    if (!game) handle_error(__func__, "Invalid parameter 'g'", PROGRAM_EXIT);
+    return game->seed;
+}
+
+const struct latency_stats* game__get_stats(cgame game) {
+    if (!game) handle_error(__func__, "Invalid parameter 'g'", PROGRAM_EXIT);
+    return &game->stats;
+}
+
+double game__get_move_score(cgame game) {
+    if (!game) handle_error(__func__, "Invalid parameter 'g'", PROGRAM_EXIT);
+    return client__get_move_score(game->players[game->current_player]);
+}
+
 const char* game__get_player_name(cgame game, enum player_n player_id) {
     if (player_id == UNDEFINED_PLAYER)
         return "Undefined player";
     return client__get_player_name(game->players[player_id]);
 }
 
-void game__export(cgame game, char* path) {
-    FILE* file = fopen(path, "w");
-    uint m = shape__get_size(game->shape);
-    gsl_spmatrix_uint* csr = game->board->t;
-    fprintf(file,
-            "digraph G {\nnode [shape=square, width=0.5, height=0.5, "
-            "style=filled, fillcolor=gray];\n");
-    for (unsigned int i = 0; i < m; i++)
-        for (unsigned int j = 0; j < m; j++)
-            fprintf(file, "%u [pos=\"%u,%u!\"]\n", i * m + j, j, m - (i + 1));
-
-    for (unsigned int i = 0; i < csr->size1; i++) {
-        for (int k = csr->p[i]; k < csr->p[i + 1]; k++) {
-            unsigned int j = csr->i[k];
-            if (gsl_spmatrix_uint_get(csr, i, j))
-                fprintf(file, "%u -> %u;\n", i, j);
-        }
-    }
+void game__export(cgame game, unsigned char* cells) {
+    if (!game) handle_error(__func__, "Invalid parameter 'g'", PROGRAM_EXIT);
 
-    for (uint i = 0; i < 2; i++)
-        for (uint j = 0; j < queens__get_nb_queens(game->queens); j++)
-            if (game->queens->array[i][j] < game->board->num_vertices)
-                fprintf(file, "%u [fillcolor=%s]\n", game->queens->array[i][j], i ? "blue" : "red");
+    for (uint pos = 0; pos < game->board->num_vertices; pos++)
+        cells[pos] = is_isolated(game->board, pos) ? EXPORT__BLOCKED : EXPORT__EMPTY;
 
-    fprintf(file, "}");
-    fclose(file);
+    // A queen surrounded by arrows is isolated too
+    for (uint player_id = 0; player_id < NUM_PLAYERS; player_id++)
+        for (uint queen_id = 0; queen_id < queens__get_nb_queens(game->queens); queen_id++)
+            if (game->queens->array[player_id][queen_id] < game->board->num_vertices)
+                cells[game->queens->array[player_id][queen_id]] = player_id ? EXPORT__QUEEN_2 : EXPORT__QUEEN_1;
 }
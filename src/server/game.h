@@ -7,6 +7,7 @@
 #define __GAME_H__
 
 #include "client_api.h"
+#include "latency.h"
 #include "shape.h"
 
 /**
@@ -28,13 +29,31 @@ enum player_n {
  * size is the size of the board.
  * starting_player is the player who starts the game.
  * board_shape is the shape of the board.
- * seed is the random seed used for the game.
+ * seed is the random seed used for the game, from which the opening, the starting player if undefined and the seeds of the clients are drawn.
+ * move_time is the number of seconds a player may spend on each move, 0 for no limit.
+ * game_time is the number of seconds a player may spend over the whole game, 0 for no limit.
+ * isolate_clients hosts each client in its own process if set, a crashing client then losing the game.
+ * client_memory is the number of megabytes an isolated client may allocate, 0 for no limit.
+ * init_time is the number of seconds an isolated client may spend on its initialization, 0 for no limit.
+ * ponder lets the clients defining ponder and ponderhit think while their opponent plays if set.
+ * opening_moves is the number of random moves played by the server before the clients are initialized.
+ * shape_path is the board file read when board_shape is SHAPE_MASK (see shape__init_from_file).
+ * board_cache is the directory of the board snapshots (see board_cache.h), NULL to keep the boards in memory only.
  */
 struct game_config {
     uint size;
     enum player_n starting_player;
     enum board_shape board_shape;
     int seed;
+    double move_time;
+    double game_time;
+    int isolate_clients;
+    uint client_memory;
+    double init_time;
+    int ponder;
+    uint opening_moves;
+    const char* board_cache;
+    const char* shape_path;
 };
 
 /**
@@ -99,6 +118,8 @@ void game__next_player(game game);
 /**
  * @brief Plays a turn for the current player.
  *
+ * The time spent by the client is measured, and a move played out of time loses the game like an invalid move.
+ *
  * @param game The game instance.
  */
 void game__play(game game);
@@ -121,6 +142,70 @@ enum player_n game__get_current_player(cgame game);
  */
 enum player_n game__get_winner(cgame game);
 
+/**
+ * @brief Determines if the game was lost by an invalid move.
+ * @param game The game instance.
+ * @return 1 if the loser played an invalid move or ran out of time, 0 otherwise.
+ */
+int game__is_forfeit(cgame game);
+
+/**
+ * @brief Gets the last move played on the board.
+ * @param game The game instance.
+ * @return The last valid move, the initial move if none was played yet.
+ */
+struct move_t game__get_previous_move(cgame game);
+
+/**
+ * @brief Gets the size of the board, which may differ from the configured one for some shapes.
+ * @param game The game instance.
+ * @return The size of the board.
+ */
+uint game__get_board_size(cgame game);
+
+/**
+ * @brief Gets the shape of the board.
+ * @param game The game instance.
+ * @return The shape of the board.
+ */
+enum board_shape game__get_board_shape(cgame game);
+
+/**
+ * @brief Gets the playable cells of a board read from a file.
+ * @param game The game instance.
+ * @return The cells of the board, row by row, 1 for a playable cell and 0 for a hole, NULL if the board has a built-in shape.
+ */
+const unsigned char* game__get_board_mask(cgame game);
+
+/**
+ * @brief Gets the random moves played by the server before the clients were initialized.
+ * @param game The game instance.
+ * @param nb_moves Where to write the number of moves, which may be less than the configured one if a player was blocked.
+ * @return The moves, played in turn by both players, the last one by the opponent of the first client to play.
+ */
+const struct move_t* game__get_opening(cgame game, uint* nb_moves);
+
+/**
+ * @brief Gets the random seed of the game, drawn from the clock if the configuration did not set one.
+ * @param game The game instance.
+ * @return The seed of the game.
+ */
+int game__get_seed(cgame game);
+
+/**
+ * @brief Gets the time spent by each player to play and by the server to check and play the moves.
+ * @param game The game instance.
+ * @return The histograms of the game, valid until the game is deleted.
+ */
+const struct latency_stats* game__get_stats(cgame game);
+
+/**
+ * @brief Gets the evaluation of the last move given by the client who played it.
+ * @param game The game instance, the current player being the one who played the last move.
+ * @return The value of the move from the point of view of its player, NAN if the client does not give any.
+ */
+double game__get_move_score(cgame game);
+
 /**
  * @brief Gets the name of a player.
  *
@@ -132,11 +217,11 @@ enum player_n game__get_winner(cgame game);
 const char* game__get_player_name(cgame game, enum player_n player_id);
 
 /**
- * @brief Exports the game to a file in DOT format.
+ * @brief Exports the content of each vertex of the board, to be rendered by the export module.
  *
  * @param game The game instance.
- * @param path The path of the file to export to.
+ * @param cells Where to write the enum export_cell of each of the size * size vertices.
  */
-void game__export(cgame game, char* path);
+void game__export(cgame game, unsigned char* cells);
 
 #endif // __GAME_H__
\ No newline at end of file
@@ -0,0 +1,116 @@
+#include <inttypes.h>
+#include <math.h>
+
+#include "latency.h"
+
+static const double percentiles[] = {50, 90, 99};
+#define NB_PERCENTILES (sizeof(percentiles) / sizeof(percentiles[0]))
+
+static uint bucket_of(double seconds) {
+    if (seconds < LATENCY__MIN_TIME)
+        return 0;
+    double bucket = 1 + floor(LATENCY__BUCKETS_PER_OCTAVE * log2(seconds / LATENCY__MIN_TIME));
+    return bucket >= LATENCY__NB_BUCKETS - 1 ? LATENCY__NB_BUCKETS - 1 : (uint)bucket;
+}
+
+static double bucket_upper_bound(uint bucket) {
+    return LATENCY__MIN_TIME * exp2((double)bucket / LATENCY__BUCKETS_PER_OCTAVE);
+}
+
+static void print_row(FILE* file, const char* label, const struct latency_histogram* histogram) {
+    double mean = histogram->nb_samples ? histogram->total / histogram->nb_samples : 0;
+    fprintf(file, "%-20.20s %10" PRIu64 " %12.1f", label, histogram->nb_samples, mean * 1e6);
+    for (uint i = 0; i < NB_PERCENTILES; i++)
+        fprintf(file, " %12.1f", latency__percentile(histogram, percentiles[i]) * 1e6);
+    fprintf(file, " %12.1f\n", histogram->max * 1e6);
+}
+
+static void print_json(FILE* file, const struct latency_histogram* histogram) {
+    double mean = histogram->nb_samples ? histogram->total / histogram->nb_samples : 0;
+    fprintf(file, "{\"samples\":%" PRIu64 ",\"mean\":%.9f", histogram->nb_samples, mean);
+    for (uint i = 0; i < NB_PERCENTILES; i++)
+        fprintf(file, ",\"p%.0f\":%.9f", percentiles[i], latency__percentile(histogram, percentiles[i]));
+    fprintf(file, ",\"max\":%.9f}", histogram->max);
+}
+
+/* **************************************************************** */
+
+void latency__add(struct latency_histogram* histogram, double seconds) {
+    if (seconds < 0)
+        seconds = 0;
+    histogram->counts[bucket_of(seconds)]++;
+    histogram->nb_samples++;
+    histogram->total += seconds;
+    if (seconds > histogram->max)
+        histogram->max = seconds;
+}
+
+void latency__merge(struct latency_histogram* dst, const struct latency_histogram* src) {
+    for (uint bucket = 0; bucket < LATENCY__NB_BUCKETS; bucket++)
+        dst->counts[bucket] += src->counts[bucket];
+    dst->nb_samples += src->nb_samples;
+    dst->total += src->total;
+    if (src->max > dst->max)
+        dst->max = src->max;
+}
+
+double latency__percentile(const struct latency_histogram* histogram, double percentile) {
+    if (!histogram->nb_samples)
+        return 0;
+
+    // The rank of the sample holding the percentile, from 1 to nb_samples
+    uint64_t rank = (uint64_t)ceil(percentile / 100 * histogram->nb_samples);
+    if (rank < 1)
+        rank = 1;
+
+    uint64_t count = 0;
+    for (uint bucket = 0; bucket < LATENCY__NB_BUCKETS; bucket++) {
+        count += histogram->counts[bucket];
+        if (count >= rank && bucket < LATENCY__NB_BUCKETS - 1) {
+            double bound = bucket_upper_bound(bucket);
+            return bound < histogram->max ? bound : histogram->max;
+        }
+    }
+    return histogram->max; // The last bucket has no upper bound
+}
+
+void latency__merge_stats(struct latency_stats* dst, const struct latency_stats* src) {
+    for (uint player_id = 0; player_id < NUM_PLAYERS; player_id++)
+        latency__merge(&dst->think[player_id], &src->think[player_id]);
+    latency__merge(&dst->check_move, &src->check_move);
+    latency__merge(&dst->board_update, &src->board_update);
+    latency__merge(&dst->is_over, &src->is_over);
+}
+
+void latency__print_stats(FILE* file, const struct latency_stats* stats, const char* names[NUM_PLAYERS], int as_json) {
+    if (!stats) handle_error(__func__, "Invalid parameter 'stats'", PROGRAM_EXIT);
+
+    if (as_json) {
+        fprintf(file, "{\"players\":[");
+        for (uint player_id = 0; player_id < NUM_PLAYERS; player_id++) {
+            fprintf(file, "%s{\"name\":", player_id ? "," : "");
+            print_json_string(file, names && names[player_id] ? names[player_id] : "");
+            fprintf(file, ",\"think\":");
+            print_json(file, &stats->think[player_id]);
+            fputc('}', file);
+        }
+        fprintf(file, "],\"server\":{\"check_move\":");
+        print_json(file, &stats->check_move);
+        fprintf(file, ",\"board_update\":");
+        print_json(file, &stats->board_update);
+        fprintf(file, ",\"is_over\":");
+        print_json(file, &stats->is_over);
+        fprintf(file, "}}\n");
+        return;
+    }
+
+    fprintf(file, "%-20s %10s %12s %12s %12s %12s %12s\n", "Time (us)", "samples", "mean", "p50", "p90", "p99", "max");
+    for (uint player_id = 0; player_id < NUM_PLAYERS; player_id++) {
+        char label[32];
+        snprintf(label, sizeof(label), "%u %s", player_id + 1, names && names[player_id] ? names[player_id] : "");
+        print_row(file, label, &stats->think[player_id]);
+    }
+    print_row(file, "check_move", &stats->check_move);
+    print_row(file, "board_update", &stats->board_update);
+    print_row(file, "game__is_over", &stats->is_over);
+}
@@ -0,0 +1,85 @@
+/**
+ * @file latency.h
+ * @brief This file contains the declarations of functions and data types used to measure the time spent by the clients and the server.
+ */
+
+#ifndef __LATENCY_H__
+#define __LATENCY_H__
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "player.h"
+#include "utils.h"
+
+#define LATENCY__MIN_TIME 1e-7      // The upper bound of the first bucket, in seconds
+#define LATENCY__BUCKETS_PER_OCTAVE 4 // Each bucket is 2^(1/4) times wider than the previous one, about 19%
+#define LATENCY__NB_BUCKETS 128     // Up to about 6 minutes, the last bucket holding any longer time
+
+/**
+ * @brief A histogram of durations with log-spaced buckets.
+ * counts[0] counts the durations below LATENCY__MIN_TIME, counts[i] those between
+ * LATENCY__MIN_TIME * 2^((i - 1) / LATENCY__BUCKETS_PER_OCTAVE) and the bound of the next bucket.
+ * nb_samples, total and max are exact.
+ */
+struct latency_histogram {
+    uint64_t counts[LATENCY__NB_BUCKETS];
+    uint64_t nb_samples;
+    double total;
+    double max;
+};
+
+/**
+ * @brief The histograms of a game or a tournament.
+ * think holds the time spent by each player in its play function.
+ * check_move, board_update and is_over hold the time spent by the server to check a move,
+ * to play it on the board and to check whether the game is over.
+ */
+struct latency_stats {
+    struct latency_histogram think[NUM_PLAYERS];
+    struct latency_histogram check_move;
+    struct latency_histogram board_update;
+    struct latency_histogram is_over;
+};
+
+/**
+ * @brief Adds a duration to a histogram.
+ * @param histogram The histogram.
+ * @param seconds The duration, in seconds.
+ */
+void latency__add(struct latency_histogram* histogram, double seconds);
+
+/**
+ * @brief Adds the durations of a histogram to another one.
+ * @param dst The histogram to add to.
+ * @param src The histogram to add.
+ */
+void latency__merge(struct latency_histogram* dst, const struct latency_histogram* src);
+
+/**
+ * @brief Estimates a percentile of a histogram.
+ *
+ * @param histogram The histogram.
+ * @param percentile The percentile, between 0 and 100.
+ * @return The upper bound of the bucket holding the percentile, at most the longest duration, 0 if the histogram is empty.
+ */
+double latency__percentile(const struct latency_histogram* histogram, double percentile);
+
+/**
+ * @brief Adds all the histograms of stats to those of another one.
+ * @param dst The stats to add to.
+ * @param src The stats to add.
+ */
+void latency__merge_stats(struct latency_stats* dst, const struct latency_stats* src);
+
+/**
+ * @brief Prints the number of samples, mean, p50, p90, p99 and max of each histogram of stats.
+ *
+ * @param file Where to print the report.
+ * @param stats The stats.
+ * @param names The names of the players.
+ * @param as_json Prints a JSON object with the times in seconds if set, a table with the times in microseconds otherwise.
+ */
+void latency__print_stats(FILE* file, const struct latency_stats* stats, const char* names[NUM_PLAYERS], int as_json);
+
+#endif // __LATENCY_H__
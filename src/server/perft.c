@@ -0,0 +1,242 @@
+#include <getopt.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bitboard.h"
+#include "graph.h"
+#include "move.h"
+#include "movegen.h"
+#include "player.h"
+#include "queens.h"
+#include "shape.h"
+#include "utils.h"
+
+#define PERFT__DEFAULT_DEPTH 2
+
+// The moves generated at each ply, grown on demand
+struct move_buffer {
+    struct move_t* moves;
+    size_t cap;
+};
+
+static uint size = SHAPE__DEFAULT_SIZE;
+static char board_shape = SHAPE__DEFAULT_SHAPE;
+static const char* shape_path = NULL;
+static uint max_depth = PERFT__DEFAULT_DEPTH;
+static uint starting_player = 0;
+static int compare = 0;
+
+static void usage(const char* command) {
+    printf("Usage: %s [-d depth] [-m size] [-t shape] [-p player] [-c]\n", command);
+    printf("Options:\n");
+    printf("\t-d : set the search depth [default: %d]\n", PERFT__DEFAULT_DEPTH);
+    printf("\t-m : set the game board size (minimum: %d) [default: %d]\n", 5, SHAPE__DEFAULT_SIZE);
+    printf("\t-t : set the game board shape (c: square, 8: eight, t: clover, d: donut, " SHAPE__FILE_PREFIX "path: read from a file) [default: c]\n");
+    printf("\t-p : set the player to move first (0 or 1) [default: 0]\n");
+    printf("\t-c : compare the counts with the can_reach_position reference and the bitboard generator\n");
+}
+
+static int parse_int_arg(const char* arg) {
+    char* end_ptr;
+    long value = strtol(arg, &end_ptr, 10);
+
+    if (*arg == '\0' || *end_ptr != '\0' || value < 0) {
+        handle_error(__func__, "Invalid argument", PROGRAM_EXIT);
+    }
+
+    return (int)value;
+}
+
+static void handle_args(int argc, char* argv[]) {
+    int opt;
+
+    while ((opt = getopt(argc, argv, "d:m:t:p:c")) != -1) {
+        switch (opt) {
+            case 'd':
+                max_depth = parse_int_arg(optarg);
+                break;
+            case 'm':
+                size = parse_int_arg(optarg);
+                break;
+            case 't':
+                shape_path = shape__file_path(optarg);
+                board_shape = shape_path ? SHAPE_MASK : optarg[0];
+                break;
+            case 'p':
+                starting_player = parse_int_arg(optarg);
+                if (starting_player >= NUM_PLAYERS)
+                    handle_error(__func__, "Invalid player", PROGRAM_EXIT);
+                break;
+            case 'c':
+                compare = 1;
+                break;
+            default:
+                usage(argv[0]);
+                exit(EXIT_FAILURE);
+        }
+    }
+
+    if (optind != argc) {
+        usage(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+}
+
+// Makes room in a buffer for count moves, keeping none of its moves
+static void move_buffer__reserve(struct move_buffer* buffer, size_t count) {
+    if (count <= buffer->cap)
+        return;
+    free(buffer->moves);
+    buffer->moves = malloc(count * sizeof(struct move_t));
+    if (!buffer->moves)
+        handle_error(__func__, "Not enough memory for 'moves'", PROGRAM_EXIT);
+    buffer->cap = count;
+}
+
+// Counts the leaves at depth with the shared move generator, the last ply being only counted
+static uint64_t perft_movegen(struct graph_t* board, struct queens_t* queens, uint player_id, uint depth, struct move_buffer* buffers) {
+    if (depth == 0)
+        return 1;
+    if (depth == 1)
+        return movegen__count(board, queens, player_id);
+
+    struct move_buffer* buffer = &buffers[depth];
+    size_t count = movegen__generate(board, queens, player_id, buffer->moves, buffer->cap);
+    if (count > buffer->cap) {
+        move_buffer__reserve(buffer, count);
+        movegen__generate(board, queens, player_id, buffer->moves, buffer->cap);
+    }
+
+    uint64_t nodes = 0;
+    struct move_undo_t undo;
+    for (size_t i = 0; i < count; i++) {
+        move__make(board, queens, player_id, buffer->moves[i], &undo);
+        nodes += perft_movegen(board, queens, player_id ^ 1, depth - 1, buffers);
+        move__unmake(board, queens, &undo);
+    }
+    return nodes;
+}
+
+// Counts the leaves at depth on a bitboard, copied before each move rather than unmade
+static uint64_t perft_bitboard(struct bitboard_t* bb, uint player_id, uint depth, struct move_buffer* buffers) {
+    if (depth == 0)
+        return 1;
+    if (depth == 1)
+        return bitboard__count(bb, player_id);
+
+    struct move_buffer* buffer = &buffers[depth];
+    size_t count = bitboard__generate(bb, player_id, buffer->moves, buffer->cap);
+    if (count > buffer->cap) {
+        move_buffer__reserve(buffer, count);
+        bitboard__generate(bb, player_id, buffer->moves, buffer->cap);
+    }
+
+    uint64_t nodes = 0;
+    for (size_t i = 0; i < count; i++) {
+        struct bitboard_t child = *bb;
+        bitboard__play(&child, player_id, buffer->moves[i]);
+        nodes += perft_bitboard(&child, player_id ^ 1, depth - 1, buffers);
+    }
+    return nodes;
+}
+
+// Counts the leaves at depth by trying every move with can_reach_position
+static uint64_t perft_reference(struct graph_t* board, struct queens_t* queens, uint player_id, uint depth) {
+    if (depth == 0)
+        return 1;
+
+    uint64_t nodes = 0;
+    struct move_undo_t undo;
+    for (uint queen_id = 0; queen_id < queens->nb_queens; queen_id++) {
+        uint queen_src = queens->array[player_id][queen_id];
+        for (uint queen_dst = 0; queen_dst < board->num_vertices; queen_dst++) {
+            if (!can_reach_position(board, queens, queen_src, queen_dst))
+                continue;
+            for (uint arrow_dst = 0; arrow_dst < board->num_vertices; arrow_dst++) {
+                struct move_t move = {queen_src, queen_dst, arrow_dst};
+                if (move__check(board, queens, player_id, move) != MOVE_REGULAR)
+                    continue;
+                if (depth == 1) {
+                    nodes++;
+                    continue;
+                }
+                move__make(board, queens, player_id, move, &undo);
+                nodes += perft_reference(board, queens, player_id ^ 1, depth - 1);
+                move__unmake(board, queens, &undo);
+            }
+        }
+    }
+    return nodes;
+}
+
+int main(int argc, char* argv[]) {
+    handle_args(argc, argv);
+
+    struct shape_t* shape = shape__new();
+    struct graph_t* board = graph__new();
+    struct queens_t* queens = queens__new();
+
+    if (shape_path) {
+        if (shape__init_from_file(shape, shape_path))
+            handle_error(__func__, "Could not read the board file", PROGRAM_EXIT);
+    } else
+        shape__init(shape, size, board_shape);
+    shape__build_graph(shape, board);
+    queens__alloc(queens, queens__default_count(shape__get_size(shape)));
+    queens__init(queens, shape__get_size(shape));
+
+    struct move_buffer* buffers = calloc(max_depth + 1, sizeof(struct move_buffer));
+    if (!buffers)
+        handle_error(__func__, "Not enough memory for 'buffers'", PROGRAM_EXIT);
+
+    // The bitboard only holds square boards up to BITBOARD__MAX_SIZE cells wide
+    struct bitboard_t* bb = NULL;
+    struct move_buffer* bb_buffers = NULL;
+    if (compare && bitboard__is_supported(board->num_vertices)) {
+        bb = bitboard__new();
+        bitboard__init(bb, board, queens);
+        bb_buffers = calloc(max_depth + 1, sizeof(struct move_buffer));
+        if (!bb_buffers)
+            handle_error(__func__, "Not enough memory for 'bb_buffers'", PROGRAM_EXIT);
+    }
+
+    int mismatch = 0;
+    printf("%-6s %15s %10s %15s%s\n", "depth", "nodes", "time (s)", "nodes/s", compare ? "       reference        bitboard" : "");
+    for (uint depth = 1; depth <= max_depth; depth++) {
+        double start = get_monotonic_time();
+        uint64_t nodes = perft_movegen(board, queens, starting_player, depth, buffers);
+        double elapsed = get_monotonic_time() - start;
+        printf("%-6u %15" PRIu64 " %10.3f %15.0f", depth, nodes, elapsed, elapsed > 0 ? nodes / elapsed : 0);
+
+        if (compare) {
+            uint64_t reference = perft_reference(board, queens, starting_player, depth);
+            int differs = reference != nodes;
+            printf(" %15" PRIu64, reference);
+            if (bb) {
+                uint64_t bb_nodes = perft_bitboard(bb, starting_player, depth, bb_buffers);
+                printf(" %15" PRIu64, bb_nodes);
+                differs |= bb_nodes != nodes;
+            } else
+                printf(" %15s", "-");
+            printf("%s", differs ? " MISMATCH" : "");
+            mismatch |= differs;
+        }
+        printf("\n");
+    }
+
+    for (uint depth = 0; depth <= max_depth; depth++) {
+        free(buffers[depth].moves);
+        if (bb_buffers)
+            free(bb_buffers[depth].moves);
+    }
+    free(buffers);
+    free(bb_buffers);
+    if (bb)
+        bitboard__free(bb);
+    queens__free(queens);
+    graph__free(board);
+    shape__delete(shape);
+
+    return mismatch ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,389 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "board_cache.h"
+#include "record.h"
+#include "shape.h"
+
+#define RECORD__VERSION 2
+#define RECORD__BUFFER_SIZE 65536
+
+static const char header_magic[4] = {'A', 'M', 'Z', 'R'};
+static const char end_magic[4] = {'A', 'M', 'Z', 'E'};
+
+// The result of the game, written after the end marker
+struct record_footer {
+    int32_t winner;
+    uint32_t forfeit;
+    uint32_t nb_moves;
+    uint32_t nb_checkpoints;
+    uint32_t interval;
+};
+
+struct record_writer {
+    FILE* file;
+    char* buffer;
+    uint coord_size;
+    uint player_id;
+    uint nb_moves;
+    struct queens_t* queens; // The queens after the moves written so far, to fill the checkpoints
+    uint* checkpoints;
+    uint nb_checkpoints;
+    uint checkpoints_cap;
+    int error;
+};
+
+// The coordinates fit on 2 bytes on any board of at most 255x255 vertices
+static uint coord_size_for(uint size) {
+    return size * size <= UINT16_MAX ? sizeof(uint16_t) : sizeof(uint32_t);
+}
+
+static void pack_move(struct move_t move, uint coord_size, unsigned char* out) {
+    uint coords[3] = {move.queen_src, move.queen_dst, move.arrow_dst};
+    for (uint i = 0; i < 3; i++) {
+        if (coord_size == sizeof(uint16_t)) {
+            uint16_t coord = coords[i];
+            memcpy(out + i * coord_size, &coord, coord_size);
+        } else {
+            uint32_t coord = coords[i];
+            memcpy(out + i * coord_size, &coord, coord_size);
+        }
+    }
+}
+
+static struct move_t unpack_move(const unsigned char* in, uint coord_size) {
+    uint coords[3];
+    for (uint i = 0; i < 3; i++) {
+        if (coord_size == sizeof(uint16_t)) {
+            uint16_t coord;
+            memcpy(&coord, in + i * coord_size, coord_size);
+            coords[i] = coord;
+        } else {
+            uint32_t coord;
+            memcpy(&coord, in + i * coord_size, coord_size);
+            coords[i] = coord;
+        }
+    }
+    return (struct move_t){coords[0], coords[1], coords[2]};
+}
+
+static int is_end_marker(const unsigned char* in, uint coord_size) {
+    for (uint i = 0; i < 3 * coord_size; i++)
+        if (in[i] != UCHAR_MAX)
+            return 0;
+    return 1;
+}
+
+// The playable cells of a board read from a file are stored on one bit each
+static size_t mask_bytes_for(uint size) {
+    return ((size_t)size * size + 7) / 8;
+}
+
+// The moves are shot on the board without any check when seeking, so they must at least stay on it
+static int is_on_board(const struct record_header* header, struct move_t move) {
+    uint num_vertices = header->size * header->size;
+    return move.queen_src < num_vertices && move.queen_dst < num_vertices && move.arrow_dst < num_vertices;
+}
+
+static void write_bytes(record_writer writer, const void* data, size_t size) {
+    if (fwrite(data, 1, size, writer->file) != size)
+        writer->error = 1;
+}
+
+static void save_checkpoint(record_writer writer) {
+    if (writer->nb_checkpoints == writer->checkpoints_cap) {
+        writer->checkpoints_cap = writer->checkpoints_cap ? 2 * writer->checkpoints_cap : 16;
+        size_t block = NUM_PLAYERS * writer->queens->nb_queens;
+        writer->checkpoints = realloc(writer->checkpoints, writer->checkpoints_cap * block * sizeof(uint));
+        if (!writer->checkpoints)
+            handle_error(__func__, "Not enough memory for 'checkpoints'", PROGRAM_EXIT);
+    }
+
+    uint* checkpoint = writer->checkpoints + writer->nb_checkpoints * NUM_PLAYERS * writer->queens->nb_queens;
+    for (uint player_id = 0; player_id < NUM_PLAYERS; player_id++)
+        memcpy(checkpoint + player_id * writer->queens->nb_queens, writer->queens->array[player_id], writer->queens->nb_queens * sizeof(uint));
+    writer->nb_checkpoints++;
+}
+
+// Sets the queens of both players from a checkpoint, the index being rebuilt since the queens may swap their positions
+static void load_checkpoint(const struct record_t* record, struct queens_t* queens, uint checkpoint_id) {
+    const uint* checkpoint = record->checkpoints + checkpoint_id * NUM_PLAYERS * record->header.nb_queens;
+    for (uint player_id = 0; player_id < NUM_PLAYERS; player_id++)
+        memcpy(queens->array[player_id], checkpoint + player_id * record->header.nb_queens, record->header.nb_queens * sizeof(uint));
+
+    queens__build_index(queens, queens->num_vertices);
+    queens__rehash(queens);
+}
+
+/* **************************************************************** */
+
+record_writer record__open(const char* path, char board_shape, uint size, const unsigned char* mask, int seed, uint starting_player, uint nb_opening_moves,
+                           const char* names[NUM_PLAYERS]) {
+    if (!path) handle_error(__func__, "Invalid parameter 'path'", PROGRAM_EXIT);
+    if (starting_player >= NUM_PLAYERS) handle_error(__func__, "Invalid parameter 'starting_player'", PROGRAM_EXIT);
+    if ((board_shape == SHAPE_MASK) != (mask != NULL)) handle_error(__func__, "Invalid parameter 'mask'", PROGRAM_EXIT);
+
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        handle_error(__func__, "Could not create the record", PROGRAM_CONTINUE);
+        return NULL;
+    }
+
+    record_writer writer = calloc(1, sizeof(struct record_writer));
+    if (!writer)
+        handle_error(__func__, "Not enough memory for 'writer'", PROGRAM_EXIT);
+    writer->buffer = malloc(RECORD__BUFFER_SIZE);
+    if (!writer->buffer)
+        handle_error(__func__, "Not enough memory for 'buffer'", PROGRAM_EXIT);
+
+    // The moves are only written to the file once the buffer is full
+    writer->file = file;
+    setvbuf(writer->file, writer->buffer, _IOFBF, RECORD__BUFFER_SIZE);
+    writer->coord_size = coord_size_for(size);
+    writer->player_id = starting_player;
+    writer->queens = queens__new();
+    queens__alloc(writer->queens, queens__default_count(size));
+    queens__init(writer->queens, size);
+
+    struct record_header header = {0};
+    memcpy(header.magic, header_magic, sizeof(header_magic));
+    header.version = RECORD__VERSION;
+    header.board_shape = board_shape;
+    header.size = size;
+    header.seed = seed;
+    header.starting_player = starting_player;
+    header.nb_queens = writer->queens->nb_queens;
+    header.coord_size = writer->coord_size;
+    header.nb_opening_moves = nb_opening_moves;
+    for (uint player_id = 0; player_id < NUM_PLAYERS; player_id++)
+        if (names && names[player_id])
+            strncpy(header.names[player_id], names[player_id], RECORD__NAME_SIZE - 1);
+    write_bytes(writer, &header, sizeof(header));
+
+    if (mask) {
+        unsigned char* packed = calloc(mask_bytes_for(size), 1);
+        if (!packed)
+            handle_error(__func__, "Not enough memory for 'packed'", PROGRAM_EXIT);
+        for (size_t k = 0; k < (size_t)size * size; k++)
+            packed[k / 8] |= (mask[k] != 0) << (k % 8);
+        write_bytes(writer, packed, mask_bytes_for(size));
+        free(packed);
+    }
+
+    return writer;
+}
+
+void record__write_move(record_writer writer, struct move_t move) {
+    if (!writer) handle_error(__func__, "Invalid parameter 'writer'", PROGRAM_EXIT);
+
+    unsigned char packed[3 * sizeof(uint32_t)];
+    pack_move(move, writer->coord_size, packed);
+    write_bytes(writer, packed, 3 * writer->coord_size);
+
+    move_queen(writer->queens, writer->player_id, move);
+    writer->player_id ^= 1;
+    writer->nb_moves++;
+    if (writer->nb_moves % RECORD__CHECKPOINT_INTERVAL == 0)
+        save_checkpoint(writer);
+}
+
+int record__close(record_writer writer, int winner, int forfeit) {
+    if (!writer) handle_error(__func__, "Invalid parameter 'writer'", PROGRAM_EXIT);
+
+    unsigned char end_marker[3 * sizeof(uint32_t)];
+    memset(end_marker, UCHAR_MAX, sizeof(end_marker));
+    write_bytes(writer, end_marker, 3 * writer->coord_size);
+
+    struct record_footer footer = {winner, forfeit != 0, writer->nb_moves, writer->nb_checkpoints, RECORD__CHECKPOINT_INTERVAL};
+    write_bytes(writer, &footer, sizeof(footer));
+    for (uint i = 0; i < writer->nb_checkpoints * NUM_PLAYERS * writer->queens->nb_queens; i++) {
+        uint32_t pos = writer->checkpoints[i];
+        write_bytes(writer, &pos, sizeof(pos));
+    }
+    write_bytes(writer, end_magic, sizeof(end_magic));
+
+    if (fclose(writer->file))
+        writer->error = 1;
+    int error = writer->error;
+
+    queens__free(writer->queens);
+    free(writer->checkpoints);
+    free(writer->buffer);
+    free(writer);
+
+    if (error)
+        handle_error(__func__, "Could not write the record", PROGRAM_CONTINUE);
+    return error ? -1 : 0;
+}
+
+struct record_t* record__load(const char* path) {
+    if (!path) handle_error(__func__, "Invalid parameter 'path'", PROGRAM_EXIT);
+
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        handle_error(__func__, "Could not open the record", PROGRAM_CONTINUE);
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long file_size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    unsigned char* data = file_size > 0 ? malloc(file_size) : NULL;
+    size_t size = data ? fread(data, 1, file_size, file) : 0;
+    fclose(file);
+
+    struct record_header header;
+    if (size < sizeof(header)) {
+        free(data);
+        handle_error(__func__, "Not a record", PROGRAM_CONTINUE);
+        return NULL;
+    }
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, header_magic, sizeof(header_magic)) || header.version != RECORD__VERSION ||
+        (header.coord_size != sizeof(uint16_t) && header.coord_size != sizeof(uint32_t)) || header.starting_player >= NUM_PLAYERS) {
+        free(data);
+        handle_error(__func__, "Not a record", PROGRAM_CONTINUE);
+        return NULL;
+    }
+
+    struct record_t* record = calloc(1, sizeof(struct record_t));
+    if (!record)
+        handle_error(__func__, "Not enough memory for 'record'", PROGRAM_EXIT);
+    record->header = header;
+    record->header.names[0][RECORD__NAME_SIZE - 1] = '\0';
+    record->header.names[1][RECORD__NAME_SIZE - 1] = '\0';
+    record->winner = -1;
+    record->interval = RECORD__CHECKPOINT_INTERVAL;
+    size_t offset = sizeof(header);
+
+    if (header.board_shape == SHAPE_MASK) {
+        if (header.size < 5 || header.size > SHAPE__MAX_MASK_SIZE || size - offset < mask_bytes_for(header.size)) {
+            free(record);
+            free(data);
+            handle_error(__func__, "Not a record", PROGRAM_CONTINUE);
+            return NULL;
+        }
+        record->mask = malloc((size_t)header.size * header.size);
+        if (!record->mask)
+            handle_error(__func__, "Not enough memory for 'mask'", PROGRAM_EXIT);
+        for (size_t k = 0; k < (size_t)header.size * header.size; k++)
+            record->mask[k] = (data[offset + k / 8] >> (k % 8)) & 1;
+        offset += mask_bytes_for(header.size);
+    }
+
+    // The moves go on until the end marker, or until the end of the file if the writer was not closed
+    size_t move_size = 3 * header.coord_size;
+    size_t max_moves = (size - offset) / move_size;
+    record->moves = malloc((max_moves ? max_moves : 1) * sizeof(struct move_t));
+    if (!record->moves)
+        handle_error(__func__, "Not enough memory for 'moves'", PROGRAM_EXIT);
+
+    int has_end_marker = 0;
+    while (offset + move_size <= size) {
+        if (is_end_marker(data + offset, header.coord_size)) {
+            has_end_marker = 1;
+            offset += move_size;
+            break;
+        }
+        struct move_t move = unpack_move(data + offset, header.coord_size);
+        if (!is_on_board(&header, move))
+            break;
+        record->moves[record->nb_moves++] = move;
+        offset += move_size;
+    }
+
+    struct record_footer footer;
+    if (has_end_marker && offset + sizeof(footer) <= size) {
+        memcpy(&footer, data + offset, sizeof(footer));
+        offset += sizeof(footer);
+
+        size_t nb_positions = (size_t)footer.nb_checkpoints * NUM_PLAYERS * header.nb_queens;
+        if (footer.nb_moves == record->nb_moves && footer.interval > 0 && footer.nb_checkpoints <= record->nb_moves / footer.interval &&
+            offset + nb_positions * sizeof(uint32_t) + sizeof(end_magic) == size &&
+            !memcmp(data + offset + nb_positions * sizeof(uint32_t), end_magic, sizeof(end_magic))) {
+            record->checkpoints = malloc((nb_positions ? nb_positions : 1) * sizeof(uint));
+            if (!record->checkpoints)
+                handle_error(__func__, "Not enough memory for 'checkpoints'", PROGRAM_EXIT);
+            int is_valid = 1;
+            for (size_t i = 0; i < nb_positions; i++) {
+                uint32_t pos;
+                memcpy(&pos, data + offset + i * sizeof(pos), sizeof(pos));
+                record->checkpoints[i] = pos;
+                is_valid &= pos < header.size * header.size;
+            }
+            record->is_complete = is_valid;
+            record->winner = footer.winner;
+            record->forfeit = footer.forfeit;
+            record->interval = footer.interval;
+            record->nb_checkpoints = footer.nb_checkpoints;
+        }
+    }
+
+    free(data);
+    return record;
+}
+
+void record__free(struct record_t* record) {
+    if (!record)
+        return;
+    free(record->mask);
+    free(record->moves);
+    free(record->checkpoints);
+    free(record);
+}
+
+void record__init_position(const struct record_t* record, struct graph_t* board, struct queens_t* queens) {
+    if (!record) handle_error(__func__, "Invalid parameter 'record'", PROGRAM_EXIT);
+
+    struct shape_t* shape = shape__new();
+    if (record->mask) {
+        if (shape__init_from_mask(shape, record->header.size, record->mask))
+            handle_error(__func__, "Invalid board size in the record", PROGRAM_EXIT);
+    } else
+        shape__init(shape, record->header.size, record->header.board_shape);
+    if (shape__get_size(shape) != record->header.size)
+        handle_error(__func__, "Invalid board size in the record", PROGRAM_EXIT);
+
+    board_cache__init_graph(shape, board, NULL);
+    shape__delete(shape);
+
+    queens__alloc(queens, record->header.nb_queens);
+    queens__init(queens, record->header.size);
+}
+
+uint record__replay(const struct record_t* record, struct graph_t* board, struct queens_t* queens, uint turn) {
+    if (!record) handle_error(__func__, "Invalid parameter 'record'", PROGRAM_EXIT);
+    if (turn > record->nb_moves) turn = record->nb_moves;
+
+    for (uint i = 0; i < turn; i++) {
+        uint player_id = record->header.starting_player ^ (i & 1);
+        struct move_t move = record->moves[i];
+        if (move__check(board, queens, player_id, move) != MOVE_REGULAR)
+            return i;
+        move_queen(queens, player_id, move);
+        graph__disconnect(board, move.arrow_dst);
+    }
+    return turn;
+}
+
+uint record__seek(const struct record_t* record, struct graph_t* board, struct queens_t* queens, uint turn) {
+    if (!record) handle_error(__func__, "Invalid parameter 'record'", PROGRAM_EXIT);
+    if (turn > record->nb_moves) turn = record->nb_moves;
+
+    uint nb_checkpoints = turn / record->interval;
+    if (nb_checkpoints > record->nb_checkpoints)
+        nb_checkpoints = record->nb_checkpoints;
+
+    uint start = nb_checkpoints * record->interval;
+    if (nb_checkpoints) {
+        for (uint i = 0; i < start; i++)
+            graph__disconnect(board, record->moves[i].arrow_dst);
+        load_checkpoint(record, queens, nb_checkpoints - 1);
+    }
+
+    struct record_t remaining = *record;
+    remaining.moves = record->moves + start;
+    remaining.nb_moves = record->nb_moves - start;
+    remaining.header.starting_player = record->header.starting_player ^ (start & 1);
+    return start + record__replay(&remaining, board, queens, turn - start);
+}
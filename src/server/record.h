@@ -0,0 +1,156 @@
+/**
+ * @file record.h
+ * @brief This file contains the declarations of functions and data types used to write and replay binary game records.
+ *
+ * A record starts with a header describing the game, followed on a board read from a file by its playable cells,
+ * one bit per cell, then by the valid moves packed on 2 or 4 bytes per
+ * coordinate. When the game is over, an end marker, the result of the game and the positions of the queens every
+ * RECORD__CHECKPOINT_INTERVAL moves are appended, so that a replay can seek to any turn without validating every
+ * move before it. A record whose writer did not finish still holds every move written before, without checkpoints.
+ * The integers are stored in the byte order of the machine.
+ */
+
+#ifndef __RECORD_H__
+#define __RECORD_H__
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "graph.h"
+#include "move.h"
+#include "player.h"
+#include "queens.h"
+
+#define RECORD__NAME_SIZE 64
+#define RECORD__CHECKPOINT_INTERVAL 32
+
+/**
+ * @brief A struct representing the header of a record.
+ * board_shape and size are the shape and the size of the board.
+ * seed is the random seed of the game.
+ * starting_player is the player who played the first move.
+ * nb_queens is the number of queens per player.
+ * nb_opening_moves is the number of first moves played at random by the server before the clients.
+ * names are the names of the players.
+ */
+struct record_header {
+    char magic[4];
+    uint32_t version;
+    uint32_t board_shape;
+    uint32_t size;
+    int32_t seed;
+    uint32_t starting_player;
+    uint32_t nb_queens;
+    uint32_t coord_size; // The number of bytes of each coordinate of the moves
+    uint32_t nb_opening_moves;
+    char names[NUM_PLAYERS][RECORD__NAME_SIZE];
+};
+
+/**
+ * @brief The structure pointer used to write a record.
+ */
+typedef struct record_writer* record_writer;
+
+/**
+ * @brief A struct representing a loaded record.
+ * moves are the nb_moves valid moves of the game, the player of move i being starting_player ^ (i & 1).
+ * is_complete is set if the writer was closed, in which case winner and forfeit are the result of the game,
+ * and checkpoints holds the queens of both players after every interval moves.
+ */
+struct record_t {
+    struct record_header header;
+    unsigned char* mask; // The playable cells of a board read from a file, as given by shape__get_mask, NULL for the built-in shapes
+    struct move_t* moves;
+    uint nb_moves;
+    int is_complete;
+    int winner;
+    int forfeit;
+    uint interval;
+    uint nb_checkpoints;
+    uint* checkpoints; // nb_checkpoints blocks of NUM_PLAYERS * nb_queens positions
+};
+
+/**
+ * @brief Creates a record and writes its header.
+ *
+ * @param path The path of the record file.
+ * @param board_shape The shape of the board.
+ * @param size The size of the board.
+ * @param mask The playable cells of a board read from a file, as given by shape__get_mask, NULL for the built-in shapes.
+ * @param seed The random seed of the game.
+ * @param starting_player The player who plays the first move.
+ * @param nb_opening_moves The number of first moves played at random by the server, to be written like the others.
+ * @param names The names of the players.
+ * @return The writer of the record, NULL if the file could not be created.
+ */
+record_writer record__open(const char* path, char board_shape, uint size, const unsigned char* mask, int seed, uint starting_player, uint nb_opening_moves,
+                           const char* names[NUM_PLAYERS]);
+
+/**
+ * @brief Appends a valid move to a record.
+ *
+ * The move is buffered and only written when the buffer is full, so that the game is not slowed down by the file.
+ *
+ * @param writer The writer of the record.
+ * @param move The move, played by the player following the one of the previous move.
+ */
+void record__write_move(record_writer writer, struct move_t move);
+
+/**
+ * @brief Writes the result of the game and the checkpoints, then closes the record.
+ *
+ * @param writer The writer of the record.
+ * @param winner The winner of the game.
+ * @param forfeit Whether the game ended by an invalid move.
+ * @return 0 if every write succeeded, -1 otherwise.
+ */
+int record__close(record_writer writer, int winner, int forfeit);
+
+/**
+ * @brief Loads a record in memory.
+ * @param path The path of the record file.
+ * @return The record, NULL if the file could not be read or is not a record.
+ */
+struct record_t* record__load(const char* path);
+
+/**
+ * @brief Frees a record loaded by record__load.
+ * @param record The record.
+ */
+void record__free(struct record_t* record);
+
+/**
+ * @brief Builds the initial position of a record.
+ *
+ * @param record The record.
+ * @param board A new graph, initialized and compressed.
+ * @param queens A new queens structure, allocated and initialized with an index.
+ */
+void record__init_position(const struct record_t* record, struct graph_t* board, struct queens_t* queens);
+
+/**
+ * @brief Replays the first moves of a record from the initial position, checking each of them.
+ *
+ * @param record The record.
+ * @param board The board of the initial position, updated with the moves.
+ * @param queens The queens of the initial position, updated with the moves.
+ * @param turn The number of moves to replay, at most nb_moves.
+ * @return The number of moves replayed, less than turn if a move was invalid.
+ */
+uint record__replay(const struct record_t* record, struct graph_t* board, struct queens_t* queens, uint turn);
+
+/**
+ * @brief Plays the first moves of a record from the initial position, using the last checkpoint before turn.
+ *
+ * The arrows before the checkpoint are only shot and the queens are taken from the checkpoint,
+ * the moves after it being checked as in record__replay.
+ *
+ * @param record The record.
+ * @param board The board of the initial position, updated with the moves.
+ * @param queens The queens of the initial position, updated with the moves.
+ * @param turn The number of moves to play, at most nb_moves.
+ * @return The number of moves played, less than turn if a move after the checkpoint was invalid.
+ */
+uint record__seek(const struct record_t* record, struct graph_t* board, struct queens_t* queens, uint turn);
+
+#endif // __RECORD_H__
@@ -0,0 +1,116 @@
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "graph.h"
+#include "queens.h"
+#include "record.h"
+#include "utils.h"
+
+static int seek_turn = -1;
+
+static void usage(const char* command) {
+    printf("Usage: %s [-n turn] record\n", command);
+    printf("Options:\n");
+    printf("\t-n : print the board after the given number of moves, reached from the closest checkpoint\n");
+}
+
+static int parse_int_arg(const char* arg) {
+    char* end_ptr;
+    long value = strtol(arg, &end_ptr, 10);
+
+    if (*arg == '\0' || *end_ptr != '\0' || value < 0) {
+        handle_error(__func__, "Invalid argument", PROGRAM_EXIT);
+    }
+
+    return (int)value;
+}
+
+static void handle_args(int argc, char* argv[]) {
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:")) != -1) {
+        switch (opt) {
+            case 'n':
+                seek_turn = parse_int_arg(optarg);
+                break;
+            default:
+                usage(argv[0]);
+                exit(EXIT_FAILURE);
+        }
+    }
+
+    if (optind + 1 != argc) {
+        usage(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+}
+
+// Prints the board row by row: '0' and '1' for the queens, '#' for the arrows and the holes of the shape
+static void print_board(struct graph_t* board, struct queens_t* queens, uint size) {
+    for (uint y = 0; y < size; y++) {
+        for (uint x = 0; x < size; x++) {
+            uint pos = y * size + x;
+            char c = '.';
+            if (queens->owner[pos] != QUEENS__NO_OWNER)
+                c = '0' + queens->owner[pos];
+            else if (is_isolated(board, pos))
+                c = '#';
+            printf("%c%s", c, x + 1 < size ? " " : "\n");
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    handle_args(argc, argv);
+
+    struct record_t* record = record__load(argv[optind]);
+    if (!record)
+        return EXIT_FAILURE;
+
+    printf("Board: %c %ux%u, seed %d, %u queens per player\n", record->header.board_shape, record->header.size, record->header.size,
+           record->header.seed, record->header.nb_queens);
+    printf("Players: %s (0) against %s (1), player %u started\n", record->header.names[0], record->header.names[1], record->header.starting_player);
+    if (record->header.nb_opening_moves)
+        printf("Opening: the first %u moves were played at random by the server\n", record->header.nb_opening_moves);
+    if (record->is_complete)
+        printf("Result: %u moves, player %d won%s\n", record->nb_moves, record->winner, record->forfeit ? " by forfeit" : "");
+    else
+        printf("Result: %u moves, the record was not closed\n", record->nb_moves);
+
+    struct graph_t* board = graph__new();
+    struct queens_t* queens = queens__new();
+    int status = EXIT_SUCCESS;
+
+    if (seek_turn < 0) {
+        record__init_position(record, board, queens);
+        double start = get_monotonic_time();
+        uint nb_valid = record__replay(record, board, queens, record->nb_moves);
+        double elapsed = get_monotonic_time() - start;
+
+        printf("Replay: %u moves checked in %.6f s (%.0f moves/s)\n", nb_valid, elapsed, elapsed > 0 ? nb_valid / elapsed : 0);
+        if (nb_valid != record->nb_moves) {
+            printf("Move %u is invalid\n", nb_valid);
+            status = EXIT_FAILURE;
+        }
+    } else {
+        uint turn = (uint)seek_turn > record->nb_moves ? record->nb_moves : (uint)seek_turn;
+        record__init_position(record, board, queens);
+        double start = get_monotonic_time();
+        uint nb_valid = record__seek(record, board, queens, turn);
+        double elapsed = get_monotonic_time() - start;
+
+        printf("Seek: turn %u reached in %.6f s\n", nb_valid, elapsed);
+        if (nb_valid != turn) {
+            printf("Move %u is invalid\n", nb_valid);
+            status = EXIT_FAILURE;
+        }
+        print_board(board, queens, record->header.size);
+    }
+
+    queens__free(queens);
+    graph__free(board);
+    record__free(record);
+
+    return status;
+}
@@ -5,17 +5,39 @@
 
 #include "export.h"
 #include "game.h"
+#include "dataset.h"
+#include "record.h"
+#include "tournament.h"
 #include "utils.h"
 
 static int export = 0;
+static const char* record_path = NULL;
+static const char* log_path = NULL;
+static const char* report = NULL;
+static struct tournament_config tournament = {0, 1, 0, NULL};
 
 static void usage(const char* command) {
-    printf("Usage: %s [-s seed] [-e] [-m size] [-t shape] player1 player2\n", command);
+    printf("Usage: %s [-s seed] [-e] [-m size] [-t shape] [-T seconds] [-G seconds] [-i] [-M megabytes] [-I seconds] [-p] [-O moves] [-n games] [-j workers] [-a] [-r file] [-x file] [-P format] [-D file] [-C directory] player1 player2\n", command);
     printf("Options:\n");
     printf("\t-s : set the game seed [default: random]\n");
-    printf("\t-e : enable game export\n");
+    printf("\t-e : export the game to PNG images of each turn and an animated PNG in %s\n", EXPORT_DIR);
     printf("\t-m : set the game board size (minimum: %d) [default: %d]\n", 5, 8);
-    printf("\t-t : set the game board shape (c: square, 8: eight, t: clover, d: donut) [default: c]\n");
+    printf("\t-t : set the game board shape (c: square, 8: eight, t: clover, d: donut, " SHAPE__FILE_PREFIX "path: read from a file) [default: c]\n");
+    printf("\t-T : set the time a player may spend on each move, in seconds [default: unlimited]\n");
+    printf("\t-G : set the time a player may spend over the whole game, in seconds [default: unlimited]\n");
+    printf("\t-i : run each client in its own process, a client crashing or hanging losing the game\n");
+    printf("\t-M : set the memory each client run with -i may allocate, in megabytes [default: unlimited]\n");
+    printf("\t-I : set the time each client run with -i may spend on its initialization, in seconds [default: unlimited]\n");
+    printf("\t-p : let the clients which can think on their opponent's time do it, on a thread of their own\n");
+    printf("\t-O : play random moves from the initial position before the clients start playing [default: 0]\n");
+    printf("\t-n : play a tournament of n games, the seed of each game being derived from the game seed\n");
+    printf("\t-j : set the number of processes playing the tournament (0: one per core) [default: 1]\n");
+    printf("\t-a : pin each tournament process to its own core\n");
+    printf("\t-r : record the game in a binary file, which can be replayed with the replay tool\n");
+    printf("\t-x : export the initial board then each move of the game to a file, as JSON lines\n");
+    printf("\t-P : print the time spent by each player and by the server at the end (text or json)\n");
+    printf("\t-D : append every position of the tournament games to a dataset file, indexed in the file ending with %s\n", DATASET__INDEX_SUFFIX);
+    printf("\t-C : keep a snapshot of each board built in a directory, read instead of building the board again\n");
 }
 
 static int parse_int_arg(const char* arg) {
@@ -29,40 +51,100 @@ static int parse_int_arg(const char* arg) {
     return (int)value;
 }
 
+static double parse_time_arg(const char* arg) {
+    char* end_ptr;
+    double value = strtod(arg, &end_ptr);
+
+    if (*arg == '\0' || *end_ptr != '\0' || value < 0) {
+        handle_error(__func__, "Invalid argument", PROGRAM_EXIT);
+    }
+
+    return value;
+}
+
 void display_winner(cgame g) {
     printf("Player %s won the game\n", game__get_player_name(g, game__get_winner(g)));
 }
 
-void export_game(cgame g, uint nb_frames) {
-    char name[20];
-    sprintf(name, "%s/%u.dot", EXPORT_DIR, nb_frames);
-    game__export(g, name);
+void export_game(cgame g, struct export_t* frames, unsigned char* cells) {
+    game__export(g, cells);
+    export__add_frame(frames, cells);
 }
 
 static void handle_args(int argc, char* argv[], struct game_config* config) {
     int opt;
 
-    while ((opt = getopt(argc, argv, "m:s:t:e")) != -1) {
+    while ((opt = getopt(argc, argv, "m:s:t:T:G:iM:I:pO:en:j:ar:x:P:D:C:")) != -1) {
         switch (opt) {
             case 'm':
                 config->size = parse_int_arg(optarg);
                 break;
             case 't':
-                config->board_shape = optarg[0];
+                config->shape_path = shape__file_path(optarg);
+                config->board_shape = config->shape_path ? SHAPE_MASK : optarg[0];
                 break;
             case 's':
                 config->seed = parse_int_arg(optarg);
                 break;
+            case 'T':
+                config->move_time = parse_time_arg(optarg);
+                break;
+            case 'G':
+                config->game_time = parse_time_arg(optarg);
+                break;
+            case 'i':
+                config->isolate_clients = 1;
+                break;
+            case 'M':
+                config->client_memory = parse_int_arg(optarg);
+                break;
+            case 'I':
+                config->init_time = parse_time_arg(optarg);
+                break;
+            case 'p':
+                config->ponder = 1;
+                break;
+            case 'O':
+                config->opening_moves = parse_int_arg(optarg);
+                break;
             case 'e':
                 export = 1;
                 break;
+            case 'n':
+                tournament.nb_games = parse_int_arg(optarg);
+                break;
+            case 'j':
+                tournament.nb_workers = parse_int_arg(optarg);
+                break;
+            case 'a':
+                tournament.pin_workers = 1;
+                break;
+            case 'r':
+                record_path = optarg;
+                break;
+            case 'x':
+                log_path = optarg;
+                break;
+            case 'P':
+                report = optarg;
+                if (strcmp(report, "text") && strcmp(report, "json"))
+                    handle_error(__func__, "Invalid report format", PROGRAM_EXIT);
+                break;
+            case 'D':
+                tournament.dataset_path = optarg;
+                break;
+            case 'C':
+                config->board_cache = optarg;
+                break;
             default:
                 usage(argv[0]);
                 exit(EXIT_FAILURE);
         }
     }
 
-    if (optind + 2 != argc) {
+    // A dataset is only filled by tournaments
+    if (optind + 2 != argc || ((export || record_path || log_path) && tournament.nb_games) ||
+        (tournament.dataset_path && !tournament.nb_games)) {
         usage(argv[0]);
         exit(EXIT_FAILURE);
     }
@@ -76,29 +158,84 @@ int main(int argc, char* argv[]) {
     const char* player1_path = (optind < argc) ? argv[optind] : "";
     const char* player2_path = (optind + 1 < argc) ? argv[optind + 1] : "";
 
-    uint turn = 0;
+    if (tournament.nb_games) {
+        struct tournament_result result;
+        tournament__play(&config, &tournament, player1_path, player2_path, &result);
+        tournament__print(&result);
+        if (report) {
+            const char* names[NUM_PLAYERS] = {result.scores[PLAYER_1].name, result.scores[PLAYER_2].name};
+            latency__print_stats(stdout, &result.stats, names, !strcmp(report, "json"));
+        }
+        return EXIT_SUCCESS;
+    }
+
     game g = game__new();
+    struct export_t* frames = NULL;
+    unsigned char* cells = NULL;
 
     game__init(g, &config, player1_path, player2_path);
 
     if (export) {
-        export__remove_dir(EXPORT_DIR);
-        export__create_dir(EXPORT_DIR);
-        export_game(g, turn++);
+        uint size = game__get_board_size(g);
+        frames = export__new(size);
+        cells = malloc(size * size);
+        if (!cells)
+            handle_error(__func__, "Not enough memory for 'cells'", PROGRAM_EXIT);
+        export_game(g, frames, cells);
+    }
+
+    const char* names[NUM_PLAYERS] = {game__get_player_name(g, PLAYER_1), game__get_player_name(g, PLAYER_2)};
+    record_writer record = NULL;
+    if (record_path) {
+        // The random opening is replayed from the initial position like the moves of the clients
+        uint nb_opening_moves;
+        const struct move_t* opening = game__get_opening(g, &nb_opening_moves);
+        record = record__open(record_path, game__get_board_shape(g), game__get_board_size(g), game__get_board_mask(g), game__get_seed(g),
+                              game__get_current_player(g) ^ (nb_opening_moves & 1), nb_opening_moves, names);
+        for (uint i = 0; record && i < nb_opening_moves; i++)
+            record__write_move(record, opening[i]);
+    }
+
+    struct export_log_t* export_log = NULL;
+    if (log_path) {
+        uint size = game__get_board_size(g);
+        unsigned char* initial_cells = malloc(size * size);
+        if (!initial_cells)
+            handle_error(__func__, "Not enough memory for 'initial_cells'", PROGRAM_EXIT);
+        game__export(g, initial_cells);
+        export_log = export__log_open(log_path, size, initial_cells, names, game__get_seed(g), game__get_current_player(g));
+        free(initial_cells);
     }
 
     while (!game__is_over(g)) {
         game__play(g);
+        if (record && !game__is_forfeit(g))
+            record__write_move(record, game__get_previous_move(g));
+        if (export_log && !game__is_forfeit(g))
+            export__log_move(export_log, game__get_previous_move(g));
         game__next_player(g);
 
         if (export)
-            export_game(g, turn++);
+            export_game(g, frames, cells);
+    }
+
+    // The frames are only rendered once the game is over, so that they do not slow it down
+    if (export) {
+        export__remove_dir(EXPORT_DIR);
+        export__create_dir(EXPORT_DIR);
+        export__write(frames, EXPORT_DIR, 0);
+        export__free(frames);
+        free(cells);
     }
 
-    if (export)
-        export__compile_dot();
+    if (record)
+        record__close(record, game__get_winner(g), game__is_forfeit(g));
+    if (export_log)
+        export__log_close(export_log, game__get_winner(g), game__is_forfeit(g));
 
     display_winner(g);
+    if (report)
+        latency__print_stats(stdout, game__get_stats(g), names, !strcmp(report, "json"));
     game__delete(g);
 
     return EXIT_SUCCESS;
@@ -1,3 +1,7 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
 #include "shape.h"
 #include "dir.h"
 #include "utils.h"
@@ -7,14 +11,20 @@
 #define SHAPE__DEFAULT_S_EIGHT 12
 #define SHAPE__DEFAULT_S_SQUARE 8
 
-typedef void (*add_edge_f)(uint, uint, uint, uint, enum dir_t, uint, struct graph_t*);
+typedef int (*has_edge_f)(struct shape_t*, uint, uint, uint, uint);
 
 struct shape_t {
     uint size;
     enum board_shape board_shape;
-    add_edge_f add_edge;
+    has_edge_f has_edge;
+    unsigned char* mask; // The playable cells of a shape read from a file, NULL for the other shapes
 };
 
+// The neighbors of a vertex, in increasing order of their index as in a compressed matrix
+static const int neighbor_rows[NUM_DIRS] = {-1, -1, -1, 0, 0, 1, 1, 1};
+static const int neighbor_cols[NUM_DIRS] = {-1, 0, 1, -1, 1, -1, 0, 1};
+static const enum dir_t neighbor_dirs[NUM_DIRS] = {DIR_NW, DIR_NORTH, DIR_NE, DIR_WEST, DIR_EAST, DIR_SW, DIR_SOUTH, DIR_SE};
+
 // Returns the index of an element in a (n,m) array represented in an 1D array of size n*m
 uint get_index(uint i, uint j, uint m) {
     return i * m + j;
@@ -72,38 +82,155 @@ uint init_size_eight(uint size) {
 // Initializes size for a square-shaped board
 uint init_size_square(uint size) { return size; }
 
-// Adds an edge between two vertices in a square board
-void add_edge_square(uint i1, uint j1, uint i2, uint j2, enum dir_t d, uint m, struct graph_t* b) {
-    gsl_spmatrix_uint_set(b->t, get_index(i1, j1, m), get_index(i2, j2, m), d);
+// Checks the edge between two vertices in a square board
+static int has_edge_square(struct shape_t* s, uint i1, uint j1, uint i2, uint j2) {
+    (void)s, (void)i1, (void)j1, (void)i2, (void)j2;
+    return 1;
+}
+
+// Checks the edge between two vertices in a donut board
+static int has_edge_donut(struct shape_t* s, uint i1, uint j1, uint i2, uint j2) {
+    uint square_size = s->size / 3;
+    // The edge exists if both vertices are not inside the inner square
+    return !is_inside_both(i1, j1, i2, j2, square_size, square_size * 2);
+}
+
+// Checks the edge between two vertices in a clover board
+static int has_edge_clover(struct shape_t* s, uint i1, uint j1, uint i2, uint j2) {
+    uint square_size = s->size / 5;
+    // The edge exists if one of the vertices is not inside the outer squares or if both are inside the center square
+    return !is_inside_both(i1, j1, i2, j2, square_size, square_size * 4) ||
+           is_between_both_and(i1, i2, square_size * 2, square_size * 3) ||
+           is_between_both_and(j1, j2, square_size * 2, square_size * 3);
 }
 
-// Adds an edge between two vertices in a donut board
-void add_edge_donut(uint i1, uint j1, uint i2, uint j2, enum dir_t d, uint m, struct graph_t* b) {
-    uint square_size = m / 3;
-    // Adds the edge if both vertices are not inside the inner square
-    if (!is_inside_both(i1, j1, i2, j2, square_size, square_size * 2))
-        gsl_spmatrix_uint_set(b->t, get_index(i1, j1, m), get_index(i2, j2, m), d);
+// Checks the edge between two vertices in an eight board
+static int has_edge_eight(struct shape_t* s, uint i1, uint j1, uint i2, uint j2) {
+    uint size = s->size;
+    uint square_size = size / 4;
+    // The two loops of the eight are joined by the diagonal crossing its center
+    if ((i1 == size / 2 && j1 == size / 2 && i2 == size / 2 - 1 && j2 == size / 2 - 1) ||
+        (i1 == size / 2 - 1 && j1 == size / 2 - 1 && i2 == size / 2 && j2 == size / 2))
+        return 1;
+    // The edge exists if the vertices are not on the horizontal or vertical axis of the center square
+    return !(is_between_both_or(i1, i2, square_size, square_size * 2) &&
+             is_between_both_or(j1, j2, square_size * 2, square_size * 3)) &&
+           !(is_between_both_or(i1, i2, square_size * 2, square_size * 3) &&
+             is_between_both_or(j1, j2, square_size, square_size * 2));
+}
+
+// Checks the edge between two vertices of a board read from a file, both of them having to be playable
+static int has_edge_mask(struct shape_t* s, uint i1, uint j1, uint i2, uint j2) {
+    return s->mask[get_index(i1, j1, s->size)] && s->mask[get_index(i2, j2, s->size)];
 }
 
-// Adds an edge between two vertices in a clover board
-void add_edge_clover(uint i1, uint j1, uint i2, uint j2, enum dir_t d, uint m, struct graph_t* b) {
-    uint square_size = m / 5;
-    // Adds the edge if one of the vertices is not inside the outer squares or if both are inside the center square
-    if (!is_inside_both(i1, j1, i2, j2, square_size, square_size * 4) ||
-        is_between_both_and(i1, i2, square_size * 2, square_size * 3) ||
-        is_between_both_and(j1, j2, square_size * 2, square_size * 3))
-        gsl_spmatrix_uint_set(b->t, get_index(i1, j1, m), get_index(i2, j2, m), d);
+// Reads a whole file, NULL if it cannot be read
+static char* read_file(const char* path, size_t* length) {
+    FILE* file = fopen(path, "rb");
+    if (!file)
+        return NULL;
+    size_t cap = 4096;
+    char* content = malloc(cap);
+    if (!content)
+        handle_error(__func__, "Not enough memory for 'content'", PROGRAM_EXIT);
+    *length = 0;
+    size_t n;
+    while ((n = fread(content + *length, 1, cap - *length, file)) > 0) {
+        *length += n;
+        if (*length == cap) {
+            cap *= 2;
+            content = realloc(content, cap);
+            if (!content)
+                handle_error(__func__, "Not enough memory for 'content'", PROGRAM_EXIT);
+        }
+    }
+    int error = ferror(file);
+    fclose(file);
+    if (error) {
+        free(content);
+        return NULL;
+    }
+    return content;
 }
 
-// Add an edge between two vertices in an eight board
-void add_edge_eight(uint i1, uint j1, uint i2, uint j2, enum dir_t d, uint m, struct graph_t* b) {
-    uint square_size = m / 4;
-    // Adds the edge if the vertices are not on the horizontal or vertical axis of the center square
-    if (!(is_between_both_or(i1, i2, square_size, square_size * 2) &&
-          is_between_both_or(j1, j2, square_size * 2, square_size * 3)) &&
-        !(is_between_both_or(i1, i2, square_size * 2, square_size * 3) &&
-          is_between_both_or(j1, j2, square_size, square_size * 2)))
-        gsl_spmatrix_uint_set(b->t, get_index(i1, j1, m), get_index(i2, j2, m), d);
+// Reads an unsigned integer of the header of a PBM file, skipping the whitespace and the comments before it
+static int read_pbm_number(const char* content, size_t length, size_t* offset, uint* value) {
+    while (*offset < length && (content[*offset] == '#' || content[*offset] == ' ' || content[*offset] == '\t' ||
+                                content[*offset] == '\n' || content[*offset] == '\r')) {
+        if (content[*offset] == '#')
+            while (*offset < length && content[*offset] != '\n')
+                (*offset)++;
+        else
+            (*offset)++;
+    }
+    if (*offset == length || content[*offset] < '0' || content[*offset] > '9')
+        return -1;
+    *value = 0;
+    while (*offset < length && content[*offset] >= '0' && content[*offset] <= '9') {
+        *value = *value * 10 + (content[*offset] - '0');
+        if (*value > SHAPE__MAX_MASK_SIZE)
+            return -1;
+        (*offset)++;
+    }
+    return 0;
+}
+
+// Fills the mask of a binary PBM image (P4), whose black pixels are the holes
+static int parse_pbm(struct shape_t* s, const char* content, size_t length) {
+    size_t offset = 2;
+    uint width, height;
+    if (read_pbm_number(content, length, &offset, &width) || read_pbm_number(content, length, &offset, &height) || offset == length)
+        return -1;
+    offset++; // The single whitespace before the pixels
+    size_t row_bytes = (width + 7) / 8;
+    if (!width || !height || length - offset < row_bytes * height)
+        return -1;
+
+    s->size = width > height ? width : height;
+    s->mask = calloc((size_t)s->size * s->size, 1);
+    if (!s->mask)
+        handle_error(__func__, "Not enough memory for 'mask'", PROGRAM_EXIT);
+    for (uint i = 0; i < height; i++)
+        for (uint j = 0; j < width; j++)
+            s->mask[get_index(i, j, s->size)] = !((content[offset + i * row_bytes + j / 8] >> (7 - j % 8)) & 1);
+    return 0;
+}
+
+// Fills the mask of a text file, one line per row, '.' being a playable cell and '#' a hole, the empty lines being skipped
+static int parse_text(struct shape_t* s, const char* content, size_t length) {
+    uint width = 0, height = 0, line_width = 0;
+    for (size_t k = 0; k < length; k++) {
+        if (content[k] == '\n') {
+            if (line_width)
+                height++;
+            line_width = 0;
+        } else if (content[k] == '.' || content[k] == '#') {
+            if (++line_width > SHAPE__MAX_MASK_SIZE)
+                return -1;
+            if (line_width > width)
+                width = line_width;
+        } else if (content[k] != '\r')
+            return -1;
+    }
+    if (line_width)
+        height++;
+    if (!width || height > SHAPE__MAX_MASK_SIZE)
+        return -1;
+
+    // The rows shorter than the longest one, and the rows added to make the board square, are holes
+    s->size = width > height ? width : height;
+    s->mask = calloc((size_t)s->size * s->size, 1);
+    if (!s->mask)
+        handle_error(__func__, "Not enough memory for 'mask'", PROGRAM_EXIT);
+    uint i = 0, j = 0;
+    for (size_t k = 0; k < length; k++) {
+        if (content[k] == '\n') {
+            i += j > 0;
+            j = 0;
+        } else if (content[k] != '\r')
+            s->mask[get_index(i, j++, s->size)] = content[k] == '.';
+    }
+    return 0;
 }
 
 /* ************************************************** */
@@ -112,12 +239,15 @@ struct shape_t* shape__new() {
     struct shape_t* new_shape = malloc(sizeof(struct shape_t));
     if (!new_shape)
         handle_error(__func__, "Not enough memory", 1);
+    new_shape->mask = NULL;
     return new_shape;
 }
 
 void shape__init(struct shape_t* s, uint size, char board_shape) {
     uint (*init_size)(uint) = NULL;
 
+    free(s->mask);
+    s->mask = NULL;
     s->board_shape = board_shape;
 
     if (!is_valid_shape(board_shape))
@@ -128,19 +258,19 @@ void shape__init(struct shape_t* s, uint size, char board_shape) {
     switch (s->board_shape) {
         case SHAPE_SQUARE:
             init_size = init_size_square;
-            s->add_edge = add_edge_square;
+            s->has_edge = has_edge_square;
             break;
         case SHAPE_DONUT:
             init_size = init_size_donut;
-            s->add_edge = add_edge_donut;
+            s->has_edge = has_edge_donut;
             break;
         case SHAPE_CLOVER:
             init_size = init_size_clover;
-            s->add_edge = add_edge_clover;
+            s->has_edge = has_edge_clover;
             break;
         case SHAPE_EIGHT:
             init_size = init_size_eight;
-            s->add_edge = add_edge_eight;
+            s->has_edge = has_edge_eight;
             break;
         default:
             handle_error(__func__, "Should never happen", 1);
@@ -150,33 +280,98 @@ void shape__init(struct shape_t* s, uint size, char board_shape) {
     s->size = init_size(size);
 }
 
+int shape__init_from_file(struct shape_t* s, const char* path) {
+    if (!path) handle_error(__func__, "Invalid parameter 'path'", PROGRAM_EXIT);
+
+    free(s->mask);
+    s->mask = NULL;
+    s->board_shape = SHAPE_MASK;
+    s->has_edge = has_edge_mask;
+
+    size_t length;
+    char* content = read_file(path, &length);
+    if (!content) {
+        handle_error(__func__, "Could not read the board file", PROGRAM_CONTINUE);
+        return -1;
+    }
+    int status = length >= 2 && content[0] == 'P' && content[1] == '4' ? parse_pbm(s, content, length) : parse_text(s, content, length);
+    free(content);
+    if (!status && s->size < 5) {
+        free(s->mask);
+        s->mask = NULL;
+        status = -1;
+    }
+    if (status)
+        handle_error(__func__, "Invalid board file, or board smaller than 5 cells", PROGRAM_CONTINUE);
+    return status;
+}
+
+int shape__init_from_mask(struct shape_t* s, uint size, const unsigned char* mask) {
+    if (!mask) handle_error(__func__, "Invalid parameter 'mask'", PROGRAM_EXIT);
+
+    free(s->mask);
+    s->mask = NULL;
+    s->board_shape = SHAPE_MASK;
+    s->has_edge = has_edge_mask;
+    if (size < 5 || size > SHAPE__MAX_MASK_SIZE)
+        return -1;
+
+    s->size = size;
+    s->mask = malloc((size_t)size * size);
+    if (!s->mask)
+        handle_error(__func__, "Not enough memory for 'mask'", PROGRAM_EXIT);
+    for (size_t k = 0; k < (size_t)size * size; k++)
+        s->mask[k] = mask[k] != 0;
+    return 0;
+}
+
 void shape__init_graph(struct shape_t* s, struct graph_t* b) {
     uint size = s->size;
+    for (uint pos = 0; pos < size * size; pos++) {
+        for (uint k = 0; k < NUM_DIRS; k++) {
+            int i2 = (int)(pos / size) + neighbor_rows[k];
+            int j2 = (int)(pos % size) + neighbor_cols[k];
+            if (i2 >= 0 && j2 >= 0 && i2 < (int)size && j2 < (int)size && s->has_edge(s, pos / size, pos % size, i2, j2))
+                gsl_spmatrix_uint_set(b->t, pos, get_index(i2, j2, size), neighbor_dirs[k]);
+        }
+    }
+}
+
+void shape__build_graph(struct shape_t* s, struct graph_t* b) {
+    uint size = s->size;
+    uint num_vertices = size * size;
+    int* p = malloc((num_vertices + 1) * sizeof(int));
+    int* neighbors = malloc((size_t)num_vertices * NUM_DIRS * sizeof(int));
+    uint* dirs = malloc((size_t)num_vertices * NUM_DIRS * sizeof(uint));
+    if (!p || !neighbors || !dirs)
+        handle_error(__func__, "Not enough memory for the edges", PROGRAM_EXIT);
+
+    // The edges of each vertex are found in the order of the compressed matrix, so they are written in place
+    int nz = 0;
     for (uint i = 0; i < size; i++) {
         for (uint j = 0; j < size; j++) {
-            if (i > 0)
-                s->add_edge(i, j, i - 1, j, DIR_NORTH, size, b);
-            if (i < size - 1)
-                s->add_edge(i, j, i + 1, j, DIR_SOUTH, size, b);
-            if (j > 0)
-                s->add_edge(i, j, i, j - 1, DIR_WEST, size, b);
-            if (j < size - 1)
-                s->add_edge(i, j, i, j + 1, DIR_EAST, size, b);
-            if (i > 0 && j > 0)
-                s->add_edge(i, j, i - 1, j - 1, DIR_NW, size, b);
-            if (i < size - 1 && j < size - 1)
-                s->add_edge(i, j, i + 1, j + 1, DIR_SE, size, b);
-            if (j > 0 && i < size - 1)
-                s->add_edge(i, j, i + 1, j - 1, DIR_SW, size, b);
-            if (j < size - 1 && i > 0)
-                s->add_edge(i, j, i - 1, j + 1, DIR_NE, size, b);
+            p[get_index(i, j, size)] = nz;
+            for (uint k = 0; k < NUM_DIRS; k++) {
+                int i2 = (int)i + neighbor_rows[k];
+                int j2 = (int)j + neighbor_cols[k];
+                if (i2 >= 0 && j2 >= 0 && i2 < (int)size && j2 < (int)size && s->has_edge(s, i, j, i2, j2)) {
+                    neighbors[nz] = get_index(i2, j2, size);
+                    dirs[nz++] = neighbor_dirs[k];
+                }
+            }
         }
     }
+    p[num_vertices] = nz;
 
-    if (s->board_shape == SHAPE_EIGHT) {
-        gsl_spmatrix_uint_set(b->t, get_index(size / 2, size / 2, size), get_index(size / 2 - 1, size / 2 - 1, size), DIR_NW);
-        gsl_spmatrix_uint_set(b->t, get_index(size / 2 - 1, size / 2 - 1, size), get_index(size / 2, size / 2, size), DIR_SE);
-    }
+    graph__init_from_csr(b, num_vertices, p, neighbors, dirs);
+    free(p);
+    free(neighbors);
+    free(dirs);
+}
+
+const char* shape__file_path(const char* arg) {
+    size_t prefix_length = strlen(SHAPE__FILE_PREFIX);
+    return arg && !strncmp(arg, SHAPE__FILE_PREFIX, prefix_length) ? arg + prefix_length : NULL;
 }
 
 enum board_shape shape__get_board_shape(struct shape_t* s) {
@@ -185,4 +380,10 @@ enum board_shape shape__get_board_shape(struct shape_t* s) {
 
 uint shape__get_size(struct shape_t* s) { return s->size; }
 
-void shape__delete(struct shape_t* s) { free(s); }
\ No newline at end of file
+const unsigned char* shape__get_mask(struct shape_t* s) { return s->mask; }
+
+void shape__delete(struct shape_t* s) {
+    if (s)
+        free(s->mask);
+    free(s);
+}
\ No newline at end of file
@@ -16,18 +16,22 @@
  * SHAPE_DONUT represents a donut-shaped board.
  * SHAPE_CLOVER represents a clover-shaped board.
  * SHAPE_EIGHT represents an eight-shaped board.
- * SHAPE_COUNT is the number of possible board shapes.
+ * SHAPE_MASK represents a board read from a file by shape__init_from_file.
+ * SHAPE_COUNT is the number of possible board shapes built by shape__init.
  */
 enum board_shape {
     SHAPE_SQUARE = 'c',
     SHAPE_DONUT = 'd',
     SHAPE_CLOVER = 't',
     SHAPE_EIGHT = '8',
+    SHAPE_MASK = 'f',
     SHAPE_COUNT = 4
 };
 
 #define SHAPE__DEFAULT_SHAPE SHAPE_SQUARE
 #define SHAPE__DEFAULT_SIZE 8
+#define SHAPE__FILE_PREFIX "file:" // The prefix of the shape arguments naming a board file
+#define SHAPE__MAX_MASK_SIZE 1024
 
 struct shape_t;
 
@@ -48,13 +52,52 @@ struct shape_t* shape__new();
 void shape__init(struct shape_t* s, uint size, char board_shape);
 
 /**
- * @brief Initializes the given graph according to the shape
+ * @brief Initializes a shape_t instance from a file giving the playable cells of the board
+ *
+ * The file is either a text file, one line per row of the board, '.' being a playable cell and '#' a hole,
+ * or a binary PBM image (P4), whose black pixels are the holes. The board is as large as the longest side
+ * of the file, of at most SHAPE__MAX_MASK_SIZE cells, the missing cells being holes.
  *
  * @param s A pointer to a shape_t instance
- * @param b A pointer to a graph_t instance
+ * @param path The path of the file
+ * @return 0 if the shape was read, -1 if the file could not be read or does not describe a board
+ */
+int shape__init_from_file(struct shape_t* s, const char* path);
+
+/**
+ * @brief Initializes a shape_t instance from the playable cells of a board, as returned by shape__get_mask
+ *
+ * @param s A pointer to a shape_t instance
+ * @param size The size of the game board, from 5 to SHAPE__MAX_MASK_SIZE cells
+ * @param mask The size * size cells of the board, row by row, 1 for a playable cell and 0 for a hole
+ * @return 0 if the shape was built, -1 if the size is invalid
+ */
+int shape__init_from_mask(struct shape_t* s, uint size, const unsigned char* mask);
+
+/**
+ * @brief Initializes the given graph according to the shape, by setting each of its edges
+ *
+ * @param s A pointer to a shape_t instance
+ * @param b A pointer to a graph_t instance, initialized by graph__init and to compress afterwards
  */
 void shape__init_graph(struct shape_t* s, struct graph_t* b);
 
+/**
+ * @brief Initializes and compresses the graph of the shape, writing its compressed matrix in a single pass
+ *
+ * @param s A pointer to a shape_t instance
+ * @param b A pointer to a graph_t instance, allocated by graph__new
+ */
+void shape__build_graph(struct shape_t* s, struct graph_t* b);
+
+/**
+ * @brief Returns the path of the board file named by a shape argument
+ *
+ * @param arg The shape argument of a command line
+ * @return The path following SHAPE__FILE_PREFIX, NULL if the argument is a shape letter
+ */
+const char* shape__file_path(const char* arg);
+
 /**
  * @brief Returns the board shape of the given shape_t instance
  *
@@ -71,6 +114,14 @@ enum board_shape shape__get_board_shape(struct shape_t* s);
  */
 uint shape__get_size(struct shape_t* s);
 
+/**
+ * @brief Returns the playable cells of a board read from a file
+ *
+ * @param s A pointer to a shape_t instance
+ * @return The size * size cells of the board, row by row, 1 for a playable cell and 0 for a hole, NULL for the other shapes
+ */
+const unsigned char* shape__get_mask(struct shape_t* s);
+
 /**
  * @brief Deletes a shape_t instance
  *
@@ -0,0 +1,216 @@
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <limits.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "dataset.h"
+#include "export.h"
+#include "tournament.h"
+
+// Plays a game, adding each of its positions to the dataset if there is one
+static void play_game(game g, dataset_writer dataset, unsigned char* cells) {
+    while (!game__is_over(g)) {
+        enum player_n player_id = game__get_current_player(g);
+        if (dataset)
+            game__export(g, cells);
+        game__play(g);
+        if (dataset)
+            dataset__add_position(dataset, cells, player_id, game__is_forfeit(g) ? create_initial_move() : game__get_previous_move(g),
+                                  game__get_move_score(g));
+        game__next_player(g);
+    }
+    if (dataset)
+        dataset__end_game(dataset, game__get_seed(g), game__get_winner(g));
+}
+
+// Plays the games first, first + step, ... of the tournament in this process, the seed of config being set
+static void play_games(struct game_config* config, uint nb_games, uint first, uint step, const char* lib_player1, const char* lib_player2,
+                       const char* dataset_path, struct tournament_result* result) {
+    uint base_seed = (uint)config->seed;
+    dataset_writer dataset = NULL;
+    unsigned char* cells = NULL;
+
+    for (uint i = first; i < nb_games; i += step) {
+        struct game_config game_config = *config;
+        game_config.seed = (int)((base_seed + i) & INT_MAX);
+        game_config.starting_player = i % 2 ? PLAYER_2 : PLAYER_1;
+
+        game g = game__new();
+        game__init(g, &game_config, lib_player1, lib_player2);
+
+        // The size of the board is only known once the shape is built
+        if (dataset_path && !cells) {
+            uint size = game__get_board_size(g);
+            cells = malloc(size * size);
+            if (!cells)
+                handle_error(__func__, "Not enough memory for 'cells'", PROGRAM_EXIT);
+            dataset = dataset__open(dataset_path, game__get_board_shape(g), size, queens__default_count(size));
+            if (!dataset)
+                handle_error(__func__, "No dataset to append the games to", PROGRAM_EXIT);
+        }
+        play_game(g, dataset, cells);
+
+        enum player_n winner = game__get_winner(g);
+        enum player_n loser = winner == PLAYER_1 ? PLAYER_2 : PLAYER_1;
+        result->nb_games++;
+        result->scores[winner].wins++;
+        result->scores[loser].losses++;
+        result->scores[loser].invalid_moves += game__is_forfeit(g);
+        for (enum player_n player_id = 0; player_id < NUM_PLAYERS; player_id++)
+            snprintf(result->scores[player_id].name, TOURNAMENT__NAME_SIZE, "%s", game__get_player_name(g, player_id));
+        latency__merge_stats(&result->stats, game__get_stats(g));
+        game__delete(g);
+    }
+
+    if (dataset && dataset__close(dataset))
+        handle_error(__func__, "Could not write every game to the dataset", PROGRAM_CONTINUE);
+    free(cells);
+}
+
+static void merge_results(struct tournament_result* dst, const struct tournament_result* src) {
+    dst->nb_games += src->nb_games;
+    for (uint player_id = 0; player_id < NUM_PLAYERS; player_id++) {
+        if (src->scores[player_id].name[0])
+            memcpy(dst->scores[player_id].name, src->scores[player_id].name, TOURNAMENT__NAME_SIZE);
+        dst->scores[player_id].wins += src->scores[player_id].wins;
+        dst->scores[player_id].losses += src->scores[player_id].losses;
+        dst->scores[player_id].invalid_moves += src->scores[player_id].invalid_moves;
+    }
+    latency__merge_stats(&dst->stats, &src->stats);
+}
+
+// Reads or writes a whole buffer through a pipe, returns 0 on success
+static int read_all(int fd, void* buf, size_t size) {
+    char* p = buf;
+    while (size) {
+        ssize_t n = read(fd, p, size);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return -1;
+        p += n;
+        size -= n;
+    }
+    return 0;
+}
+
+static int write_all(int fd, const void* buf, size_t size) {
+    const char* p = buf;
+    while (size) {
+        ssize_t n = write(fd, p, size);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return -1;
+        p += n;
+        size -= n;
+    }
+    return 0;
+}
+
+static void pin_to_core(uint core) {
+    long nb_cores = sysconf(_SC_NPROCESSORS_ONLN);
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core % (nb_cores > 0 ? nb_cores : 1), &set);
+    if (sched_setaffinity(0, sizeof(set), &set))
+        handle_error(__func__, "Could not pin the worker", PROGRAM_CONTINUE);
+}
+
+void tournament__play(struct game_config* game_config, struct tournament_config* tournament_config, const char* lib_player1, const char* lib_player2,
+                      struct tournament_result* result) {
+    if (!game_config) handle_error(__func__, "Invalid parameter 'game_config'", PROGRAM_EXIT);
+    if (!tournament_config) handle_error(__func__, "Invalid parameter 'tournament_config'", PROGRAM_EXIT);
+    if (!result) handle_error(__func__, "Invalid parameter 'result'", PROGRAM_EXIT);
+
+    uint nb_workers = tournament_config->nb_workers;
+    if (!nb_workers) {
+        long nb_cores = sysconf(_SC_NPROCESSORS_ONLN);
+        nb_workers = nb_cores > 0 ? nb_cores : 1;
+    }
+    if (nb_workers > tournament_config->nb_games)
+        nb_workers = tournament_config->nb_games ? tournament_config->nb_games : 1;
+
+    // Every worker derives the same seeds
+    struct game_config config = *game_config;
+    if (config.seed < 0)
+        config.seed = (int)((uint)time(NULL) & INT_MAX);
+
+    memset(result, 0, sizeof(*result));
+    double start = get_monotonic_time();
+
+    if (nb_workers == 1) {
+        if (tournament_config->pin_workers)
+            pin_to_core(0);
+        play_games(&config, tournament_config->nb_games, 0, 1, lib_player1, lib_player2, tournament_config->dataset_path, result);
+        result->elapsed = get_monotonic_time() - start;
+        return;
+    }
+
+    pid_t* pids = malloc(nb_workers * sizeof(pid_t));
+    int* fds = malloc(nb_workers * sizeof(int));
+    if (!pids || !fds)
+        handle_error(__func__, "Not enough memory for the workers", PROGRAM_EXIT);
+
+    fflush(stdout);
+    fflush(stderr);
+    for (uint worker = 0; worker < nb_workers; worker++) {
+        int pipe_fds[2];
+        if (pipe(pipe_fds))
+            handle_error(__func__, "Could not create a pipe", PROGRAM_EXIT);
+
+        pids[worker] = fork();
+        if (pids[worker] < 0)
+            handle_error(__func__, "Could not fork a worker", PROGRAM_EXIT);
+
+        if (pids[worker] == 0) {
+            close(pipe_fds[0]);
+            for (uint other = 0; other < worker; other++)
+                close(fds[other]);
+            if (tournament_config->pin_workers)
+                pin_to_core(worker);
+
+            struct tournament_result worker_result;
+            memset(&worker_result, 0, sizeof(worker_result));
+            play_games(&config, tournament_config->nb_games, worker, nb_workers, lib_player1, lib_player2, tournament_config->dataset_path,
+                       &worker_result);
+            int status = write_all(pipe_fds[1], &worker_result, sizeof(worker_result));
+            close(pipe_fds[1]);
+            _exit(status ? EXIT_FAILURE : EXIT_SUCCESS);
+        }
+
+        close(pipe_fds[1]);
+        fds[worker] = pipe_fds[0];
+    }
+
+    // A worker that crashed or was killed only loses its own games
+    for (uint worker = 0; worker < nb_workers; worker++) {
+        struct tournament_result worker_result;
+        if (read_all(fds[worker], &worker_result, sizeof(worker_result)))
+            handle_error(__func__, "A worker did not report its results", PROGRAM_CONTINUE);
+        else
+            merge_results(result, &worker_result);
+        close(fds[worker]);
+        waitpid(pids[worker], NULL, 0);
+    }
+    result->elapsed = get_monotonic_time() - start;
+
+    free(fds);
+    free(pids);
+}
+
+void tournament__print(struct tournament_result* result) {
+    if (!result) handle_error(__func__, "Invalid parameter 'result'", PROGRAM_EXIT);
+
+    printf("%u games in %.3f s (%.1f games/s)\n", result->nb_games, result->elapsed, result->elapsed > 0 ? result->nb_games / result->elapsed : 0);
+    for (uint player_id = 0; player_id < NUM_PLAYERS; player_id++)
+        printf("Player %u (%s): %u wins, %u losses, %u invalid moves\n", player_id + 1, result->scores[player_id].name, result->scores[player_id].wins,
+               result->scores[player_id].losses, result->scores[player_id].invalid_moves);
+}
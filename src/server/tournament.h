@@ -0,0 +1,80 @@
+/**
+ * @file tournament.h
+ * @brief This file contains the declarations of functions and data types used to play tournaments between two clients.
+ */
+
+#ifndef __TOURNAMENT_H__
+#define __TOURNAMENT_H__
+
+#include "game.h"
+#include "latency.h"
+#include "player.h"
+#include "utils.h"
+
+#define TOURNAMENT__NAME_SIZE 64
+
+/**
+ * @brief A struct representing the results of a player over a tournament.
+ * name is the name of the player, copied since the client library is unloaded after each game.
+ * wins and losses are the numbers of games won and lost.
+ * invalid_moves is the number of games lost by playing an invalid move.
+ */
+struct tournament_score {
+    char name[TOURNAMENT__NAME_SIZE];
+    uint wins;
+    uint losses;
+    uint invalid_moves;
+};
+
+/**
+ * @brief A struct representing the results of a tournament.
+ * nb_games is the number of games actually played.
+ * elapsed is the duration of the tournament in seconds.
+ * scores are the results of each player.
+ * stats are the times spent by the players and the server over all the games.
+ */
+struct tournament_result {
+    uint nb_games;
+    double elapsed;
+    struct tournament_score scores[NUM_PLAYERS];
+    struct latency_stats stats;
+};
+
+/**
+ * @brief A struct representing the configuration of a tournament.
+ * nb_games is the number of games to play.
+ * nb_workers is the number of processes playing the games, 0 for one per online core.
+ * pin_workers pins each worker process to its own core if set.
+ * dataset_path is the dataset every position of the games is appended to, NULL for none.
+ */
+struct tournament_config {
+    uint nb_games;
+    uint nb_workers;
+    int pin_workers;
+    const char* dataset_path;
+};
+
+/**
+ * @brief Plays a tournament between two clients.
+ *
+ * Game i uses the seed of the game configuration plus i, or the current time plus i if it is negative,
+ * and is started by player 1 if i is even, by player 2 otherwise. The games are dealt between
+ * forked worker processes so that the statics of the clients are never shared, the results being
+ * sent back over pipes. They are the same whatever the number of workers.
+ *
+ * @param game_config The configuration of every game.
+ * @param tournament_config The configuration of the tournament.
+ * @param lib_player1 The dynamic library for player 1.
+ * @param lib_player2 The dynamic library for player 2.
+ * @param result Where to write the results of the tournament.
+ */
+void tournament__play(struct game_config* game_config, struct tournament_config* tournament_config, const char* lib_player1, const char* lib_player2,
+                      struct tournament_result* result);
+
+/**
+ * @brief Prints the results of a tournament.
+ * @param result The results of the tournament.
+ */
+void tournament__print(struct tournament_result* result);
+
+#endif // __TOURNAMENT_H__
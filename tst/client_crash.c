@@ -0,0 +1,26 @@
+#include <stdlib.h>
+
+#include "player.h"
+
+// A client crashing on its first move, used to test the isolation of the clients
+
+char const* get_player_name() {
+    return "Crash";
+}
+
+void initialize(unsigned int player_id, struct graph_t* graph, unsigned int num_queens, unsigned int* queens[NUM_PLAYERS]) {
+    (void)player_id;
+    (void)num_queens;
+    graph__free(graph);
+    free(queens[0]);
+    free(queens[1]);
+}
+
+struct move_t play(struct move_t previous_move) {
+    (void)previous_move;
+    volatile int* null_pointer = NULL;
+    *null_pointer = 0;
+    return previous_move;
+}
+
+void finalize() {}
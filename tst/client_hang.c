@@ -0,0 +1,22 @@
+#include "player.h"
+
+// A client never returning from its initialization, used to test the isolation of the clients
+
+char const* get_player_name() {
+    return "Hang";
+}
+
+void initialize(unsigned int player_id, struct graph_t* graph, unsigned int num_queens, unsigned int* queens[NUM_PLAYERS]) {
+    (void)player_id;
+    (void)graph;
+    (void)num_queens;
+    (void)queens;
+    while (1)
+        ;
+}
+
+struct move_t play(struct move_t previous_move) {
+    return previous_move;
+}
+
+void finalize() {}
@@ -0,0 +1,25 @@
+#include "player_common.h"
+
+// A client giving up on its first move, scored with the first number drawn by its generator, used to test the seeds of the clients
+
+static double score = 0;
+
+char const* get_player_name() {
+    return "Seed";
+}
+
+void initialize(unsigned int player_id, struct graph_t* graph, unsigned int num_queens, unsigned int* queens[NUM_PLAYERS]) {
+    struct pc__player_info* pi = pc__init(player_id, graph, num_queens, queens);
+    score = (double)(rng__next(&pi->rng) >> 32);
+    pc__free(pi);
+}
+
+struct move_t play(struct move_t previous_move) {
+    return previous_move;
+}
+
+double get_move_score() {
+    return score;
+}
+
+void finalize() {}
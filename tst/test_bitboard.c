@@ -0,0 +1,132 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bitboard.h"
+#include "move.h"
+#include "movegen.h"
+#include "player.h"
+#include "queens.h"
+#include "shape.h"
+#include "tests_boards.h"
+#include "tests_functions.h"
+#include "tests_utils.h"
+
+struct func_block tests_list_bitboard[] = {
+    {tests__bitboard__is_supported, "bitboard__is_supported"},
+    {tests__bitboard__init, "bitboard__init"},
+    {tests__bitboard__reachable, "bitboard__reachable"},
+    {tests__bitboard__play, "bitboard__play"},
+    {tests__bitboard__generate, "bitboard__generate"}};
+
+struct tests__functions tests__get_bitboard_tests() {
+    return (struct tests__functions){5, tests_list_bitboard};
+}
+
+// Checks that the bitboard and can_reach_position agree on every pair of vertices
+static void assert_same_reach(struct bitboard_t* bb, struct graph_t* g, struct queens_t* q) {
+    for (uint src = 0; src < g->num_vertices; src++) {
+        struct bitset_t reached = bitboard__reachable(bb, src);
+        for (uint dst = 0; dst < g->num_vertices; dst++)
+            assert(bitset__test(&reached, bitboard__to_bit(bb, dst)) == (can_reach_position(g, q, src, dst) > 0));
+    }
+}
+
+void tests__bitboard__is_supported() {
+    assert(bitboard__is_supported(100));
+    assert(bitboard__is_supported(256));
+    assert(!bitboard__is_supported(289));
+    assert(!bitboard__is_supported(99));
+}
+
+void tests__bitboard__init() {
+    uint size = 9;
+    struct graph_t* g = tests__shaped_graph(&size, SHAPE_DONUT);
+    struct queens_t* q = tests__initial_queens(size);
+    struct bitboard_t* bb = bitboard__new();
+    bitboard__init(bb, g, q);
+    assert(bb->size == 9);
+    assert(bitset__count(bb->valid) == 81 - 9);
+    assert(bitset__count(bb->queens[0]) == 4);
+    assert(bitset__count(bb->queens[1]) == 4);
+    assert(!bitset__test(&bb->valid, bitboard__to_bit(bb, 40)));
+    assert(bitset__test(&bb->blocked, bitboard__to_bit(bb, 40)));
+    assert(bitset__count(bitboard__empty(bb)) == 81 - 9 - 8);
+    bitboard__free(bb);
+    queens__free(q);
+    graph__free(g);
+}
+
+void tests__bitboard__reachable() {
+    char shapes[] = {SHAPE_SQUARE, SHAPE_DONUT, SHAPE_CLOVER, SHAPE_EIGHT};
+    uint sizes[] = {10, 9, 15, 12};
+    for (uint i = 0; i < 4; i++) {
+        struct graph_t* g = tests__shaped_graph(&sizes[i], shapes[i]);
+        struct queens_t* q = tests__initial_queens(sizes[i]);
+        struct bitboard_t* bb = bitboard__new();
+        bitboard__init(bb, g, q);
+        assert_same_reach(bb, g, q);
+        bitboard__free(bb);
+        queens__free(q);
+        graph__free(g);
+    }
+}
+
+void tests__bitboard__play() {
+    struct graph_t* g = tests__square_graph(10);
+    struct queens_t* q = tests__initial_queens(10);
+    struct bitboard_t* bb = bitboard__new();
+    bitboard__init(bb, g, q);
+
+    struct move_t moves[] = {{10, 44, 47}, {89, 55, 33}, {44, 42, 43}};
+    for (uint i = 0; i < 3; i++) {
+        move_queen(q, i % 2, moves[i]);
+        graph__disconnect(g, moves[i].arrow_dst);
+        bitboard__play(bb, i % 2, moves[i]);
+        assert_same_reach(bb, g, q);
+    }
+    assert(bitset__test(&bb->blocked, bitboard__to_bit(bb, 43)));
+    assert(bitset__test(&bb->queens[0], bitboard__to_bit(bb, 42)));
+    assert(!bitset__test(&bb->queens[0], bitboard__to_bit(bb, 10)));
+
+    bitboard__free(bb);
+    queens__free(q);
+    graph__free(g);
+}
+
+// Checks that the bitboard generates the moves of the shared generator
+static void assert_same_moves(struct bitboard_t* bb, struct graph_t* g, struct queens_t* q, uint player_id) {
+    size_t count = movegen__generate(g, q, player_id, NULL, 0);
+    struct move_t* out = malloc(sizeof(struct move_t) * (count + 1));
+    assert(bitboard__generate(bb, player_id, out, count + 1) == count);
+    assert(bitboard__count(bb, player_id) == count);
+    for (size_t i = 0; i < count; i++)
+        assert(move__check(g, q, player_id, out[i]) == MOVE_REGULAR);
+    free(out);
+}
+
+void tests__bitboard__generate() {
+    char shapes[] = {SHAPE_SQUARE, SHAPE_DONUT, SHAPE_CLOVER, SHAPE_EIGHT};
+    uint sizes[] = {8, 9, 15, 12};
+    for (uint i = 0; i < 4; i++) {
+        struct graph_t* g = tests__shaped_graph(&sizes[i], shapes[i]);
+        struct queens_t* q = tests__initial_queens(sizes[i]);
+        struct bitboard_t* bb = bitboard__new();
+        bitboard__init(bb, g, q);
+
+        // The moves stay the same once a move of each player is played
+        struct move_undo_t undo;
+        for (uint player_id = 0; player_id < NUM_PLAYERS; player_id++) {
+            assert_same_moves(bb, g, q, player_id);
+            struct move_t move;
+            assert(bitboard__generate(bb, player_id, &move, 1) > 0);
+            move__make(g, q, player_id, move, &undo);
+            bitboard__play(bb, player_id, move);
+        }
+        assert_same_moves(bb, g, q, 0);
+
+        bitboard__free(bb);
+        queens__free(q);
+        graph__free(g);
+    }
+}
@@ -0,0 +1,119 @@
+#define _DEFAULT_SOURCE
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "board_cache.h"
+#include "tests_functions.h"
+#include "tests_utils.h"
+
+#define SNAPSHOT_DIR "test_board_cache"
+#define SNAPSHOT_PATH SNAPSHOT_DIR "/d-9" BOARD_CACHE__SUFFIX
+
+struct func_block tests_list_board_cache[] = {
+    {tests__board_cache__init_graph, "board_cache__init_graph"},
+    {tests__board_cache__snapshot, "board_cache__init_graph (snapshot)"}};
+
+struct tests__functions tests__get_board_cache_tests() {
+    return (struct tests__functions){2, tests_list_board_cache};
+}
+
+static struct graph_t* built_graph(struct shape_t* s) {
+    struct graph_t* g = graph__new();
+    graph__init(g, shape__get_size(s) * shape__get_size(s));
+    shape__init_graph(s, g);
+    graph__compress(g);
+    return g;
+}
+
+static int is_same_graph(struct graph_t* a, struct graph_t* b) {
+    size_t nz = a->t->p[a->num_vertices];
+    return a->num_vertices == b->num_vertices && a->width == b->width && a->key == b->key && gsl_spmatrix_uint_equal(a->t, b->t) &&
+           !memcmp(a->neighbors, b->neighbors, a->num_vertices * NUM_DIRS * sizeof(uint)) && !memcmp(a->twins, b->twins, nz * sizeof(int));
+}
+
+void tests__board_cache__init_graph() {
+    board_cache__clear();
+    char shapes[SHAPE_COUNT] = {SHAPE_SQUARE, SHAPE_DONUT, SHAPE_CLOVER, SHAPE_EIGHT};
+    for (uint shape_id = 0; shape_id < SHAPE_COUNT; shape_id++) {
+        struct shape_t* s = shape__new();
+        shape__init(s, 20, shapes[shape_id]);
+        struct graph_t* expected = built_graph(s);
+
+        // The first board is built, the next one copied from the cache, and both can be played on separately
+        for (uint i = 0; i < 2; i++) {
+            struct graph_t* g = graph__new();
+            board_cache__init_graph(s, g, NULL);
+            assert(is_same_graph(g, expected));
+            graph__disconnect(g, 0);
+            assert(is_isolated(g, 0) && !is_isolated(expected, 0));
+            graph__free(g);
+        }
+        graph__free(expected);
+        shape__delete(s);
+    }
+
+    // An image is rejected if its size does not match its header
+    struct shape_t* s = shape__new();
+    shape__init(s, 8, SHAPE_SQUARE);
+    struct graph_t* g = built_graph(s);
+    size_t size = graph__image_size(g);
+    void* image = malloc(size);
+    graph__write_image(g, image);
+    struct graph_t copy;
+    assert(graph__check_image(image, size) == 64 && graph__check_image(image, size - 8) == 0);
+    assert(graph__init_from_image(&copy, image, size - 8) == -1);
+    assert(graph__init_from_image(&copy, image, size) == 0);
+    assert(is_same_graph(&copy, g));
+    gsl_spmatrix_uint_free(copy.t);
+    free(copy.neighbors);
+    free(copy.twins);
+    free(image);
+    graph__free(g);
+    shape__delete(s);
+    board_cache__clear();
+}
+
+void tests__board_cache__snapshot() {
+    board_cache__clear();
+    remove(SNAPSHOT_PATH);
+    rmdir(SNAPSHOT_DIR);
+    assert(mkdir(SNAPSHOT_DIR, 0777) == 0);
+
+    struct shape_t* s = shape__new();
+    shape__init(s, 9, SHAPE_DONUT);
+    struct graph_t* expected = built_graph(s);
+
+    // The first board writes the snapshot, which gives the board of the next process
+    struct graph_t* g = graph__new();
+    board_cache__init_graph(s, g, SNAPSHOT_DIR);
+    assert(is_same_graph(g, expected));
+    graph__free(g);
+    struct stat st;
+    assert(stat(SNAPSHOT_PATH, &st) == 0 && st.st_size > 0);
+
+    board_cache__clear();
+    g = graph__new();
+    board_cache__init_graph(s, g, SNAPSHOT_DIR);
+    assert(is_same_graph(g, expected));
+    graph__free(g);
+
+    // A damaged snapshot is built and written again
+    board_cache__clear();
+    assert(truncate(SNAPSHOT_PATH, st.st_size / 2) == 0);
+    g = graph__new();
+    board_cache__init_graph(s, g, SNAPSHOT_DIR);
+    assert(is_same_graph(g, expected));
+    graph__free(g);
+    struct stat rewritten;
+    assert(stat(SNAPSHOT_PATH, &rewritten) == 0 && rewritten.st_size == st.st_size);
+
+    board_cache__clear();
+    graph__free(expected);
+    shape__delete(s);
+    remove(SNAPSHOT_PATH);
+    rmdir(SNAPSHOT_DIR);
+}
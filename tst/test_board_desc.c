@@ -0,0 +1,93 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "board_desc.h"
+#include "shape.h"
+#include "tests_boards.h"
+#include "tests_functions.h"
+#include "tests_utils.h"
+
+struct func_block tests_list_board_desc[] = {
+    {tests__board_desc__publish, "board_desc__publish"},
+    {tests__board_desc__to_graph, "board_desc__to_graph"},
+    {tests__board_desc__to_queens, "board_desc__to_queens"}};
+
+struct tests__functions tests__get_board_desc_tests() {
+    return (struct tests__functions){3, tests_list_board_desc};
+}
+
+void tests__board_desc__publish() {
+    uint size = 9;
+    struct graph_t* g = tests__shaped_graph(&size, SHAPE_DONUT);
+    struct queens_t* q = tests__initial_queens(size);
+
+    const struct board_desc_t* desc = board_desc__publish(g, q);
+    assert(desc->num_vertices == g->num_vertices);
+    assert(desc->num_queens == q->nb_queens);
+    assert(desc->image_size == graph__image_size(g));
+    void* image = malloc(desc->image_size);
+    graph__write_image(g, image);
+    assert(!memcmp(desc->image, image, desc->image_size));
+    assert((uintptr_t)desc->image % sizeof(uint64_t) == 0);
+    free(image);
+    for (uint player_id = 0; player_id < 2; player_id++)
+        for (uint queen_id = 0; queen_id < q->nb_queens; queen_id++)
+            assert(desc->queens[player_id][queen_id] == q->array[player_id][queen_id]);
+
+    board_desc__release(desc);
+    board_desc__release(NULL);
+    queens__free(q);
+    graph__free(g);
+}
+
+void tests__board_desc__to_graph() {
+    char shapes[] = {SHAPE_SQUARE, SHAPE_DONUT, SHAPE_CLOVER, SHAPE_EIGHT};
+    for (uint i = 0; i < sizeof(shapes); i++) {
+        uint size = 12;
+        struct graph_t* g = tests__shaped_graph(&size, shapes[i]);
+        struct queens_t* q = tests__initial_queens(size);
+        const struct board_desc_t* desc = board_desc__publish(g, q);
+
+        struct graph_t* copy = board_desc__to_graph(desc);
+        assert(copy->num_vertices == g->num_vertices);
+        assert(copy->width == g->width);
+        assert(copy->key == g->key);
+        assert(gsl_spmatrix_uint_equal(copy->t, g->t));
+        for (uint pos = 0; pos < g->num_vertices; pos++)
+            for (enum dir_t d = FIRST_DIR; d <= LAST_DIR; d++)
+                assert(graph__get_neighbor(copy, pos, d) == graph__get_neighbor(g, pos, d));
+
+        // The copy is private and outlives the description
+        board_desc__release(desc);
+        uint pos = q->array[0][0];
+        graph__disconnect(copy, pos);
+        assert(is_isolated(copy, pos));
+        assert(!is_isolated(g, pos));
+
+        graph__free(copy);
+        queens__free(q);
+        graph__free(g);
+    }
+}
+
+void tests__board_desc__to_queens() {
+    uint size = 10;
+    struct graph_t* g = tests__shaped_graph(&size, SHAPE_SQUARE);
+    struct queens_t* q = tests__initial_queens(10);
+    const struct board_desc_t* desc = board_desc__publish(g, q);
+
+    uint* queens[2];
+    board_desc__to_queens(desc, queens);
+    board_desc__release(desc);
+    for (uint player_id = 0; player_id < 2; player_id++) {
+        for (uint queen_id = 0; queen_id < q->nb_queens; queen_id++)
+            assert(queens[player_id][queen_id] == q->array[player_id][queen_id]);
+        free(queens[player_id]);
+    }
+
+    queens__free(q);
+    graph__free(g);
+}
@@ -0,0 +1,193 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "book.h"
+#include "movegen.h"
+#include "player.h"
+#include "shape.h"
+#include "tests_boards.h"
+#include "tests_functions.h"
+#include "tests_utils.h"
+
+#define BOOK_PATH "test_book.bin"
+#define BOOK_SIZE 8
+
+struct func_block tests_list_book[] = {
+    {tests__book__key, "book__key"},
+    {tests__book__probe, "book__probe"}};
+
+struct tests__functions tests__get_book_tests() {
+    return (struct tests__functions){2, tests_list_book};
+}
+
+static uint transformed(uint pos, uint symmetry) {
+    return book__to_key_frame((struct move_t){pos, pos, pos}, BOOK_SIZE, symmetry).queen_src;
+}
+
+// The position after the first move of player 0, or its image by a symmetry
+static void first_position(uint symmetry, struct move_t move, struct graph_t** g, struct queens_t** q) {
+    *g = tests__square_graph(BOOK_SIZE);
+    *q = tests__initial_queens(BOOK_SIZE);
+    struct move_undo_t undo;
+    move__make(*g, *q, 0, move, &undo);
+    for (uint player_id = 0; player_id < NUM_PLAYERS; player_id++)
+        for (uint queen_id = 0; queen_id < (*q)->nb_queens; queen_id++)
+            (*q)->array[player_id][queen_id] = transformed((*q)->array[player_id][queen_id], symmetry);
+    if (symmetry) {
+        graph__free(*g);
+        *g = tests__square_graph(BOOK_SIZE);
+        graph__disconnect(*g, transformed(move.arrow_dst, symmetry));
+    }
+    queens__rehash(*q);
+    queens__build_index(*q, (*g)->num_vertices);
+}
+
+static struct move_t some_move(uint player_id, size_t index) {
+    struct graph_t* g = tests__square_graph(BOOK_SIZE);
+    struct queens_t* q = tests__initial_queens(BOOK_SIZE);
+    struct move_t moves[4096];
+    size_t count = movegen__generate(g, q, player_id, moves, 4096);
+    assert(count > index && count <= 4096);
+    queens__free(q);
+    graph__free(g);
+    return moves[index];
+}
+
+void tests__book__key() {
+    struct move_t move = some_move(0, 17);
+    struct graph_t* g;
+    struct queens_t* q;
+    first_position(0, move, &g, &q);
+    uint64_t key = book__key(g, q, 1, NULL);
+
+    // Every rotation and reflection of the board has the same key
+    for (uint symmetry = 1; symmetry < BOOK__NB_SYMMETRIES; symmetry++) {
+        struct graph_t* image_g;
+        struct queens_t* image_q;
+        first_position(symmetry, move, &image_g, &image_q);
+        assert(book__key(image_g, image_q, 1, NULL) == key);
+        queens__free(image_q);
+        graph__free(image_g);
+    }
+
+    // So have the same queens with the other colors, the other player to move
+    uint* swap = q->array[0];
+    q->array[0] = q->array[1];
+    q->array[1] = swap;
+    assert(book__key(g, q, 0, NULL) == key);
+    q->array[1] = q->array[0];
+    q->array[0] = swap;
+
+    // But not the same queens with the other player to move, nor another position
+    assert(book__key(g, q, 0, NULL) != key);
+    struct graph_t* other_g;
+    struct queens_t* other_q;
+    first_position(0, some_move(0, 18), &other_g, &other_q);
+    assert(book__key(other_g, other_q, 1, NULL) != key);
+
+    queens__free(other_q);
+    graph__free(other_g);
+    queens__free(q);
+    graph__free(g);
+}
+
+void tests__book__probe() {
+    struct move_t first = some_move(0, 42);
+    struct graph_t* g;
+    struct queens_t* q;
+    first_position(0, first, &g, &q);
+    uint symmetry;
+    uint64_t key = book__key(g, q, 1, &symmetry);
+
+    struct move_t replies[4096];
+    size_t nb_replies = movegen__generate(g, q, 1, replies, 4096);
+    assert(nb_replies > 10 && nb_replies <= 4096);
+    struct move_t best = book__to_key_frame(replies[7], BOOK_SIZE, symmetry);
+    struct move_t worse = book__to_key_frame(replies[3], BOOK_SIZE, symmetry);
+    struct book_entry entries[3] = {
+        {key, {worse.queen_src, worse.queen_dst, worse.arrow_dst}, 0, 1.f, 0},
+        {key ^ 1, {0, 1, 2}, 0, 9.f, 0},
+        {key, {best.queen_src, best.queen_dst, best.arrow_dst}, 0, 2.5f, 0}};
+    struct graph_t* initial_g = tests__square_graph(BOOK_SIZE);
+    uint64_t board_key = book__board_key(initial_g);
+    assert(book__board_key(g) == board_key);
+    graph__free(initial_g);
+    assert(book__write(BOOK_PATH, BOOK_SIZE, SHAPE_SQUARE, board_key, 3, entries, 3) == 0);
+
+    struct book_t* book = book__open(BOOK_PATH);
+    assert(book);
+    assert(book__get_header(book)->size == BOOK_SIZE && book__get_header(book)->depth == 3 && book__get_header(book)->nb_entries == 3);
+    assert(book__get_header(book)->board_shape == SHAPE_SQUARE && book__get_header(book)->board_key == board_key);
+    size_t nb_entries;
+    const struct book_entry* found = book__find(book, key, &nb_entries);
+    assert(found && nb_entries == 2);
+    assert(found[0].score == 2.5f && found[1].score == 1.f);
+    assert(book__find(book, key ^ 2, &nb_entries) == NULL && nb_entries == 0);
+
+    // The best move is found on the board, and on any of its images
+    struct move_t move;
+    double score;
+    assert(book__probe(book, g, q, 1, &move, &score));
+    assert(move.queen_src == replies[7].queen_src && move.queen_dst == replies[7].queen_dst && move.arrow_dst == replies[7].arrow_dst);
+    assert(score == 2.5);
+    for (uint s = 1; s < BOOK__NB_SYMMETRIES; s++) {
+        struct graph_t* image_g;
+        struct queens_t* image_q;
+        first_position(s, first, &image_g, &image_q);
+        assert(book__probe(book, image_g, image_q, 1, &move, NULL));
+        assert(move__check(image_g, image_q, 1, move) == MOVE_REGULAR);
+        queens__free(image_q);
+        graph__free(image_g);
+    }
+
+    // Another position or board is not in the book
+    assert(!book__probe(book, g, q, 0, &move, NULL));
+    struct graph_t* small_g = tests__square_graph(BOOK_SIZE - 1);
+    struct queens_t* small_q = tests__initial_queens(BOOK_SIZE - 1);
+    assert(!book__probe(book, small_g, small_q, 1, &move, NULL));
+    book__close(book);
+
+    // A file which is not a book is rejected
+    FILE* file = fopen(BOOK_PATH, "wb");
+    fputs("not a book, but long enough for a header", file);
+    fclose(file);
+    assert(book__open(BOOK_PATH) == NULL);
+
+    // Nor is a board of the same size and another shape, even when its position has the same key, the clover cutting edges
+    struct shape_t* s = shape__new();
+    shape__init(s, 10, SHAPE_CLOVER);
+    struct graph_t* clover_g = graph__new();
+    shape__build_graph(s, clover_g);
+    struct graph_t* square_g = tests__square_graph(10);
+    for (uint pos = 0; pos < clover_g->num_vertices; pos++)
+        if (is_isolated(clover_g, pos))
+            graph__disconnect(square_g, pos); // Arrows on the holes of the clover
+    struct queens_t* clover_q = tests__initial_queens(10);
+    assert(book__key(clover_g, clover_q, 0, &symmetry) == book__key(square_g, clover_q, 0, NULL));
+    assert(book__board_key(clover_g) != book__board_key(square_g));
+    struct move_t clover_move;
+    assert(movegen__generate(clover_g, clover_q, 0, &clover_move, 1) > 0);
+    struct move_t key_move = book__to_key_frame(clover_move, 10, symmetry);
+    struct book_entry clover_entry = {book__key(clover_g, clover_q, 0, NULL), {key_move.queen_src, key_move.queen_dst, key_move.arrow_dst}, 0, 1.f, 0};
+    assert(book__write(BOOK_PATH, 10, SHAPE_SQUARE, book__board_key(square_g), 3, &clover_entry, 1) == 0);
+    book = book__open(BOOK_PATH);
+    assert(!book__probe(book, clover_g, clover_q, 0, &move, NULL));
+    book__close(book);
+    assert(book__write(BOOK_PATH, 10, SHAPE_CLOVER, book__board_key(clover_g), 3, &clover_entry, 1) == 0);
+    book = book__open(BOOK_PATH);
+    assert(book__probe(book, clover_g, clover_q, 0, &move, NULL));
+    assert(move.queen_src == clover_move.queen_src && move.queen_dst == clover_move.queen_dst && move.arrow_dst == clover_move.arrow_dst);
+    book__close(book);
+    remove(BOOK_PATH);
+
+    queens__free(clover_q);
+    graph__free(square_g);
+    graph__free(clover_g);
+    shape__delete(s);
+
+    queens__free(small_q);
+    graph__free(small_g);
+    queens__free(q);
+    graph__free(g);
+}
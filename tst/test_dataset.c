@@ -0,0 +1,143 @@
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dataset.h"
+#include "export.h"
+#include "tests_functions.h"
+#include "tests_utils.h"
+#include "tournament.h"
+
+#define DATASET_PATH "test_dataset.bin"
+
+struct func_block tests_list_dataset[] = {
+    {tests__dataset__load, "dataset__load"},
+    {tests__dataset__tournament, "dataset__open (tournament)"}};
+
+struct tests__functions tests__get_dataset_tests() {
+    return (struct tests__functions){2, tests_list_dataset};
+}
+
+static void remove_dataset() {
+    remove(DATASET_PATH);
+    remove(DATASET_PATH DATASET__INDEX_SUFFIX);
+}
+
+void tests__dataset__load() {
+    remove_dataset();
+    uint size = 9;
+    uint nb_queens = 2;
+    unsigned char cells[81] = {0};
+    cells[3] = EXPORT__QUEEN_1;
+    cells[70] = EXPORT__QUEEN_1;
+    cells[5] = EXPORT__QUEEN_2;
+    cells[64] = EXPORT__QUEEN_2;
+    cells[80] = EXPORT__BLOCKED;
+
+    dataset_writer writer = dataset__open(DATASET_PATH, SHAPE_SQUARE, size, nb_queens);
+    assert(writer);
+    dataset__add_position(writer, cells, 0, (struct move_t){3, 12, 13}, 0.5);
+    cells[3] = EXPORT__EMPTY;
+    cells[12] = EXPORT__QUEEN_1;
+    cells[13] = EXPORT__BLOCKED;
+    dataset__add_position(writer, cells, 1, create_initial_move(), NAN);
+    assert(dataset__end_game(writer, 7, 0) == 0);
+
+    // The positions of an unfinished game are dropped
+    dataset__add_position(writer, cells, 0, (struct move_t){12, 21, 30}, 0);
+    assert(dataset__close(writer) == 0);
+
+    // Another kind of board cannot be appended to the same file, the same one can
+    assert(dataset__open(DATASET_PATH, SHAPE_SQUARE, 8, nb_queens) == NULL);
+    writer = dataset__open(DATASET_PATH, SHAPE_SQUARE, size, nb_queens);
+    assert(writer);
+    dataset__add_position(writer, cells, 1, (struct move_t){64, 65, 66}, -1);
+    assert(dataset__end_game(writer, 8, 0) == 0);
+    assert(dataset__close(writer) == 0);
+
+    struct dataset_t* dataset = dataset__load(DATASET_PATH);
+    assert(dataset);
+    assert(dataset->header.size == size && dataset->header.nb_queens == nb_queens);
+    assert(dataset->header.position_size % sizeof(uint64_t) == 0);
+    assert(dataset->nb_positions == 3);
+    assert(dataset->nb_games == 2);
+    assert(dataset->games[0].first_position == 0 && dataset->games[0].nb_positions == 2 && dataset->games[0].seed == 7);
+    assert(dataset->games[1].first_position == 2 && dataset->games[1].nb_positions == 1 && dataset->games[1].seed == 8);
+
+    const struct dataset_position* first = dataset__get(dataset, 0);
+    assert(first->seed == 7 && first->ply == 0 && first->nb_plies == 2);
+    assert(first->side_to_move == 0 && first->result == 1);
+    assert(first->move[0] == 3 && first->move[1] == 12 && first->move[2] == 13);
+    assert(first->score == 0.5f);
+    assert(dataset__is_blocked(first, 80) && !dataset__is_blocked(first, 13));
+    assert(dataset__get_queens(dataset, first, 0)[0] == 3 && dataset__get_queens(dataset, first, 0)[1] == 70);
+    assert(dataset__get_queens(dataset, first, 1)[0] == 5 && dataset__get_queens(dataset, first, 1)[1] == 64);
+
+    const struct dataset_position* second = dataset__get(dataset, 1);
+    assert(second->ply == 1 && second->side_to_move == 1 && second->result == -1);
+    assert(second->move[0] == DATASET__NO_COORD && isnan(second->score));
+    assert(dataset__is_blocked(second, 13));
+    assert(dataset__get_queens(dataset, second, 0)[0] == 12);
+
+    const struct dataset_position* third = dataset__get(dataset, 2);
+    assert(third->seed == 8 && third->ply == 0 && third->result == -1 && third->score == -1);
+    dataset__free(dataset);
+
+    // A file which is not a dataset is rejected
+    FILE* file = fopen(DATASET_PATH, "wb");
+    fputs("not a dataset, but long enough for a header", file);
+    fclose(file);
+    assert(dataset__load(DATASET_PATH) == NULL);
+    remove_dataset();
+}
+
+void tests__dataset__tournament() {
+    remove_dataset();
+    struct game_config config = game__default_config();
+    config.size = 6;
+    config.seed = 11;
+    config.opening_moves = 4;
+    struct tournament_config tournament = {2, 2, 0, DATASET_PATH};
+    struct tournament_result result;
+    tournament__play(&config, &tournament, "./install/hagrid.so", "./install/heroine.so", &result);
+    assert(result.nb_games == 2);
+
+    struct dataset_t* dataset = dataset__load(DATASET_PATH);
+    assert(dataset);
+    assert(dataset->nb_games == 2);
+    size_t nb_positions = 0;
+    for (uint game_id = 0; game_id < dataset->nb_games; game_id++) {
+        const struct dataset_game* game = &dataset->games[game_id];
+        nb_positions += game->nb_positions;
+        for (uint ply = 0; ply < game->nb_positions; ply++) {
+            const struct dataset_position* position = dataset__get(dataset, game->first_position + ply);
+            assert(position->seed == game->seed && position->ply == ply && position->nb_plies == game->nb_positions);
+            assert(position->result == 1 || position->result == -1);
+
+            // Hagrid is player 1 of every game, and only it gives a score
+            assert(!isnan(position->score) == (position->side_to_move == PLAYER_1));
+
+            // The random opening shot 4 arrows before the first position
+            uint nb_blocked = 0;
+            for (uint pos = 0; pos < dataset->header.size * dataset->header.size; pos++)
+                nb_blocked += dataset__is_blocked(position, pos);
+            if (!ply)
+                assert(nb_blocked == 4);
+
+            if (ply + 1 < game->nb_positions) {
+                const struct dataset_position* next = dataset__get(dataset, game->first_position + ply + 1);
+                assert(next->side_to_move != position->side_to_move && next->result == -position->result);
+                assert(dataset__is_blocked(next, position->move[2]));
+                int has_moved = 0;
+                for (uint i = 0; i < dataset->header.nb_queens; i++)
+                    has_moved |= dataset__get_queens(dataset, next, position->side_to_move)[i] == position->move[1];
+                assert(has_moved);
+            }
+        }
+    }
+    assert(nb_positions == dataset->nb_positions);
+    dataset__free(dataset);
+    remove_dataset();
+}
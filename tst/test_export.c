@@ -0,0 +1,97 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "export.h"
+#include "tests_functions.h"
+#include "tests_utils.h"
+
+#define EXPORT_TEST_DIR "./export_test"
+
+struct func_block tests_list_export[] = {
+    {tests__export__write, "export__write"},
+    {tests__export__log, "export__log_open"}};
+
+struct tests__functions tests__get_export_tests() {
+    return (struct tests__functions){2, tests_list_export};
+}
+
+static long file_size(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file)
+        return -1;
+    unsigned char signature[8];
+    size_t read = fread(signature, 1, sizeof(signature), file);
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    return read == sizeof(signature) && !memcmp(signature, "\x89PNG\r\n\x1a\n", 8) ? size : -1;
+}
+
+void tests__export__write() {
+    uint size = 6;
+    unsigned char cells[36] = {0};
+    struct export_t* export = export__new(size);
+
+    cells[0] = EXPORT__BLOCKED;
+    cells[7] = EXPORT__QUEEN_1;
+    cells[28] = EXPORT__QUEEN_2;
+    export__add_frame(export, cells);
+    for (uint turn = 1; turn < 5; turn++) {
+        cells[7 + turn - 1] = EXPORT__EMPTY;
+        cells[7 + turn] = EXPORT__QUEEN_1;
+        cells[20 + turn] = EXPORT__BLOCKED;
+        export__add_frame(export, cells);
+    }
+
+    export__create_dir(EXPORT_TEST_DIR);
+    assert(export__write(export, EXPORT_TEST_DIR, 3) == 0);
+    export__free(export);
+
+    long frame_sizes = 0;
+    for (uint turn = 0; turn < 5; turn++) {
+        char path[64];
+        sprintf(path, "%s/%u.png", EXPORT_TEST_DIR, turn);
+        long frame_size = file_size(path);
+        assert(frame_size > 0);
+        frame_sizes += frame_size;
+    }
+
+    // The animation holds every frame, compressed as the single images
+    long animation_size = file_size(EXPORT_TEST_DIR "/animation.png");
+    assert(animation_size > frame_sizes / 2);
+    export__remove_dir(EXPORT_TEST_DIR);
+}
+
+void tests__export__log() {
+    uint size = 4;
+    unsigned char cells[16] = {0};
+    cells[5] = EXPORT__BLOCKED;
+    cells[1] = EXPORT__QUEEN_1;
+    cells[2] = EXPORT__QUEEN_1;
+    cells[14] = EXPORT__QUEEN_2;
+    const char* names[NUM_PLAYERS] = {"Ann \"A\"", "Bob"};
+
+    struct export_log_t* export_log = export__log_open(EXPORT_TEST_DIR ".jsonl", size, cells, names, 7, 1);
+    assert(export_log);
+    export__log_move(export_log, (struct move_t){14, 10, 15});
+    export__log_move(export_log, (struct move_t){1, 0, 4});
+    assert(export__log_close(export_log, 1, 0) == 0);
+
+    const char* expected[] = {
+        "{\"size\":4,\"seed\":7,\"players\":[\"Ann \\\"A\\\"\",\"Bob\"],\"starting_player\":1,\"holes\":[5],\"queens\":[[1,2],[14]]}\n",
+        "{\"turn\":0,\"player\":1,\"queen_src\":14,\"queen_dst\":10,\"arrow_dst\":15}\n",
+        "{\"turn\":1,\"player\":0,\"queen_src\":1,\"queen_dst\":0,\"arrow_dst\":4}\n",
+        "{\"winner\":1,\"forfeit\":false,\"nb_moves\":2}\n"};
+    FILE* file = fopen(EXPORT_TEST_DIR ".jsonl", "r");
+    assert(file);
+    char line[256];
+    for (uint i = 0; i < sizeof(expected) / sizeof(expected[0]); i++) {
+        assert(fgets(line, sizeof(line), file));
+        assert(!strcmp(line, expected[i]));
+    }
+    assert(!fgets(line, sizeof(line), file));
+    fclose(file);
+    remove(EXPORT_TEST_DIR ".jsonl");
+}
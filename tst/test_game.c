@@ -15,10 +15,16 @@ struct func_block tests_list_game[] = {
     {tests__game__current_player, "game__get_current_player"},
     {tests__game__default_config, "game__default_config"},
     {tests__game__play, "game__play"},
-    {tests__game__get_winner, "game__get_winner"}};
+    {tests__game__get_winner, "game__get_winner"},
+    {tests__game__is_forfeit, "game__is_forfeit"},
+    {tests__game__time_control, "game__play (time control)"},
+    {tests__game__isolation, "game__play (isolated clients)"},
+    {tests__game__hang, "game__init (hanging client)"},
+    {tests__game__ponder, "game__play (pondering clients)"},
+    {tests__game__seed, "game__init (seeds of the clients)"}};
 
 struct tests__functions tests__get_game_tests() {
-    return (struct tests__functions){9, tests_list_game};
+    return (struct tests__functions){15, tests_list_game};
 }
 
 void tests__game__new() {
@@ -126,3 +132,157 @@ void tests__game__get_winner() {
     assert(game__get_winner(g) == UNDEFINED_PLAYER);
     game__delete(g);
 }
+
+void tests__game__is_forfeit() {
+    game g = game__new();
+    struct game_config config = {
+        .size = 8,
+        .starting_player = PLAYER_1,
+        .seed = 0,
+        .board_shape = SHAPE_SQUARE,
+    };
+    game__init(g, &config, "./install/hagrid.so", "./install/heroine.so");
+    assert(!game__is_forfeit(g));
+    while (!game__is_over(g)) {
+        game__play(g);
+        game__next_player(g);
+    }
+    assert(game__get_winner(g) != UNDEFINED_PLAYER);
+    assert(!game__is_forfeit(g));
+    game__delete(g);
+}
+
+void tests__game__time_control() {
+    game g = game__new();
+    struct game_config config = {
+        .size = 8,
+        .starting_player = PLAYER_1,
+        .seed = 0,
+        .board_shape = SHAPE_SQUARE,
+        .move_time = 1e-9,
+    };
+    game__init(g, &config, "./install/hagrid.so", "./install/heroine.so");
+    game__play(g);
+    assert(game__is_over(g));
+    assert(game__get_winner(g) == PLAYER_2);
+    assert(game__is_forfeit(g));
+    game__delete(g);
+
+    g = game__new();
+    config.move_time = 0;
+    config.game_time = 60;
+    game__init(g, &config, "./install/hagrid.so", "./install/heroine.so");
+    game__play(g);
+    game__next_player(g);
+    assert(!game__is_over(g));
+    game__delete(g);
+}
+
+// Plays a whole game, returns the number of moves played
+static uint play_game(struct game_config* config, const char* lib_player1, const char* lib_player2, enum player_n* winner) {
+    game g = game__new();
+    game__init(g, config, lib_player1, lib_player2);
+    uint nb_moves = 0;
+    while (!game__is_over(g)) {
+        game__play(g);
+        game__next_player(g);
+        nb_moves++;
+    }
+    *winner = game__get_winner(g);
+    game__delete(g);
+    return nb_moves;
+}
+
+void tests__game__isolation() {
+    struct game_config config = {
+        .size = 8,
+        .starting_player = PLAYER_1,
+        .seed = 5,
+        .board_shape = SHAPE_SQUARE,
+    };
+
+    // The isolated clients play the same game
+    enum player_n expected_winner, winner;
+    uint expected_nb_moves = play_game(&config, "./install/handy_cape.so", "./install/heroine.so", &expected_winner);
+    config.isolate_clients = 1;
+    config.client_memory = 256;
+    assert(play_game(&config, "./install/handy_cape.so", "./install/heroine.so", &winner) == expected_nb_moves);
+    assert(winner == expected_winner);
+
+    // A crashing client loses the game instead of killing the server
+    game g = game__new();
+    game__init(g, &config, "./install/tst/client_crash.so", "./install/heroine.so");
+    game__play(g);
+    assert(game__is_over(g));
+    assert(game__get_winner(g) == PLAYER_2);
+    assert(game__is_forfeit(g));
+    game__delete(g);
+}
+
+void tests__game__hang() {
+    struct game_config config = {
+        .size = 8,
+        .starting_player = PLAYER_1,
+        .seed = 5,
+        .board_shape = SHAPE_SQUARE,
+        .isolate_clients = 1,
+        .init_time = 1,
+    };
+
+    // A client hanging in its initialization is killed, and loses the game once it is its turn
+    game g = game__new();
+    game__init(g, &config, "./install/heroine.so", "./install/tst/client_hang.so");
+    game__play(g);
+    assert(!game__is_over(g));
+    game__next_player(g);
+    game__play(g);
+    assert(game__is_over(g));
+    assert(game__get_winner(g) == PLAYER_1);
+    assert(game__is_forfeit(g));
+    game__delete(g);
+}
+
+void tests__game__ponder() {
+    struct game_config config = {
+        .size = 6,
+        .starting_player = PLAYER_1,
+        .seed = 3,
+        .board_shape = SHAPE_SQUARE,
+    };
+
+    // Without time control, a client pondering only finds earlier the moves it would have played anyway
+    enum player_n expected_winner, winner;
+    uint expected_nb_moves = play_game(&config, "./install/hagrid.so", "./install/heroine.so", &expected_winner);
+    config.ponder = 1;
+    assert(play_game(&config, "./install/hagrid.so", "./install/heroine.so", &winner) == expected_nb_moves);
+    assert(winner == expected_winner);
+    config.isolate_clients = 1;
+    assert(play_game(&config, "./install/hagrid.so", "./install/heroine.so", &winner) == expected_nb_moves);
+    assert(winner == expected_winner);
+}
+
+// The score of the first move of a player, drawn from its generator
+static double first_score(struct game_config* config, enum player_n player_id) {
+    config->starting_player = player_id;
+    game g = game__new();
+    game__init(g, config, "./install/tst/client_seed.so", "./install/tst/client_seed.so");
+    game__play(g);
+    assert(game__get_current_player(g) == player_id && game__is_forfeit(g));
+    double score = game__get_move_score(g);
+    game__delete(g);
+    return score;
+}
+
+void tests__game__seed() {
+    struct game_config config = {
+        .size = 8,
+        .seed = 11,
+        .board_shape = SHAPE_SQUARE,
+    };
+
+    // Two isolated instances of a library get their own seeds, each forked once it was given its seed
+    config.isolate_clients = 1;
+    double first_player_score = first_score(&config, PLAYER_1);
+    assert(first_player_score != first_score(&config, PLAYER_2));
+    assert(first_player_score == first_score(&config, PLAYER_1));
+}
@@ -3,6 +3,8 @@
 #include <stdlib.h>
 
 #include "graph.h"
+#include "shape.h"
+#include "tests_boards.h"
 #include "tests_functions.h"
 #include "tests_utils.h"
 
@@ -10,10 +12,13 @@ struct func_block tests_list_graph[] = {
     {tests__graph__init, "graph__init"},
     {tests__graph__free, "graph__free"},
     {tests__graph__copy, "graph__copy"},
-    {tests__graph__compress, "graph__compress"}};
+    {tests__graph__compress, "graph__compress"},
+    {tests__graph__get_neighbor, "graph__get_neighbor"},
+    {tests__graph__disconnect, "graph__disconnect"},
+    {tests__graph__get_direction, "graph__get_direction"}};
 
 struct tests__functions tests__get_graph_tests() {
-    return (struct tests__functions){4, tests_list_graph};
+    return (struct tests__functions){7, tests_list_graph};
 }
 
 void tests__graph__init() {
@@ -54,4 +59,79 @@ void tests__graph__compress() {
     gsl_spmatrix_uint_free(tmp);
     graph__free(g);
     graph__free(g1);
+}
+
+void tests__graph__get_neighbor() {
+    struct graph_t* g = tests__square_graph(5);
+    assert(graph__get_neighbor(g, 12, DIR_NORTH) == 7);
+    assert(graph__get_neighbor(g, 12, DIR_NE) == 8);
+    assert(graph__get_neighbor(g, 12, DIR_EAST) == 13);
+    assert(graph__get_neighbor(g, 12, DIR_SE) == 18);
+    assert(graph__get_neighbor(g, 12, DIR_SOUTH) == 17);
+    assert(graph__get_neighbor(g, 12, DIR_SW) == 16);
+    assert(graph__get_neighbor(g, 12, DIR_WEST) == 11);
+    assert(graph__get_neighbor(g, 12, DIR_NW) == 6);
+    assert(graph__get_neighbor(g, 0, DIR_NORTH) == GRAPH__NO_NEIGHBOR);
+    assert(graph__get_neighbor(g, 0, DIR_WEST) == GRAPH__NO_NEIGHBOR);
+    assert(graph__get_neighbor(g, UINT_MAX, DIR_EAST) == UINT_MAX);
+    graph__free(g);
+}
+
+void tests__graph__disconnect() {
+    struct graph_t* g = tests__square_graph(5);
+    graph__disconnect(g, 12);
+    assert(is_isolated(g, 12));
+    for (enum dir_t d = FIRST_DIR; d <= LAST_DIR; d++)
+        assert(graph__get_neighbor(g, 12, d) == GRAPH__NO_NEIGHBOR);
+    assert(graph__get_neighbor(g, 7, DIR_SOUTH) == GRAPH__NO_NEIGHBOR);
+    assert(graph__get_neighbor(g, 18, DIR_NW) == GRAPH__NO_NEIGHBOR);
+    assert(graph__get_neighbor(g, 16, DIR_NE) == GRAPH__NO_NEIGHBOR);
+    assert(graph__get_neighbor(g, 7, DIR_NORTH) == 2);
+
+    struct graph_t* g1 = graph__copy(g);
+    assert(is_isolated(g1, 12));
+    assert(graph__get_neighbor(g1, 11, DIR_EAST) == GRAPH__NO_NEIGHBOR);
+    assert(gsl_spmatrix_uint_get(g->t, 11, 12) == NO_DIR);
+    graph__free(g1);
+    graph__free(g);
+
+    // A path of three vertices, which is not a square board
+    g = graph__new();
+    graph__init(g, 3);
+    gsl_spmatrix_uint_set(g->t, 0, 1, DIR_EAST);
+    gsl_spmatrix_uint_set(g->t, 1, 0, DIR_WEST);
+    gsl_spmatrix_uint_set(g->t, 1, 2, DIR_EAST);
+    gsl_spmatrix_uint_set(g->t, 2, 1, DIR_WEST);
+    graph__compress(g);
+    for (int k = 0; k < g->t->p[3]; k++)
+        assert(g->twins[g->twins[k]] == k);
+    graph__disconnect(g, 1);
+    assert(is_isolated(g, 0));
+    assert(is_isolated(g, 1));
+    assert(is_isolated(g, 2));
+    assert(gsl_spmatrix_uint_get(g->t, 0, 1) == NO_DIR);
+    assert(gsl_spmatrix_uint_get(g->t, 2, 1) == NO_DIR);
+    graph__free(g);
+}
+
+void tests__graph__get_direction() {
+    struct graph_t* g = tests__square_graph(5);
+    assert(g->width == 5);
+    assert(graph__get_direction(g, 12, 2) == DIR_NORTH);
+    assert(graph__get_direction(g, 12, 24) == DIR_SE);
+    assert(graph__get_direction(g, 12, 10) == DIR_WEST);
+    assert(graph__get_direction(g, 12, 16) == DIR_SW);
+    assert(graph__get_direction(g, 12, 4) == DIR_NE);
+    assert(graph__get_direction(g, 12, 3) == NO_DIR);
+    assert(graph__get_direction(g, 12, 12) == NO_DIR);
+    assert(graph__get_direction(g, 4, 5) == NO_DIR);
+    graph__free(g);
+
+    g = graph__new();
+    graph__init(g, 2);
+    gsl_spmatrix_uint_set(g->t, 0, 1, DIR_EAST);
+    graph__compress(g);
+    assert(g->width == 0);
+    assert(graph__get_direction(g, 0, 1) == DIR_ERROR);
+    graph__free(g);
 }
\ No newline at end of file
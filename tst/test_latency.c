@@ -0,0 +1,87 @@
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "game.h"
+#include "latency.h"
+#include "tests_functions.h"
+#include "tests_utils.h"
+
+struct func_block tests_list_latency[] = {
+    {tests__latency__percentile, "latency__percentile"},
+    {tests__latency__merge, "latency__merge"},
+    {tests__latency__game, "game__get_stats"}};
+
+struct tests__functions tests__get_latency_tests() {
+    return (struct tests__functions){3, tests_list_latency};
+}
+
+// The bucket bounds are 2^(1/LATENCY__BUCKETS_PER_OCTAVE) apart
+static int is_close(double estimate, double exact) {
+    return estimate >= exact && estimate <= exact * exp2(1.0 / LATENCY__BUCKETS_PER_OCTAVE) * 1.0001;
+}
+
+void tests__latency__percentile() {
+    struct latency_histogram histogram = {0};
+    assert(latency__percentile(&histogram, 50) == 0);
+
+    // 1 ms to 100 ms
+    for (uint i = 1; i <= 100; i++)
+        latency__add(&histogram, i * 1e-3);
+    assert(histogram.nb_samples == 100);
+    assert(fabs(histogram.total - 5.05) < 1e-9);
+    assert(histogram.max == 0.1);
+    assert(is_close(latency__percentile(&histogram, 50), 0.05));
+    assert(is_close(latency__percentile(&histogram, 90), 0.09));
+    assert(is_close(latency__percentile(&histogram, 99), 0.099));
+    assert(latency__percentile(&histogram, 100) == 0.1);
+
+    // Out of range durations land in the first and the last bucket
+    latency__add(&histogram, 0);
+    latency__add(&histogram, 1e6);
+    assert(histogram.counts[0] == 1);
+    assert(histogram.counts[LATENCY__NB_BUCKETS - 1] == 1);
+    assert(latency__percentile(&histogram, 100) == 1e6);
+}
+
+void tests__latency__merge() {
+    struct latency_histogram fast = {0};
+    struct latency_histogram slow = {0};
+    for (uint i = 0; i < 90; i++)
+        latency__add(&fast, 1e-5);
+    for (uint i = 0; i < 10; i++)
+        latency__add(&slow, 1.0);
+
+    latency__merge(&fast, &slow);
+    assert(fast.nb_samples == 100);
+    assert(fast.max == 1.0);
+    assert(is_close(latency__percentile(&fast, 90), 1e-5));
+    assert(is_close(latency__percentile(&fast, 91), 1.0));
+}
+
+void tests__latency__game() {
+    game g = game__new();
+    struct game_config config = {
+        .size = 8,
+        .starting_player = PLAYER_1,
+        .seed = 4,
+        .board_shape = SHAPE_SQUARE,
+    };
+    game__init(g, &config, "./install/handy_cape.so", "./install/heroine.so");
+
+    uint nb_moves = 0;
+    while (!game__is_over(g)) {
+        game__play(g);
+        game__next_player(g);
+        nb_moves++;
+    }
+
+    // Every move is timed, the last one being checked but only played if valid
+    const struct latency_stats* stats = game__get_stats(g);
+    assert(stats->think[PLAYER_1].nb_samples + stats->think[PLAYER_2].nb_samples == nb_moves);
+    assert(stats->check_move.nb_samples == nb_moves);
+    assert(stats->board_update.nb_samples == nb_moves - game__is_forfeit(g));
+    assert(stats->is_over.nb_samples == nb_moves + 1);
+    game__delete(g);
+}
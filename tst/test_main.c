@@ -73,7 +73,19 @@ int main(void) {
     execute_tests(tests__get_game_tests());
     execute_tests(tests__get_graph_tests());
     execute_tests(tests__get_queens_tests());
+    execute_tests(tests__get_move_tests());
     execute_tests(tests__get_shape_tests());
+    execute_tests(tests__get_bitboard_tests());
+    execute_tests(tests__get_movegen_tests());
+    execute_tests(tests__get_tournament_tests());
+    execute_tests(tests__get_board_desc_tests());
+    execute_tests(tests__get_record_tests());
+    execute_tests(tests__get_export_tests());
+    execute_tests(tests__get_latency_tests());
+    execute_tests(tests__get_dataset_tests());
+    execute_tests(tests__get_rng_tests());
+    execute_tests(tests__get_book_tests());
+    execute_tests(tests__get_board_cache_tests());
 
     print_summary();
 
@@ -0,0 +1,105 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "move.h"
+#include "queens.h"
+#include "shape.h"
+#include "tests_boards.h"
+#include "tests_functions.h"
+#include "tests_utils.h"
+#include "zobrist.h"
+
+struct func_block tests_list_move[] = {
+    {tests__move__make, "move__make"},
+    {tests__move__unmake, "move__unmake"},
+    {tests__move__position_key, "move__position_key"}};
+
+struct tests__functions tests__get_move_tests() {
+    return (struct tests__functions){3, tests_list_move};
+}
+
+void tests__move__make() {
+    struct graph_t* g = tests__square_graph(10);
+    struct queens_t* q = tests__initial_queens(10);
+    struct move_undo_t undo;
+
+    move__make(g, q, 0, (struct move_t){10, 14, 44}, &undo);
+    assert(q->array[0][0] == 14);
+    assert(is_isolated(g, 44));
+    assert(graph__get_neighbor(g, 34, DIR_SOUTH) == GRAPH__NO_NEIGHBOR);
+
+    move__make(g, q, 1, create_initial_move(), &undo);
+    assert(!undo.is_played);
+
+    queens__free(q);
+    graph__free(g);
+}
+
+void tests__move__unmake() {
+    struct graph_t* g = tests__square_graph(10);
+    struct graph_t* ref = graph__copy(g);
+    struct queens_t* q = tests__initial_queens(10);
+    struct move_t moves[] = {{10, 14, 44}, {89, 85, 45}, {14, 24, 14}, {85, 75, 45}};
+    struct move_undo_t undo[4];
+
+    for (uint i = 0; i < 4; i++)
+        move__make(g, q, i % 2, moves[i], &undo[i]);
+    for (int i = 3; i >= 0; i--)
+        move__unmake(g, q, &undo[i]);
+
+    assert(gsl_spmatrix_uint_equal(g->t, ref->t));
+    assert(!memcmp(g->neighbors, ref->neighbors, g->num_vertices * NUM_DIRS * sizeof(uint)));
+    assert(q->array[0][0] == 10);
+    assert(q->array[1][0] == 89);
+
+    queens__free(q);
+    graph__free(ref);
+    graph__free(g);
+}
+
+// Computes the key of a position from scratch
+static uint64_t full_key(struct graph_t* g, struct queens_t* q, uint player_id) {
+    uint64_t key = player_id ? zobrist__side() : 0;
+    for (uint pos = 0; pos < g->num_vertices; pos++)
+        if (is_isolated(g, pos))
+            key ^= zobrist__blocked(pos);
+    for (uint p = 0; p < 2; p++)
+        for (uint i = 0; i < q->nb_queens; i++)
+            key ^= zobrist__queen(p, q->array[p][i]);
+    return key;
+}
+
+void tests__move__position_key() {
+    struct graph_t* g = tests__square_graph(10);
+    struct queens_t* q = tests__initial_queens(10);
+    // The last arrow leaves 0 without any edge
+    struct move_t moves[] = {{10, 14, 11}, {89, 85, 45}, {1, 21, 10}, {85, 75, 46}, {21, 31, 1}};
+    struct move_undo_t undo[5];
+    uint64_t keys[6];
+
+    keys[0] = move__position_key(g, q, 0);
+    assert(keys[0] == full_key(g, q, 0));
+    assert(keys[0] != move__position_key(g, q, 1));
+    for (uint i = 0; i < 5; i++) {
+        move__make(g, q, i % 2, moves[i], &undo[i]);
+        keys[i + 1] = move__position_key(g, q, (i + 1) % 2);
+        assert(keys[i + 1] == full_key(g, q, (i + 1) % 2));
+        assert(keys[i + 1] != keys[i]);
+    }
+    assert(is_isolated(g, 0));
+    for (int i = 4; i >= 0; i--) {
+        move__unmake(g, q, &undo[i]);
+        assert(move__position_key(g, q, i % 2) == keys[i]);
+    }
+
+    struct queens_t* q1 = tests__initial_queens(10);
+    move_queen(q1, 0, moves[0]);
+    graph__disconnect(g, moves[0].arrow_dst);
+    assert(move__position_key(g, q1, 1) == keys[1]);
+
+    queens__free(q1);
+    queens__free(q);
+    graph__free(g);
+}
@@ -0,0 +1,122 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "movegen.h"
+#include "player.h"
+#include "shape.h"
+#include "tests_boards.h"
+#include "tests_functions.h"
+#include "tests_utils.h"
+
+struct func_block tests_list_movegen[] = {
+    {tests__movegen__targets, "movegen__targets"},
+    {tests__movegen__generate, "movegen__generate"},
+    {tests__movegen__count, "movegen__count"}};
+
+struct tests__functions tests__get_movegen_tests() {
+    return (struct tests__functions){3, tests_list_movegen};
+}
+
+// Checks a move the way the server does, the arrow being shot once the queen has moved
+static int is_legal(struct graph_t* g, struct queens_t* q, uint player_id, struct move_t m) {
+    if (!is_valid_move_for_player(g, q, player_id, m.queen_src, m.queen_dst, 0))
+        return 0;
+    move_queen(q, player_id, m);
+    int ret = can_reach_position(g, q, m.queen_dst, m.arrow_dst) > 0;
+    move_queen(q, player_id, (struct move_t){m.queen_dst, m.queen_src, m.arrow_dst});
+    return ret;
+}
+
+void tests__movegen__targets() {
+    struct graph_t* g = tests__square_graph(10);
+    struct queens_t* q = tests__initial_queens(10);
+    uint* out = malloc(sizeof(uint) * g->num_vertices);
+    uint src = q->array[0][0];
+
+    uint count = movegen__targets(g, q, src, MOVEGEN__NO_VACATED, out);
+    assert(count == movegen__targets(g, q, src, MOVEGEN__NO_VACATED, NULL));
+    uint expected = 0;
+    for (uint i = 0; i < g->num_vertices; i++)
+        expected += can_reach_position(g, q, src, i) > 0;
+    assert(count == expected);
+    for (uint i = 0; i < count; i++)
+        assert(can_reach_position(g, q, src, out[i]));
+
+    // A ray stops before a queen unless the queen is the vacated one
+    uint south = graph__get_neighbor(g, src, DIR_SOUTH);
+    uint north = graph__get_neighbor(g, src, DIR_NORTH);
+    assert(movegen__ray(g, q, south, DIR_NORTH, MOVEGEN__NO_VACATED, out) == 0);
+    assert(movegen__ray(g, q, south, DIR_NORTH, src, out) == 2);
+    assert(out[0] == src && out[1] == north);
+
+    free(out);
+    queens__free(q);
+    graph__free(g);
+}
+
+void tests__movegen__generate() {
+    struct graph_t* g = tests__square_graph(6);
+    struct queens_t* q = tests__initial_queens(6);
+    size_t count = movegen__generate(g, q, 0, NULL, 0);
+    struct move_t* out = malloc(sizeof(struct move_t) * (count + 1));
+
+    assert(movegen__generate(g, q, 0, out, count) == count);
+    for (size_t i = 0; i < count; i++)
+        assert(is_legal(g, q, 0, out[i]));
+
+    size_t expected = 0;
+    for (uint src = 0; src < g->num_vertices; src++)
+        for (uint dst = 0; dst < g->num_vertices; dst++)
+            for (uint arrow = 0; arrow < g->num_vertices; arrow++)
+                expected += is_legal(g, q, 0, (struct move_t){src, dst, arrow});
+    assert(count == expected);
+
+    // The arrow may fly through the vertex the queen left
+    uint src = q->array[0][0];
+    struct move_t through = {src, graph__get_neighbor(g, src, DIR_SOUTH), graph__get_neighbor(g, src, DIR_NORTH)};
+    int found = 0;
+    for (size_t i = 0; i < count; i++)
+        found |= out[i].queen_src == through.queen_src && out[i].queen_dst == through.queen_dst && out[i].arrow_dst == through.arrow_dst;
+    assert(found);
+
+    // Moves beyond the capacity are counted but not written
+    out[3] = (struct move_t){0, 0, 0};
+    assert(movegen__generate(g, q, 0, out, 3) == count);
+    assert(out[3].queen_src == 0 && out[3].queen_dst == 0 && out[3].arrow_dst == 0);
+
+    free(out);
+    queens__free(q);
+    graph__free(g);
+}
+
+void tests__movegen__count() {
+    struct graph_t* g = tests__square_graph(10);
+    struct queens_t* q = tests__initial_queens(10);
+
+    for (uint player_id = 0; player_id < NUM_PLAYERS; player_id++)
+        assert(movegen__count(g, q, player_id) == movegen__generate(g, q, player_id, NULL, 0));
+
+    struct move_undo_t undo;
+    move__make(g, q, 0, (struct move_t){10, 14, 10}, &undo);
+    assert(movegen__count(g, q, 1) == movegen__generate(g, q, 1, NULL, 0));
+    move__unmake(g, q, &undo);
+
+    queens__free(q);
+    graph__free(g);
+
+    // The arrows along the line of a move are counted at once, on boards cutting some lines too
+    char shapes[] = {SHAPE_DONUT, SHAPE_CLOVER, SHAPE_EIGHT};
+    for (uint shape_id = 0; shape_id < sizeof(shapes); shape_id++) {
+        struct shape_t* s = shape__new();
+        shape__init(s, 12, shapes[shape_id]);
+        g = graph__new();
+        shape__build_graph(s, g);
+        q = tests__initial_queens(shape__get_size(s));
+        for (uint player_id = 0; player_id < NUM_PLAYERS; player_id++)
+            assert(movegen__count(g, q, player_id) == movegen__generate(g, q, player_id, NULL, 0));
+        queens__free(q);
+        graph__free(g);
+        shape__delete(s);
+    }
+}
@@ -12,10 +12,11 @@ struct func_block tests_list_queens[] = {
     {tests__queens__init, "queens__init"},
     {tests__queens__alloc, "queens__alloc"},
     {tests__queens__copy, "queens__copy"},
+    {tests__queens__move, "queens__move"},
     {tests__queens__free, "queens__free"}};
 
 struct tests__functions tests__get_queens_tests() {
-    return (struct tests__functions){5, tests_list_queens};
+    return (struct tests__functions){6, tests_list_queens};
 }
 
 void tests__queens__new() {
@@ -62,6 +63,31 @@ void tests__queens__copy() {
     queens__free(q);
 }
 
+void tests__queens__move() {
+    struct queens_t* q = queens__new();
+    queens__alloc(q, 4);
+    queens__init(q, 10);
+    assert(queens__exist_queens(q, 10));
+    assert(queens__queen_exist_for_player(q, 0, 10));
+    assert(!queens__queen_exist_for_player(q, 1, 10));
+    assert(queens__get_queen_id(q, 1, 89) == 0);
+    assert(!queens__exist_queens(q, 11));
+    assert(!queens__exist_queens(q, UINT_MAX));
+
+    move_queen(q, 0, (struct move_t){10, 11, 12});
+    assert(q->array[0][0] == 11);
+    assert(!queens__exist_queens(q, 10));
+    assert(queens__queen_exist_for_player(q, 0, 11));
+    assert(queens__get_queen_id(q, 0, 11) == 0);
+
+    struct queens_t* copy = queens__new();
+    queens__copy(q, copy);
+    assert(queens__queen_exist_for_player(copy, 0, 11));
+    assert(!queens__exist_queens(copy, 10));
+    queens__free(copy);
+    queens__free(q);
+}
+
 void tests__queens__free() {
     struct queens_t* q = queens__new();
     queens__alloc(q, 4);
@@ -0,0 +1,221 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "movegen.h"
+#include "record.h"
+#include "shape.h"
+#include "tests_functions.h"
+#include "tests_utils.h"
+
+#define RECORD_PATH "test_record.rec"
+
+struct func_block tests_list_record[] = {
+    {tests__record__load, "record__load"},
+    {tests__record__truncated, "record__load (truncated)"},
+    {tests__record__seek, "record__seek"},
+    {tests__record__mask, "record__load (board file)"}};
+
+struct tests__functions tests__get_record_tests() {
+    return (struct tests__functions){4, tests_list_record};
+}
+
+// Plays a deterministic game of at most nb_moves moves on a clover board, writing it to RECORD_PATH
+static uint write_game(uint nb_moves, struct move_t* moves) {
+    uint size = 15;
+    struct shape_t* s = shape__new();
+    shape__init(s, size, SHAPE_CLOVER);
+    size = shape__get_size(s);
+    struct graph_t* g = graph__new();
+    graph__init(g, size * size);
+    shape__init_graph(s, g);
+    graph__compress(g);
+    shape__delete(s);
+    struct queens_t* q = queens__new();
+    queens__alloc(q, queens__default_count(size));
+    queens__init(q, size);
+
+    const char* names[NUM_PLAYERS] = {"first", "second"};
+    record_writer writer = record__open(RECORD_PATH, SHAPE_CLOVER, size, NULL, 42, 1, 0, names);
+    assert(writer);
+
+    struct move_t buffer[4096];
+    uint player_id = 1;
+    uint played = 0;
+    while (played < nb_moves) {
+        size_t count = movegen__generate(g, q, player_id, buffer, 4096);
+        if (count == 0)
+            break;
+        assert(count <= 4096);
+        struct move_t move = buffer[(played * 7919) % count];
+        move_queen(q, player_id, move);
+        graph__disconnect(g, move.arrow_dst);
+        record__write_move(writer, move);
+        moves[played++] = move;
+        player_id ^= 1;
+    }
+    assert(record__close(writer, player_id ^ 1, 0) == 0);
+
+    queens__free(q);
+    graph__free(g);
+    return played;
+}
+
+void tests__record__load() {
+    struct move_t moves[100];
+    uint nb_moves = write_game(100, moves);
+    assert(nb_moves > RECORD__CHECKPOINT_INTERVAL);
+
+    struct record_t* record = record__load(RECORD_PATH);
+    assert(record);
+    assert(record->is_complete);
+    assert(record->header.board_shape == SHAPE_CLOVER);
+    assert(record->header.seed == 42);
+    assert(record->header.starting_player == 1);
+    assert(!strcmp(record->header.names[0], "first"));
+    assert(!strcmp(record->header.names[1], "second"));
+    assert(record->header.coord_size == 2);
+    assert(record->nb_moves == nb_moves);
+    assert(record->winner == (int)(1 ^ (nb_moves & 1) ^ 1));
+    assert(!record->forfeit);
+    assert(record->nb_checkpoints == nb_moves / RECORD__CHECKPOINT_INTERVAL);
+    for (uint i = 0; i < nb_moves; i++) {
+        assert(record->moves[i].queen_src == moves[i].queen_src);
+        assert(record->moves[i].queen_dst == moves[i].queen_dst);
+        assert(record->moves[i].arrow_dst == moves[i].arrow_dst);
+    }
+
+    // Every recorded move is valid when replayed
+    struct graph_t* g = graph__new();
+    struct queens_t* q = queens__new();
+    record__init_position(record, g, q);
+    assert(record__replay(record, g, q, nb_moves) == nb_moves);
+
+    queens__free(q);
+    graph__free(g);
+    record__free(record);
+    remove(RECORD_PATH);
+}
+
+void tests__record__truncated() {
+    struct move_t moves[50];
+    uint nb_moves = write_game(50, moves);
+
+    // Keep the header and the first 10 moves and a half, as if the server had been killed
+    FILE* file = fopen(RECORD_PATH, "rb");
+    assert(file);
+    size_t size = sizeof(struct record_header) + 10 * 3 * sizeof(uint16_t) + 3;
+    char* data = malloc(size);
+    assert(fread(data, 1, size, file) == size);
+    fclose(file);
+    file = fopen(RECORD_PATH, "wb");
+    assert(fwrite(data, 1, size, file) == size);
+    fclose(file);
+    free(data);
+
+    struct record_t* record = record__load(RECORD_PATH);
+    assert(record);
+    assert(!record->is_complete);
+    assert(record->nb_moves == 10 && nb_moves > 10);
+    assert(record->nb_checkpoints == 0);
+    for (uint i = 0; i < record->nb_moves; i++)
+        assert(record->moves[i].arrow_dst == moves[i].arrow_dst);
+    record__free(record);
+
+    // A file which is not a record is rejected
+    file = fopen(RECORD_PATH, "wb");
+    fputs("not a record", file);
+    fclose(file);
+    assert(record__load(RECORD_PATH) == NULL);
+    remove(RECORD_PATH);
+}
+
+void tests__record__seek() {
+    struct move_t moves[120];
+    uint nb_moves = write_game(120, moves);
+    struct record_t* record = record__load(RECORD_PATH);
+    assert(record && record->nb_checkpoints >= 2);
+
+    uint turns[] = {0, 1, RECORD__CHECKPOINT_INTERVAL - 1, RECORD__CHECKPOINT_INTERVAL, 2 * RECORD__CHECKPOINT_INTERVAL + 5, nb_moves, nb_moves + 10};
+    for (uint i = 0; i < sizeof(turns) / sizeof(turns[0]); i++) {
+        struct graph_t* g1 = graph__new();
+        struct queens_t* q1 = queens__new();
+        struct graph_t* g2 = graph__new();
+        struct queens_t* q2 = queens__new();
+        record__init_position(record, g1, q1);
+        record__init_position(record, g2, q2);
+
+        uint turn = turns[i] > nb_moves ? nb_moves : turns[i];
+        assert(record__replay(record, g1, q1, turns[i]) == turn);
+        assert(record__seek(record, g2, q2, turns[i]) == turn);
+
+        // Both ways reach the same position, index included
+        assert(g1->key == g2->key);
+        assert(q1->key == q2->key);
+        for (uint player_id = 0; player_id < NUM_PLAYERS; player_id++)
+            assert(!memcmp(q1->array[player_id], q2->array[player_id], q1->nb_queens * sizeof(uint)));
+        for (uint pos = 0; pos < g1->num_vertices; pos++) {
+            assert(q1->owner[pos] == q2->owner[pos]);
+            for (enum dir_t d = FIRST_DIR; d <= LAST_DIR; d++)
+                assert(graph__get_neighbor(g1, pos, d) == graph__get_neighbor(g2, pos, d));
+        }
+
+        queens__free(q1);
+        graph__free(g1);
+        queens__free(q2);
+        graph__free(g2);
+    }
+
+    record__free(record);
+    remove(RECORD_PATH);
+}
+
+void tests__record__mask() {
+    // A 9x9 board whose center cells are holes, the queens starting on its border
+    uint size = 9;
+    unsigned char mask[81];
+    for (uint pos = 0; pos < size * size; pos++)
+        mask[pos] = pos / size < 3 || pos / size > 5 || pos % size < 3 || pos % size > 5;
+    struct shape_t* s = shape__new();
+    assert(shape__init_from_mask(s, size, mask) == 0);
+    struct graph_t* g = graph__new();
+    shape__build_graph(s, g);
+    shape__delete(s);
+    struct queens_t* q = queens__new();
+    queens__alloc(q, queens__default_count(size));
+    queens__init(q, size);
+
+    const char* names[NUM_PLAYERS] = {"first", "second"};
+    record_writer writer = record__open(RECORD_PATH, SHAPE_MASK, size, mask, 7, 0, 2, names);
+    assert(writer);
+    struct move_t moves[6];
+    for (uint i = 0; i < 6; i++) {
+        assert(movegen__generate(g, q, i % 2, &moves[i], 1) > 0);
+        move_queen(q, i % 2, moves[i]);
+        graph__disconnect(g, moves[i].arrow_dst);
+        record__write_move(writer, moves[i]);
+    }
+    assert(record__close(writer, 0, 0) == 0);
+    queens__free(q);
+    graph__free(g);
+
+    // The replay rebuilds the holes of the board, and plays the opening like the other moves
+    struct record_t* record = record__load(RECORD_PATH);
+    assert(record && record->is_complete);
+    assert(record->header.board_shape == SHAPE_MASK);
+    assert(record->header.nb_opening_moves == 2);
+    assert(record->mask && !memcmp(record->mask, mask, sizeof(mask)));
+    assert(record->nb_moves == 6);
+    g = graph__new();
+    q = queens__new();
+    record__init_position(record, g, q);
+    assert(is_isolated(g, 4 * size + 4));
+    assert(!is_isolated(g, 0));
+    assert(record__replay(record, g, q, 6) == 6);
+
+    queens__free(q);
+    graph__free(g);
+    record__free(record);
+    remove(RECORD_PATH);
+}
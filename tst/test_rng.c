@@ -0,0 +1,62 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "rng.h"
+#include "tests_functions.h"
+#include "tests_utils.h"
+
+struct func_block tests_list_rng[] = {
+    {tests__rng__next, "rng__next"},
+    {tests__rng__below, "rng__below"}};
+
+struct tests__functions tests__get_rng_tests() {
+    return (struct tests__functions){2, tests_list_rng};
+}
+
+void tests__rng__next() {
+    // The first draws of xoshiro256** seeded with splitmix64
+    struct rng_t rng;
+    rng__seed(&rng, 42);
+    assert(rng__next(&rng) == 0x15780b2e0c2ec716ULL);
+    assert(rng__next(&rng) == 0x6104d9866d113a7eULL);
+    assert(rng__next(&rng) == 0xae17533239e499a1ULL);
+
+    // The same seed gives the same draws, another one other draws
+    struct rng_t same, other;
+    rng__seed(&rng, 7);
+    rng__seed(&same, 7);
+    rng__seed(&other, 8);
+    int differs = 0;
+    for (uint i = 0; i < 100; i++) {
+        uint64_t draw = rng__next(&rng);
+        assert(rng__next(&same) == draw);
+        differs |= rng__next(&other) != draw;
+    }
+    assert(differs);
+
+    // Even a zero seed gives a valid state
+    rng__seed(&rng, 0);
+    assert(rng.state[0] || rng.state[1] || rng.state[2] || rng.state[3]);
+}
+
+void tests__rng__below() {
+    struct rng_t rng;
+    rng__seed(&rng, 3);
+    for (uint i = 0; i < 100; i++)
+        assert(rng__below(&rng, 1) == 0);
+
+    // Every number is drawn about as often as the others
+    uint counts[6] = {0};
+    for (uint i = 0; i < 60000; i++) {
+        uint draw = rng__below(&rng, 6);
+        assert(draw < 6);
+        counts[draw]++;
+    }
+    for (uint i = 0; i < 6; i++)
+        assert(counts[i] > 9500 && counts[i] < 10500);
+
+    // The largest bounds are handled without overflow
+    for (uint i = 0; i < 100; i++)
+        assert(rng__below(&rng, 0xffffffffu) < 0xffffffffu);
+}
@@ -1,22 +1,26 @@
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "shape.h"
 #include "tests_functions.h"
 #include "tests_utils.h"
 
+#define MASK_PATH "test_shape.board"
+
 struct func_block tests_list_shape[] = {
     {tests__shape__new, "shape__new"},
     {tests__shape__init, "shape__init"},
     {tests__shape__delete, "shape__delete"},
     {tests__shape__init_graph, "shape__init_graph"},
+    {tests__shape__init_from_file, "shape__init_from_file"},
     {tests__shape__get_board_shape, "shape__get_board_shape"},
     {tests__shape__get_size, "shape__get_size"},
 };
 
 struct tests__functions tests__get_shape_tests() {
-    return (struct tests__functions){6, tests_list_shape};
+    return (struct tests__functions){7, tests_list_shape};
 }
 
 void tests__shape__new() {
@@ -51,7 +55,78 @@ void tests__shape__delete() {
     shape__delete(s);
 }
 
+static void write_mask(const char* content, size_t length) {
+    FILE* file = fopen(MASK_PATH, "wb");
+    assert(file);
+    assert(fwrite(content, 1, length, file) == length);
+    fclose(file);
+}
+
 void tests__shape__init_graph() {
+    char shapes[SHAPE_COUNT] = {SHAPE_SQUARE, SHAPE_DONUT, SHAPE_CLOVER, SHAPE_EIGHT};
+    for (uint shape_id = 0; shape_id < SHAPE_COUNT; shape_id++) {
+        struct shape_t* s = shape__new();
+        shape__init(s, 20, shapes[shape_id]);
+        struct graph_t* expected = graph__new();
+        graph__init(expected, shape__get_size(s) * shape__get_size(s));
+        shape__init_graph(s, expected);
+        graph__compress(expected);
+
+        // The single pass builds the same graph as the triplet matrix
+        struct graph_t* g = graph__new();
+        shape__build_graph(s, g);
+        size_t nz = expected->t->p[expected->num_vertices];
+        assert(g->num_vertices == expected->num_vertices && g->width == expected->width && g->key == expected->key);
+        assert(gsl_spmatrix_uint_equal(g->t, expected->t));
+        assert(!memcmp(g->neighbors, expected->neighbors, g->num_vertices * NUM_DIRS * sizeof(uint)));
+        assert(!memcmp(g->twins, expected->twins, nz * sizeof(int)));
+
+        graph__free(g);
+        graph__free(expected);
+        shape__delete(s);
+    }
+}
+
+void tests__shape__init_from_file() {
+    struct shape_t* s = shape__new();
+
+    // The short rows and the missing ones are holes
+    const char* text = "......\n..##..\n\n..##..\n.....\n";
+    write_mask(text, strlen(text));
+    assert(shape__init_from_file(s, MASK_PATH) == 0);
+    assert(shape__get_board_shape(s) == SHAPE_MASK && shape__get_size(s) == 6);
+    struct graph_t* g = graph__new();
+    shape__build_graph(s, g);
+    assert(g->num_vertices == 36);
+    assert(!is_isolated(g, 0) && !is_isolated(g, 6 + 1));
+    assert(is_isolated(g, 6 + 2) && is_isolated(g, 2 * 6 + 3));
+    assert(is_isolated(g, 3 * 6 + 5) && is_isolated(g, 5 * 6));
+    assert(graph__get_neighbor(g, 6 + 1, DIR_EAST) == GRAPH__NO_NEIGHBOR && graph__get_neighbor(g, 6 + 1, DIR_WEST) == 6);
+    graph__free(g);
+
+    // The black pixels of an image are holes, its last byte of each row being padded
+    const char pbm[] = {'P', '4', '\n', '#', ' ', 'b', 'o', 'a', 'r', 'd', '\n', '9', ' ', '5', '\n',
+                        0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0x80};
+    write_mask(pbm, sizeof(pbm));
+    assert(shape__init_from_file(s, MASK_PATH) == 0);
+    assert(shape__get_size(s) == 9);
+    g = graph__new();
+    shape__build_graph(s, g);
+    assert(!is_isolated(g, 0) && !is_isolated(g, 8) && !is_isolated(g, 9 + 2));
+    assert(is_isolated(g, 9 + 3) && is_isolated(g, 9 + 4) && is_isolated(g, 4 * 9) && is_isolated(g, 8 * 9 + 8));
+    graph__free(g);
+
+    // Neither an unknown character, a board smaller than 5 cells nor a missing file is a board
+    write_mask("....\n.x..\n", 10);
+    assert(shape__init_from_file(s, MASK_PATH) == -1);
+    write_mask("....\n....\n", 10);
+    assert(shape__init_from_file(s, MASK_PATH) == -1);
+    remove(MASK_PATH);
+    assert(shape__init_from_file(s, MASK_PATH) == -1);
+    assert(shape__file_path("file:board.txt") && !strcmp(shape__file_path("file:board.txt"), "board.txt"));
+    assert(shape__file_path("c") == NULL);
+
+    shape__delete(s);
 }
 
 void tests__shape__get_board_shape() {
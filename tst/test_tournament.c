@@ -0,0 +1,55 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tests_functions.h"
+#include "tests_utils.h"
+#include "tournament.h"
+
+struct func_block tests_list_tournament[] = {
+    {tests__tournament__play, "tournament__play"},
+    {tests__tournament__workers, "tournament__play (workers)"}};
+
+struct tests__functions tests__get_tournament_tests() {
+    return (struct tests__functions){2, tests_list_tournament};
+}
+
+static struct game_config tournament_game_config() {
+    return (struct game_config){
+        .size = 8,
+        .starting_player = UNDEFINED_PLAYER,
+        .seed = 3,
+        .board_shape = SHAPE_SQUARE,
+    };
+}
+
+void tests__tournament__play() {
+    struct game_config config = tournament_game_config();
+    struct tournament_config tournament = {3, 1, 0, NULL};
+    struct tournament_result result;
+
+    tournament__play(&config, &tournament, "./install/handy_cape.so", "./install/heroine.so", &result);
+    assert(result.nb_games == 3);
+    assert(result.scores[PLAYER_1].wins + result.scores[PLAYER_2].wins == 3);
+    assert(result.scores[PLAYER_1].wins == result.scores[PLAYER_2].losses);
+    assert(!strcmp(result.scores[PLAYER_2].name, "Heroine"));
+}
+
+void tests__tournament__workers() {
+    struct game_config config = tournament_game_config();
+    struct tournament_config sequential = {5, 1, 0, NULL};
+    struct tournament_config parallel = {5, 2, 1, NULL};
+    struct tournament_result expected;
+    struct tournament_result result;
+
+    tournament__play(&config, &sequential, "./install/handy_cape.so", "./install/heroine.so", &expected);
+    tournament__play(&config, &parallel, "./install/handy_cape.so", "./install/heroine.so", &result);
+    assert(result.nb_games == 5);
+    for (uint player_id = 0; player_id < NUM_PLAYERS; player_id++) {
+        assert(!strcmp(result.scores[player_id].name, expected.scores[player_id].name));
+        assert(result.scores[player_id].wins == expected.scores[player_id].wins);
+        assert(result.scores[player_id].losses == expected.scores[player_id].losses);
+        assert(result.scores[player_id].invalid_moves == expected.scores[player_id].invalid_moves);
+    }
+}
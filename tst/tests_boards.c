@@ -0,0 +1,25 @@
+#include "tests_boards.h"
+#include "shape.h"
+
+struct graph_t* tests__shaped_graph(uint* size, char board_shape) {
+    struct shape_t* s = shape__new();
+    shape__init(s, *size, board_shape);
+    *size = shape__get_size(s);
+    struct graph_t* g = graph__new();
+    graph__init(g, *size * *size);
+    shape__init_graph(s, g);
+    graph__compress(g);
+    shape__delete(s);
+    return g;
+}
+
+struct graph_t* tests__square_graph(uint size) {
+    return tests__shaped_graph(&size, SHAPE_SQUARE);
+}
+
+struct queens_t* tests__initial_queens(uint size) {
+    struct queens_t* q = queens__new();
+    queens__alloc(q, queens__default_count(size));
+    queens__init(q, size);
+    return q;
+}
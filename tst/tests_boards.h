@@ -0,0 +1,29 @@
+#ifndef __TESTS_BOARDS_H__
+#define __TESTS_BOARDS_H__
+
+#include "graph.h"
+#include "queens.h"
+
+/**
+ * @brief Builds the compressed graph of a board with the given shape.
+ * @param size The asked size of the board, replaced by the size the shape actually uses.
+ * @param board_shape The shape of the board.
+ * @return The graph, to be freed with graph__free.
+ */
+struct graph_t* tests__shaped_graph(uint* size, char board_shape);
+
+/**
+ * @brief Builds the compressed graph of a square board.
+ * @param size The size of the board.
+ * @return The graph, to be freed with graph__free.
+ */
+struct graph_t* tests__square_graph(uint size);
+
+/**
+ * @brief Places the default number of queens of a board at their starting positions.
+ * @param size The size of the board.
+ * @return The queens, to be freed with queens__free.
+ */
+struct queens_t* tests__initial_queens(uint size);
+
+#endif // __TESTS_BOARDS_H__
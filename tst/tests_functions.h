@@ -16,6 +16,12 @@ void tests__game__current_player();
 void tests__game__default_config();
 void tests__game__play();
 void tests__game__get_winner();
+void tests__game__is_forfeit();
+void tests__game__time_control();
+void tests__game__isolation();
+void tests__game__hang();
+void tests__game__ponder();
+void tests__game__seed();
 
 /* Shape test functions */
 
@@ -25,6 +31,7 @@ void tests__shape__new();
 void tests__shape__init();
 void tests__shape__delete();
 void tests__shape__init_graph();
+void tests__shape__init_from_file();
 void tests__shape__get_board_shape();
 void tests__shape__get_size();
 
@@ -36,6 +43,9 @@ void tests__graph__init();
 void tests__graph__free();
 void tests__graph__copy();
 void tests__graph__compress();
+void tests__graph__get_neighbor();
+void tests__graph__disconnect();
+void tests__graph__get_direction();
 
 /* Queens tests functions */
 
@@ -48,4 +58,97 @@ void tests__queens__copy();
 void tests__queens__move();
 void tests__queens__free();
 
+/* Move tests functions */
+
+struct tests__functions tests__get_move_tests();
+
+void tests__move__make();
+void tests__move__unmake();
+void tests__move__position_key();
+
+/* Bitboard tests functions */
+
+struct tests__functions tests__get_bitboard_tests();
+
+void tests__bitboard__is_supported();
+void tests__bitboard__init();
+void tests__bitboard__reachable();
+void tests__bitboard__play();
+void tests__bitboard__generate();
+
+/* Movegen tests functions */
+
+struct tests__functions tests__get_movegen_tests();
+
+void tests__movegen__targets();
+void tests__movegen__generate();
+void tests__movegen__count();
+
+/* Tournament tests functions */
+
+struct tests__functions tests__get_tournament_tests();
+
+void tests__tournament__play();
+void tests__tournament__workers();
+
+/* Board description tests functions */
+
+struct tests__functions tests__get_board_desc_tests();
+
+void tests__board_desc__publish();
+void tests__board_desc__to_graph();
+void tests__board_desc__to_queens();
+
+/* Record tests functions */
+
+struct tests__functions tests__get_record_tests();
+
+void tests__record__load();
+void tests__record__truncated();
+void tests__record__seek();
+void tests__record__mask();
+
+/* Export tests functions */
+
+struct tests__functions tests__get_export_tests();
+
+void tests__export__write();
+void tests__export__log();
+
+/* Latency tests functions */
+
+struct tests__functions tests__get_latency_tests();
+
+void tests__latency__percentile();
+void tests__latency__merge();
+void tests__latency__game();
+
+/* Dataset tests functions */
+
+struct tests__functions tests__get_dataset_tests();
+
+void tests__dataset__load();
+void tests__dataset__tournament();
+
+/* Random generator tests functions */
+
+struct tests__functions tests__get_rng_tests();
+
+void tests__rng__next();
+void tests__rng__below();
+
+/* Opening book tests functions */
+
+struct tests__functions tests__get_book_tests();
+
+void tests__book__key();
+void tests__book__probe();
+
+/* Board cache tests functions */
+
+struct tests__functions tests__get_board_cache_tests();
+
+void tests__board_cache__init_graph();
+void tests__board_cache__snapshot();
+
 #endif // __TESTS_FUNCTIONS_H__
\ No newline at end of file